@@ -9,6 +9,13 @@
 --------------------------------------------------------------------------------
 
 local options = {
+	{ -- bool
+		key     = 'benchmarkunitstates',
+		name    = 'Benchmark Unit States',
+		desc    = 'Periodically log the time needed to read all visible units through the per-field\ncallbacks compared to a single getUnitStates call.\nkey: benchmarkunitstates',
+		type    = 'bool',
+		def     = false,
+	},
 }
 
 return options
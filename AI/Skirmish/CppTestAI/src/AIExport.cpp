@@ -36,7 +36,7 @@ EXPORT(int) init(int skirmishAIId, const struct SSkirmishAICallback* innerCallba
 
 	try {
 		springai::OOAICallback* clb = springai::WrappOOAICallback::GetInstance(innerCallback, skirmishAIId);
-		cpptestai::CCppTestAI* ai = new cpptestai::CCppTestAI(clb);
+		cpptestai::CCppTestAI* ai = new cpptestai::CCppTestAI(clb, innerCallback);
 
 		myAIs[skirmishAIId] = ai;
 		myAICallbacks[skirmishAIId] = clb;
@@ -5,6 +5,7 @@
 
 #include "ExternalAI/Interface/AISEvents.h"
 #include "ExternalAI/Interface/AISCommands.h"
+#include "ExternalAI/Interface/SSkirmishAICallback.h"
 
 // generated by the C++ Wrapper scripts
 #include "OOAICallback.h"
@@ -12,12 +13,27 @@
 #include "UnitDef.h"
 #include "Game.h"
 
+#include <chrono>
+#include <cstring>
 #include <string>
+#include <vector>
 
-cpptestai::CCppTestAI::CCppTestAI(springai::OOAICallback* callback):
+// benchmark every 10 seconds of game-time
+static const int BENCHMARK_INTERVAL = 300;
+static const int BENCHMARK_ROUNDS = 10;
+
+cpptestai::CCppTestAI::CCppTestAI(springai::OOAICallback* callback, const struct SSkirmishAICallback* innerCallback):
 		callback(callback),
-		skirmishAIId(callback != NULL ? callback->GetSkirmishAIId() : -1)
-		{}
+		innerCallback(innerCallback),
+		skirmishAIId(callback != NULL ? callback->GetSkirmishAIId() : -1),
+		benchmarkUnitStates(false)
+{
+	if (innerCallback == NULL)
+		return;
+
+	const char* value = innerCallback->SkirmishAI_OptionValues_getValueByKey(skirmishAIId, "benchmarkunitstates");
+	benchmarkUnitStates = (value != NULL && (strcmp(value, "true") == 0 || strcmp(value, "1") == 0));
+}
 
 cpptestai::CCppTestAI::~CCppTestAI() {}
 
@@ -48,6 +64,14 @@ int cpptestai::CCppTestAI::HandleEvent(int topic, const void* data) {
 
 			break;
 		}
+		case EVENT_UPDATE: {
+			const struct SUpdateEvent* evt = static_cast<const struct SUpdateEvent*>(data);
+
+			if (benchmarkUnitStates && (evt->frame % BENCHMARK_INTERVAL) == 0)
+				BenchmarkUnitStates(evt->frame);
+
+			break;
+		}
 		default: {
 			break;
 		}
@@ -56,3 +80,71 @@ int cpptestai::CCppTestAI::HandleEvent(int topic, const void* data) {
 	// signal: everything went OK
 	return 0;
 }
+
+void cpptestai::CCppTestAI::BenchmarkUnitStates(int frame) {
+
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<int> unitIds;
+	std::vector<float> states;
+
+	// summed up so the compiler can not drop the reads
+	float fieldsSum = 0.0f;
+	float statesSum = 0.0f;
+
+	const Clock::time_point fieldsStart = Clock::now();
+
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		const int numFriendly = innerCallback->getFriendlyUnits(skirmishAIId, NULL, -1);
+		const int numEnemies = innerCallback->getEnemyUnitsInRadarAndLos(skirmishAIId, NULL, -1);
+
+		unitIds.resize(numFriendly + numEnemies);
+
+		if (unitIds.empty())
+			break;
+
+		innerCallback->getFriendlyUnits(skirmishAIId, &unitIds[0], numFriendly);
+		innerCallback->getEnemyUnitsInRadarAndLos(skirmishAIId, &unitIds[numFriendly], numEnemies);
+
+		for (size_t i = 0; i < unitIds.size(); i++) {
+			float pos[3];
+			float vel[3];
+
+			innerCallback->Unit_getPos(skirmishAIId, unitIds[i], pos);
+			innerCallback->Unit_getVel(skirmishAIId, unitIds[i], vel);
+
+			fieldsSum += innerCallback->Unit_getDef(skirmishAIId, unitIds[i]);
+			fieldsSum += innerCallback->Unit_getTeam(skirmishAIId, unitIds[i]);
+			fieldsSum += innerCallback->Unit_getHealth(skirmishAIId, unitIds[i]);
+			fieldsSum += innerCallback->Unit_getMaxHealth(skirmishAIId, unitIds[i]);
+			fieldsSum += innerCallback->Unit_getBuildProgress(skirmishAIId, unitIds[i]);
+			fieldsSum += (pos[0] + pos[1] + pos[2] + vel[0] + vel[1] + vel[2]);
+		}
+	}
+
+	const Clock::time_point statesStart = Clock::now();
+
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		states.resize(innerCallback->getUnitStates(skirmishAIId, NULL, 0));
+
+		if (states.empty())
+			break;
+
+		innerCallback->getUnitStates(skirmishAIId, &states[0], int(states.size()));
+
+		for (size_t i = 0; i < states.size(); i++) {
+			statesSum += states[i];
+		}
+	}
+
+	const Clock::time_point statesEnd = Clock::now();
+
+	const double fieldsTime = std::chrono::duration<double, std::milli>(statesStart - fieldsStart).count() / BENCHMARK_ROUNDS;
+	const double statesTime = std::chrono::duration<double, std::milli>(statesEnd - statesStart).count() / BENCHMARK_ROUNDS;
+
+	char msg[256];
+	SNPRINTF(msg, sizeof(msg),
+			"[CppTestAI] frame %i: %i units, per-field calls %.4fms, getUnitStates %.4fms (checksums %g / %g)",
+			frame, int(states.size() / UNIT_STATE_SIZE), fieldsTime, statesTime, fieldsSum, statesSum);
+	innerCallback->Log_log(skirmishAIId, msg);
+}
@@ -6,6 +6,8 @@
 // generated by the C++ Wrapper scripts
 #include "OOAICallback.h"
 
+struct SSkirmishAICallback;
+
 namespace cpptestai {
 
 /**
@@ -17,13 +19,24 @@ class CCppTestAI {
 
 private:
 	springai::OOAICallback* callback;
+	/// the plain C callback, used to compare the raw cost of engine calls
+	const struct SSkirmishAICallback* innerCallback;
 	int skirmishAIId;
 
+	bool benchmarkUnitStates;
+
 public:
-	CCppTestAI(springai::OOAICallback* callback);
+	CCppTestAI(springai::OOAICallback* callback, const struct SSkirmishAICallback* innerCallback);
 	~CCppTestAI();
 
 	int HandleEvent(int topic, const void* data);
+
+private:
+	/**
+	 * Reads the same per-unit data once through the per-field Unit_get*
+	 * functions and once through getUnitStates, and logs both timings.
+	 */
+	void BenchmarkUnitStates(int frame);
 }; // class CCppTestAI
 
 } // namespace cpptestai
@@ -48,6 +48,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
+#include "ExternalAI/SkirmishAIThread.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "Net/Protocol/NetProtocol.h"
@@ -124,9 +125,9 @@ CAICallback::CAICallback(int teamId): team(teamId)
 void CAICallback::SendStartPos(bool ready, float3 startPos)
 {
 	if (ready) {
-		clientNet->Send(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_READIED, startPos.x, startPos.y, startPos.z));
+		CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_READIED, startPos.x, startPos.y, startPos.z));
 	} else {
-		clientNet->Send(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_UPDATED, startPos.x, startPos.y, startPos.z));
+		CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_UPDATED, startPos.x, startPos.y, startPos.z));
 	}
 }
 
@@ -177,7 +178,7 @@ bool CAICallback::SendResources(float mAmount, float eAmount, int receivingTeamI
 		eAmount = std::max(0.0f, std::min(eAmount, GetEnergy()));
 		std::vector<short> empty;
 
-		clientNet->Send(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), mAmount, eAmount, empty));
+		CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), mAmount, eAmount, empty));
 	}
 
 	return ret;
@@ -216,7 +217,7 @@ int CAICallback::SendUnits(const std::vector<int>& unitIds, int receivingTeamId)
 		if (!sentUnitIDs.empty()) {
 			// we ca not use SendShare() here either, since
 			// AIs do not have a notion of "selected units"
-			clientNet->Send(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), 0.0f, 0.0f, sentUnitIDs));
+			CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), 0.0f, 0.0f, sentUnitIDs));
 		}
 	}
 
@@ -366,7 +367,7 @@ int CAICallback::GiveOrder(int unitId, Command* c)
 	if (unit->team != team)
 		return -5;
 
-	clientNet->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), team, unitId, c->GetID(false), c->GetID(true), c->GetTimeOut(), c->GetOpts(), c->GetNumParams(), c->GetParams()));
+	CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), team, unitId, c->GetID(false), c->GetID(true), c->GetTimeOut(), c->GetOpts(), c->GetNumParams(), c->GetParams()));
 	return 0;
 }
 
@@ -805,7 +806,8 @@ static int FilterUnitsVector(const std::vector<CUnit*>& units, int* unitIds, int
 }
 
 
-static int myAllyTeamId = -1;
+// per thread, asynchronous AIs filter units concurrently
+static thread_local int myAllyTeamId = -1;
 
 /// You have to set myAllyTeamId before calling this function. NOT thread safe!
 static inline bool unit_IsEnemy(const CUnit* unit) {
@@ -864,10 +866,14 @@ int CAICallback::GetEnemyUnits(int* unitIds, const float3& pos, float radius,
 		int unitIds_max)
 {
 	verify();
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius);
-	myAllyTeamId = teamHandler.AllyTeam(team);
-	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsEnemyAndInLos);
+
+	// the quad-field query caches are not thread-safe
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		myAllyTeamId = teamHandler.AllyTeam(team);
+		return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsEnemyAndInLos);
+	});
 }
 
 
@@ -882,10 +888,14 @@ int CAICallback::GetFriendlyUnits(int* unitIds, const float3& pos, float radius,
 		int unitIds_max)
 {
 	verify();
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius);
-	myAllyTeamId = teamHandler.AllyTeam(team);
-	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsFriendly);
+
+	// the quad-field query caches are not thread-safe
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		myAllyTeamId = teamHandler.AllyTeam(team);
+		return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsFriendly);
+	});
 }
 
 
@@ -899,10 +909,14 @@ int CAICallback::GetNeutralUnits(int* unitIds, int unitIds_max)
 int CAICallback::GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
 	verify();
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius);
-	myAllyTeamId = teamHandler.AllyTeam(team);
-	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsNeutralAndInLosOrRadar);
+
+	// the quad-field query caches are not thread-safe
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		myAllyTeamId = teamHandler.AllyTeam(team);
+		return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsNeutralAndInLosOrRadar);
+	});
 }
 
 
@@ -1097,16 +1111,27 @@ void CAICallback::DrawUnit(
 
 bool CAICallback::CanBuildAt(const UnitDef* unitDef, const float3& pos, int facing)
 {
-	CFeature* blockingF = nullptr;
-	BuildInfo bi(unitDef, pos, facing);
-	bi.pos = CGameHelper::Pos2BuildPos(bi, false);
-	return !!CGameHelper::TestUnitBuildSquare(bi, blockingF, teamHandler.AllyTeam(team), false);
+	// the quad-field query caches are not thread-safe, LoadModel may create GL objects
+	return !!CSkirmishAIThread::RunOnMainThread([&]() {
+		CFeature* blockingF = nullptr;
+		BuildInfo bi(unitDef, pos, facing);
+		bi.pos = CGameHelper::Pos2BuildPos(bi, false);
+		return CGameHelper::TestUnitBuildSquare(bi, blockingF, teamHandler.AllyTeam(team), false);
+	});
 }
 
 
 float3 CAICallback::ClosestBuildSite(const UnitDef* unitDef, const float3& pos, float searchRadius, int minDist, int facing)
 {
-	return CGameHelper::ClosestBuildPos(team, unitDef, pos, searchRadius, minDist, facing);
+	float3 buildPos;
+
+	// the quad-field query caches are not thread-safe, LoadModel may create GL objects
+	CSkirmishAIThread::RunOnMainThread([&]() {
+		buildPos = CGameHelper::ClosestBuildPos(team, unitDef, pos, searchRadius, minDist, facing);
+		return 0;
+	});
+
+	return buildPos;
 }
 
 
@@ -1229,25 +1254,29 @@ int CAICallback::GetFeatures(int* featureIds, int maxFeatureIDs, const float3& p
 	int numFeatureIDs = 0;
 
 	verify();
-	QuadFieldQuery qfQuery;
-	quadField.GetFeaturesExact(qfQuery, pos, radius);
-	const int allyteam = teamHandler.AllyTeam(team);
 
-	for (const CFeature* f: *qfQuery.features) {
-		if (numFeatureIDs >= maxFeatureIDs)
-			break;
+	// the quad-field query caches are not thread-safe
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetFeaturesExact(qfQuery, pos, radius);
+		const int allyteam = teamHandler.AllyTeam(team);
 
-		if (!f->IsInLosForAllyTeam(allyteam))
-			continue;
+		for (const CFeature* f: *qfQuery.features) {
+			if (numFeatureIDs >= maxFeatureIDs)
+				break;
 
-		// if array is nullptr, caller only wants to know the number of features
-		if (featureIds != nullptr)
-			featureIds[numFeatureIDs] = f->id;
+			if (!f->IsInLosForAllyTeam(allyteam))
+				continue;
 
-		numFeatureIDs++;
-	}
+			// if array is nullptr, caller only wants to know the number of features
+			if (featureIds != nullptr)
+				featureIds[numFeatureIDs] = f->id;
 
-	return numFeatureIDs;
+			numFeatureIDs++;
+		}
+
+		return numFeatureIDs;
+	});
 }
 
 
@@ -1397,19 +1426,19 @@ int CAICallback::HandleCommand(int commandId, void* data)
 			   TODO: gu->myPlayerNum makes the command to look like as it comes from the local player,
 			   "team" should be used (but needs some major changes in other engine parts)
 			*/
-			clientNet->Send(CBaseNetProtocol::Get().SendMapDrawPoint(gu->myPlayerNum, (short)cmdData->pos.x, (short)cmdData->pos.z, std::string(cmdData->label), false));
+			CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendMapDrawPoint(gu->myPlayerNum, (short)cmdData->pos.x, (short)cmdData->pos.z, std::string(cmdData->label), false));
 			return 1;
 		} break;
 		case AIHCAddMapLineId: {
 			const AIHCAddMapLine* cmdData = static_cast<AIHCAddMapLine*>(data);
 			// see TODO above
-			clientNet->Send(CBaseNetProtocol::Get().SendMapDrawLine(gu->myPlayerNum, (short)cmdData->posfrom.x, (short)cmdData->posfrom.z, (short)cmdData->posto.x, (short)cmdData->posto.z, false));
+			CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendMapDrawLine(gu->myPlayerNum, (short)cmdData->posfrom.x, (short)cmdData->posfrom.z, (short)cmdData->posto.x, (short)cmdData->posto.z, false));
 			return 1;
 		} break;
 		case AIHCRemoveMapPointId: {
 			const AIHCRemoveMapPoint* cmdData = static_cast<AIHCRemoveMapPoint*>(data);
 			// see TODO above
-			clientNet->Send(CBaseNetProtocol::Get().SendMapErase(gu->myPlayerNum, (short)cmdData->pos.x, (short)cmdData->pos.z));
+			CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendMapErase(gu->myPlayerNum, (short)cmdData->pos.x, (short)cmdData->pos.z));
 			return 1;
 		} break;
 		case AIHCSendStartPosId:
@@ -1478,7 +1507,7 @@ int CAICallback::HandleCommand(int commandId, void* data)
 		case AIHCPauseId: {
 			AIHCPause* cmdData = static_cast<AIHCPause*>(data);
 
-			clientNet->Send(CBaseNetProtocol::Get().SendPause(gu->myPlayerNum, cmdData->enable));
+			CSkirmishAIThread::SendPacket(CBaseNetProtocol::Get().SendPause(gu->myPlayerNum, cmdData->enable));
 			LOG("Skirmish AI controlling team %i paused the game, reason: %s",
 					team,
 					cmdData->reason != nullptr ? cmdData->reason : "UNSPECIFIED");
@@ -1578,14 +1607,20 @@ void CAICallback::GetUnitDefList(const UnitDef** list)
 float CAICallback::GetUnitDefRadius(int def)
 {
 	const UnitDef* ud = unitDefHandler->GetUnitDefByID(def);
-	const S3DModel* mdl = ud->LoadModel();
+	const S3DModel* mdl = nullptr;
+
+	// LoadModel may create GL objects
+	CSkirmishAIThread::RunOnMainThread([&]() { mdl = ud->LoadModel(); return 0; });
 	return mdl->radius;
 }
 
 float CAICallback::GetUnitDefHeight(int def)
 {
 	const UnitDef* ud = unitDefHandler->GetUnitDefByID(def);
-	const S3DModel* mdl = ud->LoadModel();
+	const S3DModel* mdl = nullptr;
+
+	// LoadModel may create GL objects
+	CSkirmishAIThread::RunOnMainThread([&]() { mdl = ud->LoadModel(); return 0; });
 	return mdl->height;
 }
 
@@ -3,6 +3,7 @@
 #include "AICheats.h"
 
 #include "ExternalAI/SkirmishAIWrapper.h"
+#include "ExternalAI/SkirmishAIThread.h"
 #include "Game/TraceRay.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
@@ -148,7 +149,7 @@ static inline bool unit_IsNeutral(CUnit* unit) {
 	return unit->IsNeutral();
 }
 
-static int myAllyTeamId = -1;
+static thread_local int myAllyTeamId = -1;
 
 /// You have to set myAllyTeamId before callign this function. NOT thread safe!
 static inline bool unit_IsEnemy(CUnit* unit) {
@@ -164,10 +165,13 @@ int CAICheats::GetEnemyUnits(int* unitIds, int unitIds_max)
 
 int CAICheats::GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius);
-	myAllyTeamId = teamHandler.AllyTeam(ai->GetTeamId());
-	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsEnemy);
+	// the quad-field query caches are not thread-safe
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		myAllyTeamId = teamHandler.AllyTeam(ai->GetTeamId());
+		return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsEnemy);
+	});
 }
 
 int CAICheats::GetNeutralUnits(int* unitIds, int unitIds_max)
@@ -177,9 +181,11 @@ int CAICheats::GetNeutralUnits(int* unitIds, int unitIds_max)
 
 int CAICheats::GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius);
-	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsNeutral);
+	return CSkirmishAIThread::RunOnMainThread([&]() {
+		QuadFieldQuery qfQuery;
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsNeutral);
+	});
 }
 
 int CAICheats::GetFeatures(int* features, int max) const {
@@ -130,6 +130,28 @@ void CEngineOutHandler::Update() {
 	DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
 }
 
+void CEngineOutHandler::RunSkirmishAIs() {
+	DO_FOR_SKIRMISH_AIS(DispatchEvents())
+}
+
+void CEngineOutHandler::RunSkirmishAITasks(spring_time maxWaitTime) {
+	const spring_time endTime = spring_gettime() + maxWaitTime;
+
+	do {
+		DO_FOR_SKIRMISH_AIS(RunTasks())
+	} while (CSkirmishAIThread::WaitForTasks(endTime));
+}
+
+void CEngineOutHandler::SyncSkirmishAIs() {
+	AI_SCOPED_TIMER();
+	DO_FOR_SKIRMISH_AIS(SyncEvents())
+}
+
+void CEngineOutHandler::FlushSkirmishAIs() {
+	AI_SCOPED_TIMER();
+	DO_FOR_SKIRMISH_AIS(FlushEvents())
+}
+
 
 
 // Do only if the unit is not allied, in which case we know
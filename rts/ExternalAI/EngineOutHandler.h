@@ -5,6 +5,7 @@
 
 #include "SkirmishAIWrapper.h"
 #include "System/Object.h"
+#include "System/Misc/SpringTime.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 #include <array>
@@ -49,6 +50,28 @@ public:
 
 	void Update();
 
+	/**
+	 * Lets asynchronous Skirmish AIs (AsyncSkirmishAIs) start on the events
+	 * queued since the last call; they run until SyncSkirmishAIs.
+	 */
+	void RunSkirmishAIs();
+	/**
+	 * Runs what asynchronous Skirmish AIs pass to the main thread, and keeps
+	 * doing so for up to maxWaitTime; doubles as the main thread's idle wait.
+	 */
+	void RunSkirmishAITasks(spring_time maxWaitTime = spring_notime);
+	/**
+	 * Waits for asynchronous Skirmish AIs to finish reading sim-state and
+	 * sends the orders they gave meanwhile; required before it changes.
+	 */
+	void SyncSkirmishAIs();
+	/**
+	 * Has asynchronous Skirmish AIs handle every event queued so far; called
+	 * before units are deleted, so that destroy-events reach the AI while the
+	 * unit and its id are still valid.
+	 */
+	void FlushSkirmishAIs();
+
 	/** Group should return false if it doenst want the unit for some reason. */
 	bool UnitAddedToGroup(const CUnit& unit, const CGroup& group);
 	/** No way to refuse giving up a unit. */
@@ -1125,6 +1125,20 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *getSelectedUnits)(int skirmishAIId, int* unitIds, int unitIds_sizeMax); //$ FETCHER:MULTI:IDs:Unit:unitIds
 
+	/**
+	 * Fills states with one record of UNIT_STATE_SIZE floats per unit this
+	 * teams ally-team can see (see UNIT_STATE_* in aidefines.h): all units of
+	 * the ally-team, plus enemy and neutral units in LOS or radar.
+	 * If cheats are enabled, this will return all units on the map.
+	 * Fields that would not be visible through the Unit_get* functions are -1,
+	 * radar blip positions include the radar error.
+	 * The records describe the state at Game_getCurrentFrame(); an AI may keep
+	 * using them until that changes.
+	 * @return the number of floats written (only whole records),
+	 *         or the number required if states is NULL
+	 */
+	int               (CALLING_CONV *getUnitStates)(int skirmishAIId, float* states, int states_sizeMax); //$ ARRAY:states
+
 	/**
 	 * Returns the unit's unitdef struct from which you can read all
 	 * the statistics of the unit, do NOT try to change any values in it.
@@ -82,4 +82,23 @@
 // Size of buffer for response from lua UI/Rules, including '\0'
 #define MAX_RESPONSE_SIZE 10240
 
+/**
+ * Layout of the per-unit records written by
+ * SSkirmishAICallback::getUnitStates, as offsets into one record
+ * of UNIT_STATE_SIZE floats.
+ */
+#define UNIT_STATE_ID              0
+#define UNIT_STATE_DEF             1
+#define UNIT_STATE_TEAM            2
+#define UNIT_STATE_POS_X           3
+#define UNIT_STATE_POS_Y           4
+#define UNIT_STATE_POS_Z           5
+#define UNIT_STATE_VEL_X           6
+#define UNIT_STATE_VEL_Y           7
+#define UNIT_STATE_VEL_Z           8
+#define UNIT_STATE_HEALTH          9
+#define UNIT_STATE_MAX_HEALTH     10
+#define UNIT_STATE_BUILD_PROGRESS 11
+#define UNIT_STATE_SIZE           12
+
 #endif // AI_DEFINES_H
@@ -8,6 +8,7 @@
 #include "ExternalAI/SkirmishAIWrapper.h"
 #include "ExternalAI/SAIInterfaceCallbackImpl.h"
 #include "ExternalAI/SkirmishAIHandler.h"
+#include "ExternalAI/SkirmishAIThread.h"
 #include "ExternalAI/Interface/AISCommands.h"
 #include "ExternalAI/Interface/SSkirmishAICallback.h"
 #include "ExternalAI/Interface/SSkirmishAILibrary.h"
@@ -47,6 +48,7 @@
 #include "System/SpringMath.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
 
 
 static std::array<std::pair<CAICallback, CAICheats>, MAX_AIS> AI_LEGACY_CALLBACKS;
@@ -261,6 +263,13 @@ static inline const FeatureDef* getFeatureDefById(int skirmishAIId, int featureD
 }
 
 
+static inline bool IsUnitCommandTopic(int commandTopic) {
+	if (commandTopic >= COMMAND_UNIT_BUILD && commandTopic <= COMMAND_UNIT_CUSTOM)
+		return true;
+
+	return (commandTopic == COMMAND_UNIT_RECLAIM_FEATURE);
+}
+
 //FIXME: get rid of this function (=call functions directly)
 static int wrapper_HandleCommand(CAICallback* clb, CAICheats* clbCheat, int cmdId, void* cmdData) {
 	if (clbCheat != nullptr) {
@@ -640,11 +649,19 @@ EXPORT(int) skirmishAiCallback_Engine_executeCommand(
 
 EXPORT(int) skirmishAiCallback_Engine_handleCommand(
 	int skirmishAIId,
-	int /*toId*/,
+	int toId,
 	int commandId,
 	int commandTopic,
 	void* commandData
 ) {
+	// unit orders only read sim-state and are sent over the network; everything
+	// else (Lua, drawing, pathing, cheats, ...) has to be run by the main thread
+	if (!IsUnitCommandTopic(commandTopic) && !Threading::IsMainThread()) {
+		return CSkirmishAIThread::RunOnMainThread([&]() {
+			return skirmishAiCallback_Engine_handleCommand(skirmishAIId, toId, commandId, commandTopic, commandData);
+		});
+	}
+
 	int ret = 0;
 
 	CAICallback* clb = GetCallBack(skirmishAIId);
@@ -1339,7 +1356,10 @@ EXPORT(void) skirmishAiCallback_Log_exception(int skirmishAIId, const char* cons
 	if (!die)
 		return;
 
-	skirmishAIHandler.SetLocalKillFlag(skirmishAIId, 4 /* = AI crashed */);
+	CSkirmishAIThread::RunOnMainThread([&]() {
+		skirmishAIHandler.SetLocalKillFlag(skirmishAIId, 4 /* = AI crashed */);
+		return 0;
+	});
 }
 
 EXPORT(char) skirmishAiCallback_DataDirs_getPathSeparator(int UNUSED_skirmishAIId) {
@@ -1403,7 +1423,7 @@ EXPORT(char*) skirmishAiCallback_DataDirs_allocatePath(
 	bool dir,
 	bool common
 ) {
-	static char path[2048];
+	static thread_local char path[2048];
 
 	if (!skirmishAiCallback_DataDirs_locatePath(skirmishAIId, &path[0], sizeof(path), relPath, writeable, create, dir, common))
 		path[0] = 0;
@@ -1415,13 +1435,8 @@ EXPORT(char*) skirmishAiCallback_DataDirs_allocatePath(
 EXPORT(const char*) skirmishAiCallback_DataDirs_getWriteableDir(int skirmishAIId) {
 	CheckSkirmishAIId(skirmishAIId, __func__);
 
-	static std::vector<std::string> writeableDataDirs;
-
-	// fill up writeableDataDirs until teamId index is in there
-	// if it is not yet
-	for (size_t wdd = writeableDataDirs.size(); wdd <= (size_t)skirmishAIId; ++wdd) {
-		writeableDataDirs.emplace_back("");
-	}
+	// fixed size, AIs may ask for their dir concurrently
+	static std::array<std::string, MAX_AIS> writeableDataDirs;
 
 	if (writeableDataDirs[skirmishAIId].empty()) {
 		char tmpRes[1024];
@@ -3976,6 +3991,62 @@ EXPORT(int) skirmishAiCallback_getTeamUnits(int skirmishAIId, int* unitIds, int
 	return a;
 }
 
+static void fillUnitState(float* state, const CUnit* unit, int allyTeam, bool cheating) {
+	const UnitDef* unitDef = unit->unitDef;
+	const UnitDef* decoyDef = unitDef->decoyDef;
+
+	const unsigned short losStatus = unit->losStatus[allyTeam];
+	const unsigned short prevMask = (LOS_PREVLOS | LOS_CONTRADAR);
+
+	const bool allied = (cheating || teamHandler.Ally(unit->allyteam, allyTeam));
+	const bool inLos = (allied || (losStatus & LOS_INLOS) != 0);
+	const bool knownDef = (inLos || (losStatus & prevMask) == prevMask);
+
+	// same rules as the Unit_get* functions, enemies see what a decoy pretends to be
+	const UnitDef* shownDef = (allied || decoyDef == nullptr)? unitDef: decoyDef;
+	const float healthScale = shownDef->health / unitDef->health;
+
+	const float3 pos = cheating? float3(unit->midPos): unit->GetErrorPos(allyTeam);
+
+	state[UNIT_STATE_ID            ] = unit->id;
+	state[UNIT_STATE_DEF           ] = knownDef? shownDef->id: -1;
+	state[UNIT_STATE_TEAM          ] = inLos? unit->team: -1;
+	state[UNIT_STATE_POS_X         ] = pos.x;
+	state[UNIT_STATE_POS_Y         ] = pos.y;
+	state[UNIT_STATE_POS_Z         ] = pos.z;
+	state[UNIT_STATE_VEL_X         ] = unit->speed.x;
+	state[UNIT_STATE_VEL_Y         ] = unit->speed.y;
+	state[UNIT_STATE_VEL_Z         ] = unit->speed.z;
+	state[UNIT_STATE_HEALTH        ] = inLos? (unit->health * healthScale): -1.0f;
+	state[UNIT_STATE_MAX_HEALTH    ] = inLos? (unit->maxHealth * healthScale): -1.0f;
+	state[UNIT_STATE_BUILD_PROGRESS] = inLos? unit->buildProgress: -1.0f;
+}
+
+EXPORT(int) skirmishAiCallback_getUnitStates(int skirmishAIId, float* states, int statesMaxSize) {
+	const bool cheating = skirmishAiCallback_Cheats_isEnabled(skirmishAIId);
+	const int allyTeam = teamHandler.AllyTeam(AI_TEAM_IDS[skirmishAIId]);
+
+	// only whole records are written
+	const int maxNumStates = (states != nullptr)? (statesMaxSize / UNIT_STATE_SIZE): int(unitHandler.GetActiveUnits().size());
+
+	int numStates = 0;
+
+	for (const CUnit* u: unitHandler.GetActiveUnits()) {
+		if (numStates >= maxNumStates)
+			break;
+
+		if (!cheating && !teamHandler.Ally(u->allyteam, allyTeam) && (u->losStatus[allyTeam] & (LOS_INLOS | LOS_INRADAR)) == 0)
+			continue;
+
+		if (states != nullptr)
+			fillUnitState(&states[numStates * UNIT_STATE_SIZE], u, allyTeam, cheating);
+
+		numStates++;
+	}
+
+	return (numStates * UNIT_STATE_SIZE);
+}
+
 
 //########### BEGINN Team
 EXPORT(bool) skirmishAiCallback_Team_hasAIController(int skirmishAIId, int teamId) {
@@ -4211,26 +4282,28 @@ EXPORT(int) skirmishAiCallback_getFeatures(int skirmishAIId, int* featureIds, in
 
 EXPORT(int) skirmishAiCallback_getFeaturesIn(int skirmishAIId, float* pos_posF3, float radius, int* featureIds, int featureIdsMaxSize) {
 	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
-		// cheating
-		QuadFieldQuery qfQuery;
-		quadField.GetFeaturesExact(qfQuery, pos_posF3, radius);
-		const int featureIdsRealSize = qfQuery.features->size();
+		// cheating; the quad-field query caches are not thread-safe
+		return CSkirmishAIThread::RunOnMainThread([&]() {
+			QuadFieldQuery qfQuery;
+			quadField.GetFeaturesExact(qfQuery, pos_posF3, radius);
+			const int featureIdsRealSize = qfQuery.features->size();
 
-		int featureIdsSize = featureIdsRealSize;
+			int featureIdsSize = featureIdsRealSize;
 
-		if (featureIds != nullptr) {
-			featureIdsSize = std::min(featureIdsRealSize, featureIdsMaxSize);
+			if (featureIds != nullptr) {
+				featureIdsSize = std::min(featureIdsRealSize, featureIdsMaxSize);
 
-			size_t f = 0;
+				size_t f = 0;
 
-			for (const CFeature* feature: *qfQuery.features) {
+				for (const CFeature* feature: *qfQuery.features) {
 
-				assert(feature != nullptr);
-				featureIds[f++] = feature->id;
+					assert(feature != nullptr);
+					featureIds[f++] = feature->id;
+				}
 			}
-		}
 
-		return featureIdsSize;
+			return featureIdsSize;
+		});
 	}
 
 	// if (featureIds == NULL), this will only return the number of features
@@ -5336,6 +5409,7 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->getNeutralUnitsIn = &skirmishAiCallback_getNeutralUnitsIn;
 	callback->getTeamUnits = &skirmishAiCallback_getTeamUnits;
 	callback->getSelectedUnits = &skirmishAiCallback_getSelectedUnits;
+	callback->getUnitStates = &skirmishAiCallback_getUnitStates;
 	callback->Unit_getDef = &skirmishAiCallback_Unit_getDef;
 	callback->Unit_getRulesParamFloat = &skirmishAiCallback_Unit_getRulesParamFloat;
 	callback->Unit_getRulesParamString = &skirmishAiCallback_Unit_getRulesParamString;
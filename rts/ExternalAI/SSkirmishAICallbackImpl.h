@@ -660,6 +660,8 @@ EXPORT(int              ) skirmishAiCallback_getTeamUnits(int skirmishAIId, int*
 
 EXPORT(int              ) skirmishAiCallback_getSelectedUnits(int skirmishAIId, int* unitIds, int unitIds_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_getUnitStates(int skirmishAIId, float* states, int states_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Unit_getDef(int skirmishAIId, int unitId);
 
 EXPORT(float            ) skirmishAiCallback_Unit_getRulesParamFloat(int skirmishAIId, int unitId, const char* rulesParamName, float defaultValue);
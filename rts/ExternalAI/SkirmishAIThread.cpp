@@ -0,0 +1,271 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SkirmishAIThread.h"
+
+#include "SkirmishAIHandler.h"
+#include "Net/Protocol/NetProtocol.h"
+#include "System/Platform/Threading.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <ctime>
+
+#ifdef _WIN32
+	#include "System/Platform/Win/win32.h"
+#endif
+
+
+// the AI thread this thread belongs to (or is running a task for), if any
+static thread_local CSkirmishAIThread* currentAIThread = nullptr;
+
+// tasks requested by any AI thread and not yet taken by the main thread
+static unsigned int numRequestedTasks = 0;
+
+static spring::mutex taskMutex;
+static spring::condition_variable_any taskCond;
+
+
+static int64_t GetThreadCpuTime()
+{
+	#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	const uint64_t kernelTicks = (uint64_t(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+	const uint64_t userTicks = (uint64_t(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+
+	// 100ns ticks
+	return ((kernelTicks + userTicks) * 100);
+	#else
+	timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return (ts.tv_sec * int64_t(1000000000) + ts.tv_nsec);
+	#endif
+}
+
+
+
+CSkirmishAIThread::CSkirmishAIThread(int _skirmishAIId): skirmishAIId(_skirmishAIId)
+{
+	thread = spring::thread(&CSkirmishAIThread::Run, this);
+}
+
+CSkirmishAIThread::~CSkirmishAIThread()
+{
+	Sync();
+
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		quit = true;
+	}
+
+	cond.notify_all();
+	thread.join();
+}
+
+
+void CSkirmishAIThread::Run()
+{
+	Threading::SetThreadName("skirmishai");
+
+	currentAIThread = this;
+
+	while (true) {
+		{
+			std::unique_lock<spring::mutex> lock(mutex);
+			cond.wait(lock, [&]() { return (busy || quit); });
+
+			if (!busy)
+				break;
+		}
+
+		// dispatchedEvents belongs to this thread until busy is cleared
+		const int64_t startTime = GetThreadCpuTime();
+
+		for (const EventFunc& func: dispatchedEvents) {
+			func();
+		}
+
+		cpuTime += (GetThreadCpuTime() - startTime);
+		numHandledEvents += dispatchedEvents.size();
+
+		dispatchedEvents.clear();
+
+		{
+			std::lock_guard<spring::mutex> lock(mutex);
+			busy = false;
+		}
+
+		cond.notify_all();
+	}
+
+	currentAIThread = nullptr;
+}
+
+
+void CSkirmishAIThread::Dispatch()
+{
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+
+		// still working on the previous batch, keep queueing
+		if (busy)
+			return;
+	}
+
+	// idle, so whatever it sent since the last Sync is complete
+	SendPackets();
+
+	if (queuedEvents.empty())
+		return;
+
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+
+		dispatchedEvents.swap(queuedEvents);
+		busy = true;
+	}
+
+	cond.notify_all();
+}
+
+void CSkirmishAIThread::Sync()
+{
+	{
+		std::unique_lock<spring::mutex> lock(mutex);
+
+		while (true) {
+			cond.wait(lock, [&]() { return (!busy || task != nullptr); });
+
+			if (task == nullptr)
+				break;
+
+			const TaskFunc* func = task;
+
+			lock.unlock();
+			const int result = RunTask(*func);
+			lock.lock();
+
+			taskResult = result;
+			task = nullptr;
+
+			cond.notify_all();
+		}
+	}
+
+	SendPackets();
+}
+
+void CSkirmishAIThread::RunTasks()
+{
+	std::unique_lock<spring::mutex> lock(mutex);
+
+	if (task == nullptr)
+		return;
+
+	const TaskFunc* func = task;
+
+	lock.unlock();
+	const int result = RunTask(*func);
+	lock.lock();
+
+	taskResult = result;
+	task = nullptr;
+
+	cond.notify_all();
+}
+
+int CSkirmishAIThread::RunTask(const TaskFunc& func)
+{
+	assert(Threading::IsMainThread());
+
+	{
+		std::lock_guard<spring::mutex> lock(taskMutex);
+		numRequestedTasks -= 1;
+	}
+
+	// packets sent by the task are held back like the AI's own
+	const uint8_t prevAIId = skirmishAIHandler.GetCurrentAIID();
+
+	currentAIThread = this;
+	skirmishAIHandler.SetCurrentAIID(skirmishAIId);
+
+	const int result = func();
+
+	skirmishAIHandler.SetCurrentAIID(prevAIId);
+	currentAIThread = nullptr;
+
+	return result;
+}
+
+
+void CSkirmishAIThread::SendPackets()
+{
+	std::vector<std::shared_ptr<const netcode::RawPacket>> sentPackets;
+
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		sentPackets.swap(packets);
+	}
+
+	for (auto& pkt: sentPackets) {
+		clientNet->Send(std::move(pkt));
+	}
+}
+
+
+
+int CSkirmishAIThread::RunOnMainThread(const TaskFunc& func)
+{
+	CSkirmishAIThread* aiThread = currentAIThread;
+
+	if (aiThread == nullptr || Threading::IsMainThread())
+		return func();
+
+	std::unique_lock<spring::mutex> lock(aiThread->mutex);
+
+	// only the AI's own thread can get here, so there is never more than one task
+	assert(aiThread->task == nullptr);
+
+	aiThread->task = &func;
+	aiThread->cond.notify_all();
+
+	{
+		std::lock_guard<spring::mutex> taskLock(taskMutex);
+		numRequestedTasks += 1;
+	}
+
+	taskCond.notify_all();
+	aiThread->cond.wait(lock, [&]() { return (aiThread->task == nullptr); });
+
+	return aiThread->taskResult;
+}
+
+bool CSkirmishAIThread::WaitForTasks(spring_time endTime)
+{
+	std::unique_lock<spring::mutex> lock(taskMutex);
+
+	const spring_time waitTime = endTime - spring_gettime();
+	const std::chrono::nanoseconds waitDuration(std::max<int64_t>(waitTime.toNanoSecsi(), 0));
+
+	return (taskCond.wait_for(lock, waitDuration, [&]() { return (numRequestedTasks > 0); }));
+}
+
+void CSkirmishAIThread::SendPacket(std::shared_ptr<const netcode::RawPacket> pkt)
+{
+	CSkirmishAIThread* aiThread = currentAIThread;
+
+	if (aiThread == nullptr) {
+		clientNet->Send(std::move(pkt));
+		return;
+	}
+
+	std::lock_guard<spring::mutex> lock(aiThread->mutex);
+	aiThread->packets.emplace_back(std::move(pkt));
+}
@@ -0,0 +1,108 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SKIRMISH_AI_THREAD_H
+#define SKIRMISH_AI_THREAD_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+
+namespace netcode {
+	class RawPacket;
+}
+
+
+/**
+ * Runs the events of one Skirmish AI on a dedicated thread (AsyncSkirmishAIs).
+ *
+ * Events are queued by the sim thread and only handed over by Dispatch, after
+ * all network packets of the current update have been processed; Sync must be
+ * called before sim-state changes again. While dispatched events are running,
+ * anything the AI does that touches unsynced engine state or caches shared
+ * with the sim (quad-field queries, model loading) is passed back to the main
+ * thread (RunOnMainThread), which runs such tasks whenever it waits or is
+ * between drawing steps (WaitForTasks). The AI's network packets are held
+ * back until Sync so that they enter the network stream at a well-defined
+ * point.
+ */
+class CSkirmishAIThread {
+public:
+	typedef std::function<void()> EventFunc;
+	typedef std::function<int()> TaskFunc;
+
+	explicit CSkirmishAIThread(int skirmishAIId);
+	~CSkirmishAIThread();
+
+	CSkirmishAIThread(const CSkirmishAIThread&) = delete;
+	CSkirmishAIThread& operator = (const CSkirmishAIThread&) = delete;
+
+	/// main thread; the event is held until the next Dispatch
+	void QueueEvent(EventFunc&& func) { queuedEvents.emplace_back(std::move(func)); }
+
+	/// main thread; hands all queued events to the AI thread
+	void Dispatch();
+	/**
+	 * main thread; blocks until the AI thread has handled everything that
+	 * was dispatched, runs the tasks it requests meanwhile, then sends the
+	 * packets it produced
+	 */
+	void Sync();
+	/// main thread; runs a pending task requested by the AI thread, if any
+	void RunTasks();
+
+	/// thread-time spent handling events, in nanoseconds
+	int64_t GetCpuTime() const { return cpuTime.load(); }
+	size_t GetNumHandledEvents() const { return numHandledEvents.load(); }
+
+public:
+	/**
+	 * Executes func on the main thread if called from an AI thread (which
+	 * waits for the result), runs it directly everywhere else.
+	 */
+	static int RunOnMainThread(const TaskFunc& func);
+	/**
+	 * main thread; waits until any AI thread requests a task (returns true)
+	 * or endTime has passed (returns false)
+	 */
+	static bool WaitForTasks(spring_time endTime);
+	/**
+	 * Holds pkt back until the next Sync if it originates from an AI thread
+	 * (or a task run on its behalf), sends it directly everywhere else.
+	 */
+	static void SendPacket(std::shared_ptr<const netcode::RawPacket> pkt);
+
+private:
+	void Run();
+
+	int RunTask(const TaskFunc& func);
+	void SendPackets();
+
+private:
+	int skirmishAIId = -1;
+
+	/// only touched by the main thread
+	std::vector<EventFunc> queuedEvents;
+	/// only touched by the AI thread between Dispatch and Sync
+	std::vector<EventFunc> dispatchedEvents;
+
+	std::vector<std::shared_ptr<const netcode::RawPacket>> packets;
+
+	const TaskFunc* task = nullptr;
+	int taskResult = 0;
+
+	bool busy = false;
+	bool quit = false;
+
+	std::atomic<int64_t> cpuTime = {0};
+	std::atomic<size_t> numHandledEvents = {0};
+
+	spring::mutex mutex;
+	spring::condition_variable_any cond;
+	spring::thread thread;
+};
+
+#endif // SKIRMISH_AI_THREAD_H
@@ -17,6 +17,7 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
@@ -32,12 +33,15 @@
 
 #undef DeleteFile
 
+CONFIG(bool, AsyncSkirmishAIs).defaultValue(false).description("Run every native Skirmish AI on a thread of its own. Events are handed over once per update after all network packets have been processed, and the AI's orders enter the network stream when it has caught up. Events are handled in order, but when several frames are simulated per update the AI reads the state of the last one (also while handling Update for earlier frames). Before units are deleted the sim waits for the AI to handle all queued events, so destroy-events always see the unit.");
+
 CR_BIND(CSkirmishAIWrapper, )
 CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_MEMBER(key),
 
 	CR_IGNORED(library),
 	CR_IGNORED(callback),
+	CR_IGNORED(aiThread),
 
 	CR_MEMBER(timerName),
 
@@ -56,6 +60,9 @@ CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_POSTLOAD(PostLoad)
 ))
 
+CSkirmishAIWrapper::~CSkirmishAIWrapper() = default;
+
+
 void CSkirmishAIWrapper::PreInit(int aiID)
 {
 	const SkirmishAIData* aiData = skirmishAIHandler.GetSkirmishAI(aiID);
@@ -92,6 +99,9 @@ void CSkirmishAIWrapper::PreInit(int aiID)
 
 	LOG_L(L_INFO, "[AIWrapper::%s][AI=%d team=%d] creating callbacks", __func__, skirmishAIId, teamId);
 	CreateCallback();
+
+	if (configHandler->GetBool("AsyncSkirmishAIs"))
+		aiThread.reset(new CSkirmishAIThread(skirmishAIId));
 }
 
 void CSkirmishAIWrapper::PreDestroy() {
@@ -157,6 +167,14 @@ void CSkirmishAIWrapper::Init() {
 void CSkirmishAIWrapper::Kill()
 {
 	assert(Active());
+
+	if (aiThread != nullptr) {
+		FlushEvents();
+
+		LOG_L(L_INFO, "[AIWrapper::%s][AI=%d team=%d] handled %u events asynchronously in %.3fs of thread-time", __func__, skirmishAIId, teamId, unsigned(aiThread->GetNumHandledEvents()), aiThread->GetCpuTime() * 1e-9);
+		aiThread.reset();
+	}
+
 	// send release event
 	Release(skirmishAIHandler.GetLocalKillFlag(skirmishAIId));
 
@@ -189,6 +207,8 @@ void CSkirmishAIWrapper::Release(int reason)
 	if (!initialized || released)
 		return;
 
+	FlushEvents();
+
 	// NOTE: further cleanup is done in the destructor
 	const SReleaseEvent evtData = {reason};
 	HandleEvent(EVENT_RELEASE, &evtData);
@@ -197,6 +217,43 @@ void CSkirmishAIWrapper::Release(int reason)
 }
 
 
+void CSkirmishAIWrapper::DispatchEvents()
+{
+	if (aiThread == nullptr)
+		return;
+
+	aiThread->RunTasks();
+	aiThread->Dispatch();
+}
+
+void CSkirmishAIWrapper::RunTasks()
+{
+	if (aiThread == nullptr)
+		return;
+
+	aiThread->RunTasks();
+}
+
+void CSkirmishAIWrapper::SyncEvents()
+{
+	if (aiThread == nullptr)
+		return;
+
+	aiThread->Sync();
+}
+
+void CSkirmishAIWrapper::FlushEvents()
+{
+	if (aiThread == nullptr)
+		return;
+
+	// the previous batch might still be running, hand over the rest after it
+	aiThread->Sync();
+	aiThread->Dispatch();
+	aiThread->Sync();
+}
+
+
 void CSkirmishAIWrapper::SendInitEvent()
 {
 	const SInitEvent evtData = {skirmishAIId, callback};
@@ -285,6 +342,7 @@ void CSkirmishAIWrapper::Load(std::istream* loadStream)
 	}
 
 	assert(Active());
+	FlushEvents();
 	HandleEvent(EVENT_LOAD, &evtData);
 
 	FileSystem::DeleteFile(tmpFile);
@@ -296,6 +354,7 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 	const SSaveEvent evtData = {tmpFile.c_str()};
 
 	assert(Active());
+	FlushEvents();
 	HandleEvent(EVENT_SAVE, &evtData);
 
 	if (!FileSystem::FileExists(tmpFile))
@@ -315,23 +374,31 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 
 
 void CSkirmishAIWrapper::UnitIdle(int unitId) {
-	const SUnitIdleEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_IDLE, &evtData);
+	DispatchEvent([=]() {
+		const SUnitIdleEvent evtData = {unitId};
+		HandleEvent(EVENT_UNIT_IDLE, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) {
-	const SUnitCreatedEvent evtData = {unitId, builderId};
-	HandleEvent(EVENT_UNIT_CREATED, &evtData);
+	DispatchEvent([=]() {
+		const SUnitCreatedEvent evtData = {unitId, builderId};
+		HandleEvent(EVENT_UNIT_CREATED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitFinished(int unitId) {
-	const SUnitFinishedEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_FINISHED, &evtData);
+	DispatchEvent([=]() {
+		const SUnitFinishedEvent evtData = {unitId};
+		HandleEvent(EVENT_UNIT_FINISHED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) {
-	const SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
-	HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
+	DispatchEvent([=]() {
+		const SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
+		HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitDamaged(
@@ -342,61 +409,83 @@ void CSkirmishAIWrapper::UnitDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
-	float3 cpyDir = dir;
-	const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
+	DispatchEvent([=]() {
+		float3 cpyDir = dir;
+		const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
-	HandleEvent(EVENT_UNIT_DAMAGED, &evtData);
+		HandleEvent(EVENT_UNIT_DAMAGED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitMoveFailed(int unitId) {
-	const SUnitMoveFailedEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
+	DispatchEvent([=]() {
+		const SUnitMoveFailedEvent evtData = {unitId};
+		HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) {
-	const SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
-	HandleEvent(EVENT_UNIT_GIVEN, &evtData);
+	DispatchEvent([=]() {
+		const SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
+		HandleEvent(EVENT_UNIT_GIVEN, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) {
-	const SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
-	HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
+	DispatchEvent([=]() {
+		const SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
+		HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
+	});
 }
 
 
 void CSkirmishAIWrapper::EnemyCreated(int unitId) {
-	const SEnemyCreatedEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_CREATED, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyCreatedEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_CREATED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyFinished(int unitId) {
-	const SEnemyFinishedEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyFinishedEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
-	const SEnemyEnterLOSEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyEnterLOSEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
-	const SEnemyLeaveLOSEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyLeaveLOSEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
-	const SEnemyEnterRadarEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyEnterRadarEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
-	const SEnemyLeaveRadarEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyLeaveRadarEvent evtData = {unitId};
+		HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) {
-	const SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
-	HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
+	DispatchEvent([=]() {
+		const SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
+		HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::EnemyDamaged(
@@ -407,30 +496,40 @@ void CSkirmishAIWrapper::EnemyDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
-	float3 cpyDir = dir;
-	const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
+	DispatchEvent([=]() {
+		float3 cpyDir = dir;
+		const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
-	HandleEvent(EVENT_ENEMY_DAMAGED, &evtData);
+		HandleEvent(EVENT_ENEMY_DAMAGED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::Update(int frame) {
-	const SUpdateEvent evtData = {frame};
-	HandleEvent(EVENT_UPDATE, &evtData);
+	DispatchEvent([=]() {
+		const SUpdateEvent evtData = {frame};
+		HandleEvent(EVENT_UPDATE, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::SendChatMessage(const char* msg, int fromPlayerId) {
-	const SMessageEvent evtData = {fromPlayerId, msg};
-	HandleEvent(EVENT_MESSAGE, &evtData);
+	DispatchEvent([=, cpyMsg = std::string(msg)]() {
+		const SMessageEvent evtData = {fromPlayerId, cpyMsg.c_str()};
+		HandleEvent(EVENT_MESSAGE, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData) {
-	const SLuaMessageEvent evtData = {inData /*outData*/};
-	HandleEvent(EVENT_LUA_MESSAGE, &evtData);
+	DispatchEvent([=, cpyData = std::string(inData)]() {
+		const SLuaMessageEvent evtData = {cpyData.c_str() /*outData*/};
+		HandleEvent(EVENT_LUA_MESSAGE, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
-	const SWeaponFiredEvent evtData = {unitId, weaponDefId};
-	HandleEvent(EVENT_WEAPON_FIRED, &evtData);
+	DispatchEvent([=]() {
+		const SWeaponFiredEvent evtData = {unitId, weaponDefId};
+		HandleEvent(EVENT_WEAPON_FIRED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::PlayerCommandGiven(
@@ -438,17 +537,20 @@ void CSkirmishAIWrapper::PlayerCommandGiven(
 	const Command& c,
 	int playerId
 ) {
-	std::vector<int> unitIds = playerSelectedUnits;
-
 	const int cCommandId = extractAICommandTopic(&c, unitHandler.MaxUnits());
-	const SPlayerCommandEvent evtData = {&unitIds[0], static_cast<int>(playerSelectedUnits.size()), cCommandId, playerId};
 
-	HandleEvent(EVENT_PLAYER_COMMAND, &evtData);
+	DispatchEvent([=, unitIds = playerSelectedUnits]() mutable {
+		const SPlayerCommandEvent evtData = {&unitIds[0], static_cast<int>(unitIds.size()), cCommandId, playerId};
+
+		HandleEvent(EVENT_PLAYER_COMMAND, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) {
-	const SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
-	HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
+	DispatchEvent([=]() {
+		const SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
+		HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
+	});
 }
 
 void CSkirmishAIWrapper::SeismicPing(
@@ -457,10 +559,12 @@ void CSkirmishAIWrapper::SeismicPing(
 	const float3& pos,
 	float strength
 ) {
-	/*const*/ float3 cpyPos = pos;
-	const SSeismicPingEvent evtData = {&cpyPos[0], strength};
+	DispatchEvent([=]() {
+		/*const*/ float3 cpyPos = pos;
+		const SSeismicPingEvent evtData = {&cpyPos[0], strength};
 
-	HandleEvent(EVENT_SEISMIC_PING, &evtData);
+		HandleEvent(EVENT_SEISMIC_PING, &evtData);
+	});
 }
 
 
@@ -4,6 +4,9 @@
 #define SKIRMISH_AI_WRAPPER_H
 
 #include "SkirmishAIKey.h"
+#include "SkirmishAIThread.h"
+
+#include <memory>
 
 class CSkirmishAILibrary;
 struct SSkirmishAICallback;
@@ -24,6 +27,7 @@ private:
 public:
 	/// used only by creg
 	CSkirmishAIWrapper() = default;
+	~CSkirmishAIWrapper();
 
 	CSkirmishAIWrapper(const CSkirmishAIWrapper& w) = delete;
 	CSkirmishAIWrapper(CSkirmishAIWrapper&& w) = delete;
@@ -58,6 +62,15 @@ public:
 	/// @see SReleaseEvent in Interface/AISEvents.h
 	void Release(int reason = 0 /* = unspecified */);
 
+	/// AsyncSkirmishAIs only: hands all queued events to the AI thread
+	void DispatchEvents();
+	/// AsyncSkirmishAIs only: runs a task the AI thread passed to the main thread, if any
+	void RunTasks();
+	/// AsyncSkirmishAIs only: waits until the AI thread has handled the dispatched events
+	void SyncEvents();
+	/// AsyncSkirmishAIs only: waits until the AI thread has handled every event queued so far
+	void FlushEvents();
+
 
 	// AI Events
 	void Load(std::istream *s);
@@ -113,6 +126,18 @@ private:
 	void SendInitEvent();
 	void SendUnitEvents();
 
+	/**
+	 * Handles the event right away, or queues it for the AI thread when the
+	 * AI runs asynchronously; func therefore has to own copies of its data.
+	 */
+	template<typename F> void DispatchEvent(F&& func) {
+		if (aiThread != nullptr) {
+			aiThread->QueueEvent(std::forward<F>(func));
+		} else {
+			func();
+		}
+	}
+
 	/**
 	 * CAUTION: takes C AI Interface events, not engine C++ ones!
 	 */
@@ -129,6 +154,9 @@ private:
 	const CSkirmishAILibrary* library = nullptr;
 	const SSkirmishAICallback* callback = nullptr;
 
+	/// non-null if the AI runs on a thread of its own (AsyncSkirmishAIs)
+	std::unique_ptr<CSkirmishAIThread> aiThread;
+
 	// first 4 bytes store hash(timerName + 4)
 	char timerName[sizeof(uint32_t) + 60] = {0};
 
@@ -20,6 +20,7 @@ ClientSetup::ClientSetup()
 	: hostIP(configHandler->GetString("HostIPDefault"))
 	, hostPort(configHandler->GetInt("HostPortDefault"))
 	, isHost(false)
+	, batchReplay(false)
 {
 }
 
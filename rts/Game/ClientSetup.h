@@ -28,6 +28,8 @@ public:
 	int hostPort;
 
 	bool isHost;
+	//! demo is played back unthrottled and the game quits when it ends (--replay-report)
+	bool batchReplay;
 };
 
 #endif // CLIENT_SETUP_H
@@ -12,6 +12,7 @@
 #include "GameSetup.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
+#include "ReplayReport.h"
 #include "SelectedUnitsHandler.h"
 #include "WaitCommandsAI.h"
 #include "WordCompletion.h"
@@ -46,6 +47,7 @@
 #include "Rendering/UnitDrawer.h"
 #include "Rendering/UniformConstants.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Models/IModelParser.h"
 #include "Rendering/Textures/NamedTextures.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
@@ -88,7 +90,9 @@
 #include "Sim/Units/Scripts/UnitScriptFactory.h"
 #include "Sim/Units/Scripts/UnitScriptEngine.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
+#include "Sim/Weapons/WeaponDef.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/WeaponLoader.h"
 #include "UI/CommandColors.h"
@@ -111,7 +115,10 @@
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/VFSHandler.h"
 #include "System/LoadSave/LoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
@@ -120,6 +127,7 @@
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Threading/TaskGraph.h"
 #include "System/TimeProfiler.h"
 
 
@@ -137,6 +145,7 @@ CONFIG(bool, ShowSpeed).defaultValue(false).description("Displays current game s
 CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
+CONFIG(std::string, LoadTraceFile).defaultValue("").description("If set, the timeline of the game-load stages is written to this file (relative to the write-dir) in Chrome's trace-event format.");
 
 
 CGame* game = nullptr;
@@ -351,78 +360,84 @@ void CGame::Load(const std::string& mapFileName)
 	Watchdog::RegisterThread(WDT_LOAD);
 
 	auto& globalQuit = gu->globalQuit;
-	bool  forcedQuit = false;
+
+	// can be set by tasks running on worker threads
+	std::atomic<bool> forcedQuit = {false};
 
 	LuaParser baseDefsParser("gamedata/defs.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_ZIP, {true}, {false});
 	LuaParser nullDefsParser("return {UnitDefs = {}, FeatureDefs = {}, WeaponDefs = {}, ArmorDefs = {}, MoveDefs = {}}", SPRING_VFS_ZIP, 0, {true}, {true});
 
 	LuaParser* defsParser = &baseDefsParser;
 
-	try {
-		LOG("[Game::%s][1] globalQuit=%d threaded=%d", __func__, globalQuit.load(), !Threading::IsMainThread());
+	// decompress the solid blocks of .sd7 game and map archives in parallel
+	// up front, instead of one at a time (and possibly repeatedly) on demand
+	vfsHandler->PrefetchArchives({CVFSHandler::Section::Mod, CVFSHandler::Section::Map});
 
-		LoadMap(mapFileName);
-		LoadDefs(defsParser);
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][1] forced quit with exception \"%s\"", __func__, e.what());
+	enum {
+		LOAD_TASK_WORKER    = 1, // touches neither GL nor Lua nor the loadscreen, can run on the ThreadPool
+		LOAD_TASK_SKIPPABLE = 2, // skipped once an earlier task has failed
+	};
 
-		defsParser = &nullDefsParser;
-		defsParser->Execute();
-
-		// we can not (yet) do a clean early exit here because the dtor assumes
-		// all loading stages proceeded normally; just force automatic shutdown
-		forcedQuit = true;
-	}
+	CTaskGraph loadGraph;
 
-	try {
-		LOG("[Game::%s][2] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+	const auto AddLoadTask = [&](const char* name, const std::vector<unsigned int>& deps, unsigned int flags, std::function<void()> func) {
+		const auto LoadTask = [&, name, flags, func = std::move(func)]() {
+			if ((flags & LOAD_TASK_SKIPPABLE) != 0 && forcedQuit)
+				return;
 
-		PreLoadSimulation(defsParser);
-		PreLoadRendering();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][2] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
+			try {
+				LOG("[Game::Load][%s] globalQuit=%d forcedQuit=%d", name, globalQuit.load(), forcedQuit.load());
+				func();
+			} catch (const content_error& e) {
+				LOG_L(L_WARNING, "[Game::Load][%s] forced quit with exception \"%s\"", name, e.what());
 
-	try {
-		LOG("[Game::%s][3] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+				// we can not (yet) do a clean early exit here because the dtor assumes
+				// all loading stages proceeded normally; just force automatic shutdown
+				// (the remaining simulation and rendering stages still run, Lua does not)
+				forcedQuit = true;
+			}
+		};
 
-		PostLoadSimulation(defsParser);
-		PostLoadRendering();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][3] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
+		return loadGraph.AddTask(name, deps, LoadTask, (flags & LOAD_TASK_WORKER) != 0);
+	};
+	const auto UseNullDefs = [&]() {
+		defsParser = &nullDefsParser;
+		defsParser->Execute();
+	};
+
+	// tasks bound to this thread run in the order they are added, these
+	// dependencies only matter for the ones that can run on worker threads
+	const unsigned int mapTask = AddLoadTask("LoadMap", {}, LOAD_TASK_SKIPPABLE, [&]() {
+		try { LoadMap(mapFileName); } catch (const content_error&) { UseNullDefs(); throw; }
+	});
+	const unsigned int defsTask = AddLoadTask("LoadDefs", {mapTask}, LOAD_TASK_SKIPPABLE, [&]() {
+		try { LoadDefs(defsParser); } catch (const content_error&) { UseNullDefs(); throw; }
+	});
+
+	// only need the heightmap, overlap with parsing the defs and CEGs
+	const unsigned int meshTask = AddLoadTask("SmoothHeightMesh", {mapTask}, LOAD_TASK_WORKER, [&]() {
+		smoothGround.Init(float3::maxxpos, float3::maxzpos, SQUARE_SIZE * 2, SQUARE_SIZE * 40);
+	});
+	const unsigned int quadTask = AddLoadTask("QuadField", {mapTask}, LOAD_TASK_WORKER, [&]() {
+		quadField.Init(int2(mapDims.mapx, mapDims.mapy), CQuadField::BASE_QUAD_SIZE);
+	});
+
+	const unsigned int preSimTask = AddLoadTask("PreLoadSimulation", {defsTask}, 0, [&]() { PreLoadSimulation(defsParser); });
+	const unsigned int preDrawTask = AddLoadTask("PreLoadRendering", {mapTask}, 0, [&]() { PreLoadRendering(); });
+
+	// features are inserted into the quadfield here
+	const unsigned int postSimTask = AddLoadTask("PostLoadSimulation", {preSimTask, preDrawTask, quadTask}, 0, [&]() { PostLoadSimulation(defsParser); });
+	const unsigned int modelTask = AddLoadTask("PreloadModels", {postSimTask}, LOAD_TASK_SKIPPABLE, [&]() { PreloadModels(); });
+	const unsigned int postDrawTask = AddLoadTask("PostLoadRendering", {modelTask}, 0, [&]() { PostLoadRendering(); });
 
 	// skip Lua handlers in case of forced exit
 	// makes the specific error(s) more obvious
-	if (!forcedQuit) {
-		try {
-			LOG("[Game::%s][4] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
-
-			LoadInterface();
-			LoadLua(saveFileHandler != nullptr, false);
-		} catch (const content_error& e) {
-			LOG_L(L_WARNING, "[Game::%s][4] forced quit with exception \"%s\"", __func__, e.what());
-			forcedQuit = true;
-		}
-	}
-
-	if (!forcedQuit) {
-		try {
-			LOG("[Game::%s][5] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
-
-			LoadFinalize();
-			LoadSkirmishAIs();
-		} catch (const content_error& e) {
-			LOG_L(L_WARNING, "[Game::%s][5] forced quit with exception \"%s\"", __func__, e.what());
-			forcedQuit = true;
-		}
-	}
-
-	try {
-		LOG("[Game::%s][6] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+	const unsigned int uiTask = AddLoadTask("LoadInterface", {postDrawTask, meshTask}, LOAD_TASK_SKIPPABLE, [&]() { LoadInterface(); });
+	const unsigned int luaTask = AddLoadTask("LoadLua", {uiTask}, LOAD_TASK_SKIPPABLE, [&]() { LoadLua(saveFileHandler != nullptr, false); });
+	const unsigned int finalizeTask = AddLoadTask("LoadFinalize", {luaTask}, LOAD_TASK_SKIPPABLE, [&]() { LoadFinalize(); });
+	const unsigned int aiTask = AddLoadTask("LoadSkirmishAIs", {finalizeTask}, LOAD_TASK_SKIPPABLE, [&]() { LoadSkirmishAIs(); });
 
+	AddLoadTask("LoadSavedGame", {aiTask}, 0, [&]() {
 		if (!globalQuit && saveFileHandler != nullptr) {
 			loadscreen->SetLoadMessage("Loading Saved Game");
 			saveFileHandler->LoadGame();
@@ -432,14 +447,25 @@ void CGame::Load(const std::string& mapFileName)
 		{
 			char msgBuf[512];
 
-			SNPRINTF(msgBuf, sizeof(msgBuf), "[Game::%s][lua{Rules,Gaia}={%p,%p}]", __func__, luaRules, luaGaia);
+			SNPRINTF(msgBuf, sizeof(msgBuf), "[Game::Load][lua{Rules,Gaia}={%p,%p}]", luaRules, luaGaia);
 			CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuf);
 		}
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][6] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
+	});
+
+	loadGraph.Run();
+
+	LOG("[Game::%s] ran %u load-tasks in %ims (%ims of work)", __func__, unsigned(loadGraph.GetNumTasks()), int(loadGraph.GetDuration().toMilliSecsi()), int(loadGraph.GetTaskDuration().toMilliSecsi()));
+
+	{
+		const std::string& traceFile = configHandler->GetString("LoadTraceFile");
+
+		if (!traceFile.empty())
+			loadGraph.WriteTrace(dataDirsAccess.LocateFile(traceFile, FileQueryFlags::WRITE));
 	}
 
+	// files loaded from here on are rare enough to not warrant holding the blocks
+	vfsHandler->ClearArchiveBlockCaches();
+
 	Watchdog::DeregisterThread(WDT_LOAD);
 	AddTimedJobs();
 
@@ -543,12 +569,9 @@ void CGame::PreLoadSimulation(LuaParser* defsParser)
 {
 	ENTER_SYNCED_CODE();
 
-	loadscreen->SetLoadMessage("Creating Smooth Height Mesh");
-	smoothGround.Init(float3::maxxpos, float3::maxzpos, SQUARE_SIZE * 2, SQUARE_SIZE * 40);
-
-	loadscreen->SetLoadMessage("Creating QuadField & CEGs");
+	// the smooth height mesh and quadfield are created on worker threads, see Load
+	loadscreen->SetLoadMessage("Loading MoveDefs & CEGs");
 	moveDefHandler.Init(defsParser);
-	quadField.Init(int2(mapDims.mapx, mapDims.mapy), CQuadField::BASE_QUAD_SIZE);
 	damageArrayHandler.Init(defsParser);
 	explGenHandler.Init();
 }
@@ -624,6 +647,29 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 }
 
 
+void CGame::PreloadModels()
+{
+	// load every model (and texture) the defs refer to now rather than when
+	// first drawn, which would make the game hitch whenever a new type shows
+	loadscreen->SetLoadMessage("Preloading Models");
+
+	std::vector<std::string> modelNames;
+	modelNames.reserve(unitDefHandler->NumUnitDefs() + featureDefHandler->GetFeatureDefsVec().size() + weaponDefHandler->NumWeaponDefs());
+
+	for (const UnitDef& unitDef: unitDefHandler->GetUnitDefsVec()) {
+		modelNames.push_back(unitDef.modelName);
+	}
+	for (const FeatureDef& featureDef: featureDefHandler->GetFeatureDefsVec()) {
+		modelNames.push_back(featureDef.modelName);
+	}
+	for (const WeaponDef& weaponDef: weaponDefHandler->GetWeaponDefsVec()) {
+		modelNames.push_back(weaponDef.visuals.modelName);
+	}
+
+	modelLoader.PreloadModels(std::move(modelNames));
+}
+
+
 void CGame::PreLoadRendering()
 {
 	geometricObjects = new CGeometricObjects();
@@ -1075,6 +1121,7 @@ bool CGame::Update()
 	ENTER_SYNCED_CODE();
 	SendClientProcUsage();
 	ClientReadNet(); // issues new SimFrame()s
+	eoh->RunSkirmishAIs(); // until the next processed net message
 
 	if (!gameOver) {
 		if (clientNet->NeedsReconnect())
@@ -1255,6 +1302,9 @@ bool CGame::Draw() {
 	if (UpdateUnsynced(currentTimePreUpdate))
 		return false;
 
+	// asynchronous AIs would otherwise wait for the next Update
+	eoh->RunSkirmishAITasks();
+
 	const spring_time currentTimePreDraw = spring_gettime();
 
 	SCOPED_SPECIAL_TIMER("Draw");
@@ -1270,7 +1320,7 @@ bool CGame::Draw() {
 	}
 
 	if (!globalRendering->active) {
-		spring_sleep(spring_msecs(10));
+		eoh->RunSkirmishAITasks(spring_msecs(10));
 
 		// return early if and only if less than 30K milliseconds have passed since last draw-frame
 		// so we force render two frames per minute when minimized to clear batches and free memory
@@ -1357,6 +1407,8 @@ bool CGame::Draw() {
 	SetDrawMode(gameNotDrawing);
 	CTeamHighlight::Disable();
 
+	eoh->RunSkirmishAITasks();
+
 	const spring_time currentTimePostDraw = spring_gettime();
 	const spring_time currentFrameDrawTime = currentTimePostDraw - currentTimePreDraw;
 	gu->avgDrawFrameTime = mix(gu->avgDrawFrameTime, currentFrameDrawTime.toMilliSecsf(), 0.05f);
@@ -1476,6 +1528,8 @@ void CGame::StartPlaying()
 
 	if (saveFileHandler == nullptr)
 		eventHandler.GameStart();
+
+	replayReport.StartPlaying();
 }
 
 
@@ -1563,7 +1617,7 @@ void CGame::SimFrame() {
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
 		const float msecSleepTime = (msecMaxSimFrameTime - msecDifSimFrameTime) * 0.5f;
 
-		if (msecSleepTime > 0.0f) {
+		if (msecSleepTime > 0.0f && !replayReport.IsEnabled()) {
 			spring_sleep(spring_msecs(msecSleepTime));
 		}
 	}
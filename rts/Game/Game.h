@@ -60,6 +60,7 @@ private:
 	void LoadDefs(LuaParser* defsParser);
 	void PreLoadSimulation(LuaParser* defsParser);
 	void PostLoadSimulation(LuaParser* defsParser);
+	void PreloadModels();
 	void PreLoadRendering();
 	void PostLoadRendering();
 	void LoadInterface();
@@ -0,0 +1,140 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ReplayReport.h"
+#include "GlobalUnsynced.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Team.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Misc/TeamStatistics.h"
+#include "System/Log/ILog.h"
+
+CReplayReport replayReport;
+
+
+static void WriteJSONString(FILE* f, const std::string& s)
+{
+	fputc('"', f);
+
+	for (const char c: s) {
+		switch (c) {
+			case '"' : { fputs("\\\"", f); } break;
+			case '\\': { fputs("\\\\", f); } break;
+			case '\n': { fputs("\\n" , f); } break;
+			case '\r': { fputs("\\r" , f); } break;
+			case '\t': { fputs("\\t" , f); } break;
+			default: {
+				if (static_cast<unsigned char>(c) < 0x20) {
+					fprintf(f, "\\u%04x", c);
+				} else {
+					fputc(c, f);
+				}
+			} break;
+		}
+	}
+
+	fputc('"', f);
+}
+
+
+void CReplayReport::Init(const std::string& reportFile, const std::string& demoFile)
+{
+	reportFileName = reportFile;
+	demoFileName = demoFile;
+
+	checksums.clear();
+	desyncs.clear();
+
+	initTime = spring_gettime();
+	playTime = initTime;
+
+	numDesyncs = 0;
+}
+
+void CReplayReport::StartPlaying()
+{
+	playTime = spring_gettime();
+}
+
+void CReplayReport::SimFrame(int frameNum, unsigned int checksum)
+{
+	if ((frameNum % CHECKSUM_INTERVAL) != 0)
+		return;
+
+	checksums.push_back({frameNum, checksum});
+}
+
+void CReplayReport::Desync(int frameNum, int playerNum, unsigned int demoChecksum, unsigned int localChecksum)
+{
+	if ((numDesyncs++) >= MAX_DESYNCS)
+		return;
+
+	desyncs.push_back({frameNum, playerNum, demoChecksum, localChecksum});
+}
+
+bool CReplayReport::Write()
+{
+	if (!IsEnabled())
+		return false;
+
+	FILE* f = fopen(reportFileName.c_str(), "w");
+
+	if (f == nullptr) {
+		LOG_L(L_ERROR, "[ReplayReport::%s] could not open \"%s\" for writing", __func__, reportFileName.c_str());
+		return false;
+	}
+
+	const spring_time curTime = spring_gettime();
+	const float loadSecs = (playTime - initTime).toSecsf();
+	const float playSecs = (curTime - playTime).toSecsf();
+	const int lastFrameNum = gs->frameNum;
+
+	fprintf(f, "{\n\t\"demo\": ");
+	WriteJSONString(f, demoFileName);
+	fprintf(f, ",\n");
+	fprintf(f, "\t\"frames\": %d,\n", lastFrameNum);
+	fprintf(f, "\t\"loadTime\": %.3f,\n", loadSecs);
+	fprintf(f, "\t\"playTime\": %.3f,\n", playSecs);
+	fprintf(f, "\t\"framesPerSecond\": %.2f,\n", lastFrameNum / std::max(playSecs, 0.001f));
+	fprintf(f, "\t\"avgSimFrameTime\": %.3f,\n", gu->avgSimFrameTime);
+	fprintf(f, "\t\"numDesyncs\": %d,\n", numDesyncs);
+
+	fprintf(f, "\t\"desyncs\": [");
+	for (size_t i = 0; i < desyncs.size(); i++) {
+		const DesyncInfo& d = desyncs[i];
+		const char* sep = (i > 0)? ",": "";
+
+		fprintf(f, "%s\n\t\t{\"frame\": %d, \"player\": %d, \"demoChecksum\": %u, \"localChecksum\": %u}", sep, d.frameNum, d.playerNum, d.demoChecksum, d.localChecksum);
+	}
+	fprintf(f, "\n\t],\n");
+
+	fprintf(f, "\t\"checksums\": [");
+	for (size_t i = 0; i < checksums.size(); i++) {
+		const char* sep = (i > 0)? ",": "";
+
+		fprintf(f, "%s\n\t\t{\"frame\": %d, \"checksum\": %u}", sep, checksums[i].frameNum, checksums[i].checksum);
+	}
+	fprintf(f, "\n\t],\n");
+
+	fprintf(f, "\t\"teams\": [");
+	for (int i = 0; i < teamHandler.ActiveTeams(); i++) {
+		const CTeam* team = teamHandler.Team(i);
+		const TeamStatistics& s = team->GetCurrentStats();
+
+		fprintf(f, "%s\n\t\t{", (i > 0)? ",": "");
+		fprintf(f, "\"team\": %d, \"allyTeam\": %d, \"gaia\": %s, \"dead\": %s, ", i, teamHandler.AllyTeam(i), (i == teamHandler.GaiaTeamID())? "true": "false", team->isDead? "true": "false");
+		fprintf(f, "\"stats\": {\"frame\": %d, ", s.frame);
+		fprintf(f, "\"metalUsed\": %.3f, \"energyUsed\": %.3f, \"metalProduced\": %.3f, \"energyProduced\": %.3f, ", s.metalUsed, s.energyUsed, s.metalProduced, s.energyProduced);
+		fprintf(f, "\"metalExcess\": %.3f, \"energyExcess\": %.3f, \"metalReceived\": %.3f, \"energyReceived\": %.3f, ", s.metalExcess, s.energyExcess, s.metalReceived, s.energyReceived);
+		fprintf(f, "\"metalSent\": %.3f, \"energySent\": %.3f, \"damageDealt\": %.3f, \"damageReceived\": %.3f, ", s.metalSent, s.energySent, s.damageDealt, s.damageReceived);
+		fprintf(f, "\"unitsProduced\": %d, \"unitsDied\": %d, \"unitsReceived\": %d, \"unitsSent\": %d, ", s.unitsProduced, s.unitsDied, s.unitsReceived, s.unitsSent);
+		fprintf(f, "\"unitsCaptured\": %d, \"unitsOutCaptured\": %d, \"unitsKilled\": %d}}", s.unitsCaptured, s.unitsOutCaptured, s.unitsKilled);
+	}
+	fprintf(f, "\n\t]\n}\n");
+	fclose(f);
+
+	LOG("[ReplayReport::%s] wrote \"%s\" (%d frames in %.2fs, %d desyncs)", __func__, reportFileName.c_str(), lastFrameNum, playSecs, numDesyncs);
+	return true;
+}
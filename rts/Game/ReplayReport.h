@@ -0,0 +1,59 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef REPLAY_REPORT_H
+#define REPLAY_REPORT_H
+
+#include <string>
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Misc/SpringTime.h"
+
+/**
+ * Collects timing, sync-checksum and team statistics while a demo is being
+ * played back in batch mode (--replay-report) and writes them as one JSON
+ * object when playback ends, for tools/DemoTool/batch_replay.py to gather.
+ */
+class CReplayReport
+{
+public:
+	void Init(const std::string& reportFile, const std::string& demoFile);
+	void StartPlaying();
+	void SimFrame(int frameNum, unsigned int checksum);
+	void Desync(int frameNum, int playerNum, unsigned int demoChecksum, unsigned int localChecksum);
+	bool Write();
+
+	bool IsEnabled() const { return !reportFileName.empty(); }
+
+	/// checksums are sampled once per this many frames (one minute game-time)
+	static constexpr int CHECKSUM_INTERVAL = GAME_SPEED * 60;
+	/// only the first few desyncs are stored, the rest are just counted
+	static constexpr int MAX_DESYNCS = 64;
+
+private:
+	struct FrameChecksum {
+		int frameNum;
+		unsigned int checksum;
+	};
+	struct DesyncInfo {
+		int frameNum;
+		int playerNum;
+		unsigned int demoChecksum;
+		unsigned int localChecksum;
+	};
+
+	std::string reportFileName;
+	std::string demoFileName;
+
+	std::vector<FrameChecksum> checksums;
+	std::vector<DesyncInfo> desyncs;
+
+	spring_time initTime;
+	spring_time playTime;
+
+	int numDesyncs = 0;
+};
+
+extern CReplayReport replayReport;
+
+#endif // REPLAY_REPORT_H
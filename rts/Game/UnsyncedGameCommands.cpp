@@ -2909,6 +2909,24 @@ public:
 	}
 };
 
+class GroundRayBenchmarkActionExecutor : public IUnsyncedActionExecutor {
+public:
+	GroundRayBenchmarkActionExecutor(): IUnsyncedActionExecutor("GroundRayBenchmark", "Times ground ray-casts over random rays on the current map") {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		// append a default so the arg can be safely omitted
+		std::istringstream buf(action.GetArgs() + " 100000");
+
+		unsigned int numRays = 0;
+
+		buf >> numRays;
+
+		CGround::BenchmarkLineGroundCol(std::max(numRays, 1u));
+		return true;
+	}
+};
+
 
 
 class CrashActionExecutor : public IUnsyncedActionExecutor {
@@ -3412,6 +3430,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<DebugColVolDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugPathDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugTraceRayDrawerActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<GroundRayBenchmarkActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MuteActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundChannelEnableActionExecutor>());
@@ -134,13 +134,16 @@ void LuaMemPool::LogStats(const char* handle, const char* lctype) const
 		);
 	#else
 		LOG(
-			"[LuaMemPool::%s][handle=%s (%s)] index=" _STPF_ " {numAllocs[*],allocSums[*]}={" _STPF_ "," _STPF_ "} {int,ext,rec}Allocs={" _STPF_ "," _STPF_ "," _STPF_ "} {chunk,block}Bytes={" _STPF_ "," _STPF_ "}",
+			"[LuaMemPool::%s][handle=%s (%s)] index=" _STPF_ " {numAllocs[*],allocSums[*]}={" _STPF_ "," _STPF_ "} {peakAllocs[*],peakSums[*],cacheHits[*]}={" _STPF_ "," _STPF_ "," _STPF_ "} {int,ext,rec}Allocs={" _STPF_ "," _STPF_ "," _STPF_ "} {chunk,block}Bytes={" _STPF_ "," _STPF_ "}",
 			__func__,
 			handle,
 			lctype,
 			globalIndex,
 			poolImpl.numAllocs[PoolImpl::NUM_POOLS],
 			poolImpl.allocSums[PoolImpl::NUM_POOLS],
+			poolImpl.peakAllocs[PoolImpl::NUM_POOLS],
+			poolImpl.peakSums[PoolImpl::NUM_POOLS],
+			poolImpl.cacheHits[PoolImpl::NUM_POOLS],
 			allocStats[STAT_NIA],
 			allocStats[STAT_NEA],
 			allocStats[STAT_NRA],
@@ -151,6 +154,21 @@ void LuaMemPool::LogStats(const char* handle, const char* lctype) const
 }
 
 
+size_t LuaMemPool::GetSizeClassStats(SizeClassStats* stats, size_t maxStats) const
+{
+	#if (LMP_USE_CHUNK_TABLE == 0)
+	if (!LuaMemPool::enabled)
+		return 0;
+
+	maxStats = std::min(maxStats, size_t(PoolImpl::NUM_POOLS));
+	poolImpl.GetStats(stats, maxStats);
+	return maxStats;
+	#else
+	return 0;
+	#endif
+}
+
+
 void LuaMemPool::DeleteBlocks()
 {
 	#if (LMP_USE_CHUNK_TABLE == 1)
@@ -261,8 +279,12 @@ void LuaMemPool::Free(void* ptr, size_t size)
 
 void LuaMemPool::PoolImpl::Init() {
 	poolPtrs.fill(nullptr);
+	freeCacheSizes.fill(0);
 	numAllocs.fill(0);
 	allocSums.fill(0);
+	peakAllocs.fill(0);
+	peakSums.fill(0);
+	cacheHits.fill(0);
 
 	poolPtrs[ 0] = NewPool< 0>();
 	poolPtrs[ 1] = NewPool< 1>();
@@ -323,6 +345,8 @@ void LuaMemPool::PoolImpl::Kill() {
 	KillPool<26>();
 
 	poolPtrs.fill(nullptr);
+	// cached chunks pointed into the now-destroyed pools
+	freeCacheSizes.fill(0);
 }
 
 
@@ -334,6 +358,17 @@ void* LuaMemPool::PoolImpl::Alloc(uint32_t size) {
 	numAllocs[   NUM_POOLS] += 1;
 	allocSums[   NUM_POOLS] += size;
 
+	peakAllocs[subPoolIndex] = std::max(peakAllocs[subPoolIndex], numAllocs[subPoolIndex]);
+	peakSums[subPoolIndex] = std::max(peakSums[subPoolIndex], allocSums[subPoolIndex]);
+	peakAllocs[   NUM_POOLS] = std::max(peakAllocs[   NUM_POOLS], numAllocs[   NUM_POOLS]);
+	peakSums[   NUM_POOLS] = std::max(peakSums[   NUM_POOLS], allocSums[   NUM_POOLS]);
+
+	if (subPoolIndex <= MAX_CACHED_POOL && freeCacheSizes[subPoolIndex] > 0) {
+		cacheHits[subPoolIndex] += 1;
+		cacheHits[   NUM_POOLS] += 1;
+		return freeCache[subPoolIndex][--freeCacheSizes[subPoolIndex]];
+	}
+
 	switch (subPoolIndex) {
 		case  0: { return (GetPool< 0>()->allocMem(size)); } break;
 		case  1: { return (GetPool< 1>()->allocMem(size)); } break;
@@ -384,6 +419,11 @@ void LuaMemPool::PoolImpl::Free(void* ptr, uint32_t size) {
 
 	assert(ptr != nullptr);
 
+	if (subPoolIndex <= MAX_CACHED_POOL && freeCacheSizes[subPoolIndex] < NUM_CACHED_CHUNKS) {
+		freeCache[subPoolIndex][freeCacheSizes[subPoolIndex]++] = ptr;
+		return;
+	}
+
 	switch (subPoolIndex) {
 		case  0: { return (GetPool< 0>()->freeMem(ptr)); } break;
 		case  1: { return (GetPool< 1>()->freeMem(ptr)); } break;
@@ -420,3 +460,23 @@ void LuaMemPool::PoolImpl::Free(void* ptr, uint32_t size) {
 	}
 }
 
+
+void LuaMemPool::PoolImpl::GetStats(SizeClassStats* stats, size_t numStats) const {
+	// pools [27, NUM_POOLS) are never instantiated (see Init)
+	std::array<size_t, NUM_POOLS> poolBytes;
+	poolBytes.fill(0);
+	GetPoolBytes(poolBytes, std::make_index_sequence<27>());
+
+	for (size_t i = 0; i < numStats; i++) {
+		SizeClassStats& s = stats[i];
+
+		s.pageSize   = size_t(1) << i;
+		s.numAllocs  = numAllocs[i];
+		s.allocSums  = allocSums[i];
+		s.peakAllocs = peakAllocs[i];
+		s.peakSums   = peakSums[i];
+		s.poolBytes  = poolBytes[i];
+		s.freeBytes  = poolBytes[i] - std::min(poolBytes[i], numAllocs[i] * s.pageSize);
+		s.cacheHits  = cacheHits[i];
+	}
+}
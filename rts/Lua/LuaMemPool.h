@@ -3,7 +3,9 @@
 #ifndef LUA_MEM_POOL_H_
 #define LUA_MEM_POOL_H_
 
+#include <array>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "System/bitops.h"
@@ -14,6 +16,18 @@
 
 class CLuaHandle;
 class LuaMemPool {
+public:
+	struct SizeClassStats {
+		size_t pageSize;   // bytes per chunk handed out by this class
+		size_t numAllocs;  // live allocations
+		size_t allocSums;  // live requested bytes
+		size_t peakAllocs; // high-water mark of numAllocs
+		size_t peakSums;   // high-water mark of allocSums
+		size_t poolBytes;  // bytes reserved by the class' pages (~RSS)
+		size_t freeBytes;  // bytes in reserved pages not currently handed out
+		size_t cacheHits;  // allocs served from the recycle cache
+	};
+
 public:
 	explicit LuaMemPool(bool isEnabled);
 	explicit LuaMemPool(size_t lmpIndex);
@@ -68,6 +82,9 @@ public:
 	void Free(void* ptr, size_t size);
 
 	void LogStats(const char* handle, const char* lctype) const;
+	// returns the number of entries written (0 if pooling is disabled)
+	size_t GetSizeClassStats(SizeClassStats* stats, size_t maxStats) const;
+
 	void ClearStats(bool b) {
 		allocStats[STAT_NIA] *= (1 - b);
 		allocStats[STAT_NEA] *= (1 - b);
@@ -78,6 +95,9 @@ public:
 		#if (LMP_USE_CHUNK_TABLE == 0)
 		poolImpl.numAllocs.fill(0);
 		poolImpl.allocSums.fill(0);
+		poolImpl.peakAllocs.fill(0);
+		poolImpl.peakSums.fill(0);
+		poolImpl.cacheHits.fill(0);
 		#endif
 	}
 
@@ -130,8 +150,22 @@ private:
 		std::array<uint8_t[sizeof(FixedDynMemPool<0, NUM_CHUNKS[NUM_POOLS - 1], 0>)], NUM_POOLS> memPools;
 		std::array<void*, NUM_POOLS> poolPtrs;
 
+		// small LIFO of recently freed chunks per size-class; each (non-shared)
+		// pool is owned by a single Lua state and thus only ever touched from
+		// one thread at a time, so this acts as a lock-free thread-local fast
+		// path that bypasses FixedDynMemPool's index bookkeeping and zero-fill
+		static constexpr uint32_t NUM_CACHED_CHUNKS = 32;
+		// only cache the small and frequent classes (up to 1KB chunks)
+		static constexpr uint32_t MAX_CACHED_POOL = 10;
+
+		std::array<std::array<void*, NUM_CACHED_CHUNKS>, MAX_CACHED_POOL + 1> freeCache;
+		std::array<uint32_t, MAX_CACHED_POOL + 1> freeCacheSizes;
+
 		std::array<size_t, NUM_POOLS + 1> numAllocs;
 		std::array<size_t, NUM_POOLS + 1> allocSums;
+		std::array<size_t, NUM_POOLS + 1> peakAllocs;
+		std::array<size_t, NUM_POOLS + 1> peakSums;
+		std::array<size_t, NUM_POOLS + 1> cacheHits;
 
 	public:
 		static uint32_t CalcPoolIndex(uint32_t alloc) {
@@ -151,17 +185,29 @@ private:
 			return (static_cast<PoolType*>(poolPtrs[i]));
 		}
 
+		template<size_t i, typename PoolType = FixedDynMemPool<1 << i, NUM_CHUNKS[i], NUM_PAGES[i]>>
+		const PoolType* GetPool() const {
+			return (static_cast<const PoolType*>(poolPtrs[i]));
+		}
+
 		template<size_t i, typename PoolType = FixedDynMemPool<1 << i, NUM_CHUNKS[i], NUM_PAGES[i]>>
 		void KillPool() {
 			GetPool<i>()->~PoolType();
 		}
 
+		template<size_t... i>
+		void GetPoolBytes(std::array<size_t, NUM_POOLS>& poolBytes, std::index_sequence<i...>) const {
+			((poolBytes[i] = GetPool<i>()->alloc_size()), ...);
+		}
+
 
 		void Init();
 		void Kill();
 
 		void* Alloc(uint32_t size);
 		void Free(void* ptr, uint32_t size);
+
+		void GetStats(SizeClassStats* stats, size_t numStats) const;
 	};
 
 	PoolImpl poolImpl;
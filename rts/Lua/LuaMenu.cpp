@@ -259,6 +259,7 @@ bool CLuaMenu::LoadLuaMenuFunctions(lua_State* L)
 bool CLuaMenu::LoadUnsyncedReadFunctions(lua_State* L)
 {
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetLuaMemUsage);
+	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetLuaMemPoolStats);
 
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetViewGeometry);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetWindowGeometry);
@@ -701,6 +701,64 @@ int LuaParser::DontMessWithMyCase(lua_State* L)
 //  LuaTable
 //
 
+// everything the LuaTable accessors query from a value, taken while it was on the stack
+struct LuaTableSnapshotValue {
+	int type = LUA_TNIL;  // lua_type
+	int intValue = 0;     // lua_toint
+	int length = 0;       // lua_objlen
+
+	lua_Number number = 0; // lua_tonumber
+
+	bool isNumber = false; // lua_isnumber (true for numeric strings)
+	bool isString = false; // lua_isstring (true for numbers)
+	bool boolean = false;  // lua_toboolean
+
+	std::string string; // lua_tostring
+
+	const LuaTableSnapshotNode* table = nullptr;
+};
+
+struct LuaTableSnapshotNode {
+	const LuaTableSnapshotValue* Find(const std::string& key) const {
+		const auto it = strEntryIndex.find(key);
+
+		if (it == strEntryIndex.end())
+			return nullptr;
+
+		return &strEntries[it->second].second;
+	}
+	const LuaTableSnapshotValue* Find(int key) const {
+		const auto it = intEntryIndex.find(key);
+
+		if (it == intEntryIndex.end())
+			return nullptr;
+
+		return &intEntries[it->second].second;
+	}
+
+	// both in lua_next order; numeric keys are stored as lua_toint returns them
+	std::vector<std::pair<std::string, LuaTableSnapshotValue>> strEntries;
+	std::vector<std::pair<int, LuaTableSnapshotValue>> intEntries;
+
+	spring::unordered_map<std::string, size_t> strEntryIndex;
+	// only keys that are exact integers can be looked up
+	spring::unordered_map<int, size_t> intEntryIndex;
+
+	int length = 0;
+};
+
+struct LuaTableSnapshot {
+	const LuaTableSnapshotNode* AddTable(lua_State* L, int table);
+	void AddValue(lua_State* L, LuaTableSnapshotValue& value);
+
+	std::vector<std::unique_ptr<LuaTableSnapshotNode>> nodes;
+	// tables referenced more than once (or recursively) are copied only once
+	spring::unordered_map<const void*, const LuaTableSnapshotNode*> tables;
+
+	bool lowerCppKeys = true;
+};
+
+
 LuaTable::LuaTable()
 : path(""),
   isValid(false),
@@ -739,6 +797,9 @@ LuaTable::LuaTable(const LuaTable& tbl)
 	L      = tbl.L;
 	path   = tbl.path;
 
+	snapshot     = tbl.snapshot;
+	snapshotNode = tbl.snapshotNode;
+
 	if (parser != nullptr)
 		parser->AddTable(this);
 
@@ -775,6 +836,9 @@ LuaTable& LuaTable::operator=(const LuaTable& tbl)
 	L    = tbl.L;
 	path = tbl.path;
 
+	snapshot     = tbl.snapshot;
+	snapshotNode = tbl.snapshotNode;
+
 	if (tbl.PushTable()) {
 		lua_pushvalue(L, -1); // copy
 		refnum = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -795,6 +859,17 @@ LuaTable LuaTable::SubTable(int key) const
 	SNPRINTF(buf, 32, "[%i]", key);
 	subTable.path = path + buf;
 
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = GetSnapshotValue(key);
+
+		if (value != nullptr && value->table != nullptr) {
+			subTable.snapshot = snapshot;
+			subTable.snapshotNode = value->table;
+		}
+
+		return subTable;
+	}
+
 	if (!PushTable())
 		return subTable;
 
@@ -817,11 +892,23 @@ LuaTable LuaTable::SubTable(int key) const
 
 LuaTable LuaTable::SubTable(const std::string& mixedKey) const
 {
-	const std::string key = !((parser != nullptr)? parser->lowerCppKeys : true) ? mixedKey : StringToLower(mixedKey);
+	const bool lowerCppKeys = (snapshot != nullptr)? snapshot->lowerCppKeys: ((parser != nullptr)? parser->lowerCppKeys : true);
+	const std::string key = !lowerCppKeys ? mixedKey : StringToLower(mixedKey);
 
 	LuaTable subTable;
 	subTable.path = path + "." + key;
 
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = snapshotNode->Find(key);
+
+		if (value != nullptr && value->table != nullptr) {
+			subTable.snapshot = snapshot;
+			subTable.snapshotNode = value->table;
+		}
+
+		return subTable;
+	}
+
 	if (!PushTable())
 		return subTable;
 
@@ -847,7 +934,7 @@ LuaTable LuaTable::SubTableExpr(const std::string& expr) const
 	if (expr.empty())
 		return LuaTable(*this);
 
-	if (!isValid)
+	if (!isValid && snapshotNode == nullptr)
 		return LuaTable();
 
 	std::string::size_type endPos;
@@ -896,6 +983,139 @@ LuaTable::~LuaTable()
 }
 
 
+/******************************************************************************/
+/******************************************************************************/
+//
+//  Snapshots
+//
+
+const LuaTableSnapshotNode* LuaTableSnapshot::AddTable(lua_State* L, int table)
+{
+	const void* tablePtr = lua_topointer(L, table);
+	const auto it = tables.find(tablePtr);
+
+	if (it != tables.end())
+		return it->second;
+
+	nodes.emplace_back(new LuaTableSnapshotNode());
+
+	LuaTableSnapshotNode* node = nodes.back().get();
+	node->length = lua_objlen(L, table);
+
+	tables[tablePtr] = node;
+
+	for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+		if (lua_israwstring(L, -2)) {
+			node->strEntryIndex[lua_tostring(L, -2)] = node->strEntries.size();
+			node->strEntries.emplace_back(lua_tostring(L, -2), LuaTableSnapshotValue());
+
+			AddValue(L, node->strEntries.back().second);
+			continue;
+		}
+
+		if (lua_israwnumber(L, -2)) {
+			const int intKey = lua_toint(L, -2);
+
+			if (lua_tonumber(L, -2) == lua_Number(intKey))
+				node->intEntryIndex[intKey] = node->intEntries.size();
+
+			node->intEntries.emplace_back(intKey, LuaTableSnapshotValue());
+
+			AddValue(L, node->intEntries.back().second);
+		}
+	}
+
+	return node;
+}
+
+void LuaTableSnapshot::AddValue(lua_State* L, LuaTableSnapshotValue& value)
+{
+	value.type = lua_type(L, -1);
+	value.boolean = lua_toboolean(L, -1);
+	value.isNumber = lua_isnumber(L, -1);
+	value.number = lua_tonumber(L, -1);
+	value.intValue = lua_toint(L, -1);
+	value.isString = lua_isstring(L, -1);
+
+	if (value.type == LUA_TTABLE)
+		value.table = AddTable(L, lua_gettop(L));
+
+	// both convert numbers to strings, but only in this stack slot
+	value.length = lua_objlen(L, -1);
+
+	if (value.isString)
+		value.string = lua_tostring(L, -1);
+}
+
+
+LuaTable LuaTable::Snapshot() const
+{
+	if (snapshotNode != nullptr)
+		return *this;
+
+	LuaTable snapshotTable;
+	snapshotTable.path = path;
+
+	if (!PushTable())
+		return snapshotTable;
+
+	std::shared_ptr<LuaTableSnapshot> data = std::make_shared<LuaTableSnapshot>();
+	data->lowerCppKeys = parser->lowerCppKeys;
+
+	snapshotTable.snapshotNode = data->AddTable(L, lua_gettop(L));
+	snapshotTable.snapshot = std::move(data);
+	return snapshotTable;
+}
+
+
+const LuaTableSnapshotValue* LuaTable::GetSnapshotValue(int key) const
+{
+	return (snapshotNode->Find(key));
+}
+
+const LuaTableSnapshotValue* LuaTable::GetSnapshotValue(const std::string& mixedKey) const
+{
+	// mirrors PushValue
+	const std::string key = !snapshot->lowerCppKeys ? mixedKey : StringToLower(mixedKey);
+
+	if (key.find('.') == std::string::npos)
+		return (snapshotNode->Find(key));
+
+	// nested key (e.g. "subtable.subsub.mahkey")
+	const LuaTableSnapshotNode* node = snapshotNode;
+	const LuaTableSnapshotValue* value = nullptr;
+
+	size_t lastpos = 0;
+	size_t dotpos = key.find('.');
+
+	do {
+		const std::string subTableName = key.substr(lastpos, dotpos);
+		lastpos = dotpos + 1;
+		dotpos = key.find('.', lastpos);
+
+		if ((value = node->Find(subTableName)) == nullptr || value->table == nullptr)
+			return nullptr;
+
+		node = value->table;
+	} while (dotpos != std::string::npos);
+
+	const std::string keyname = key.substr(lastpos);
+
+	// try as string
+	if ((value = node->Find(keyname)) != nullptr)
+		return value;
+
+	// try as integer
+	bool failed;
+	const int i = StringToInt(keyname, &failed);
+
+	if (failed)
+		return nullptr;
+
+	return (node->Find(i));
+}
+
+
 /******************************************************************************/
 
 bool LuaTable::PushTable() const
@@ -1033,6 +1253,9 @@ bool LuaTable::PushValue(const std::string& mixedKey) const
 
 bool LuaTable::KeyExists(int key) const
 {
+	if (snapshotNode != nullptr)
+		return (GetSnapshotValue(key) != nullptr);
+
 	if (!PushValue(key))
 		return false;
 
@@ -1043,6 +1266,9 @@ bool LuaTable::KeyExists(int key) const
 
 bool LuaTable::KeyExists(const std::string& key) const
 {
+	if (snapshotNode != nullptr)
+		return (GetSnapshotValue(key) != nullptr);
+
 	if (!PushValue(key))
 		return false;
 
@@ -1057,39 +1283,49 @@ bool LuaTable::KeyExists(const std::string& key) const
 //  Value types
 //
 
+static LuaTable::DataType ToDataType(int type)
+{
+	switch (type) {
+		case LUA_TBOOLEAN: return LuaTable::BOOLEAN;
+		case LUA_TNUMBER:  return LuaTable::NUMBER;
+		case LUA_TSTRING:  return LuaTable::STRING;
+		case LUA_TTABLE:   return LuaTable::TABLE;
+		default:           return LuaTable::NIL;
+	}
+}
+
+
 LuaTable::DataType LuaTable::GetType(int key) const
 {
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = GetSnapshotValue(key);
+		return ((value != nullptr)? ToDataType(value->type): NIL);
+	}
+
 	if (!PushValue(key))
 		return NIL;
 
 	const int type = lua_type(L, -1);
 	lua_pop(L, 1);
 
-	switch (type) {
-		case LUA_TBOOLEAN: return BOOLEAN;
-		case LUA_TNUMBER:  return NUMBER;
-		case LUA_TSTRING:  return STRING;
-		case LUA_TTABLE:   return TABLE;
-		default:           return NIL;
-	}
+	return (ToDataType(type));
 }
 
 
 LuaTable::DataType LuaTable::GetType(const std::string& key) const
 {
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = GetSnapshotValue(key);
+		return ((value != nullptr)? ToDataType(value->type): NIL);
+	}
+
 	if (!PushValue(key))
 		return NIL;
 
 	const int type = lua_type(L, -1);
 	lua_pop(L, 1);
 
-	switch (type) {
-		case LUA_TBOOLEAN: return BOOLEAN;
-		case LUA_TNUMBER:  return NUMBER;
-		case LUA_TSTRING:  return STRING;
-		case LUA_TTABLE:   return TABLE;
-		default:           return NIL;
-	}
+	return (ToDataType(type));
 }
 
 
@@ -1101,6 +1337,9 @@ LuaTable::DataType LuaTable::GetType(const std::string& key) const
 
 int LuaTable::GetLength() const
 {
+	if (snapshotNode != nullptr)
+		return snapshotNode->length;
+
 	if (!PushTable())
 		return 0;
 
@@ -1110,6 +1349,11 @@ int LuaTable::GetLength() const
 
 int LuaTable::GetLength(int key) const
 {
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = GetSnapshotValue(key);
+		return ((value != nullptr)? value->length: 0);
+	}
+
 	if (!PushValue(key))
 		return 0;
 
@@ -1121,6 +1365,11 @@ int LuaTable::GetLength(int key) const
 
 int LuaTable::GetLength(const std::string& key) const
 {
+	if (snapshotNode != nullptr) {
+		const LuaTableSnapshotValue* value = GetSnapshotValue(key);
+		return ((value != nullptr)? value->length: 0);
+	}
+
 	if (!PushValue(key))
 		return 0;
 
@@ -1138,6 +1387,15 @@ int LuaTable::GetLength(const std::string& key) const
 
 bool LuaTable::GetKeys(std::vector<int>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->intEntries) {
+			data.push_back(entry.first);
+		}
+
+		std::stable_sort(data.begin(), data.end());
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1155,6 +1413,15 @@ bool LuaTable::GetKeys(std::vector<int>& data) const
 
 bool LuaTable::GetKeys(std::vector<std::string>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->strEntries) {
+			data.push_back(entry.first);
+		}
+
+		std::stable_sort(data.begin(), data.end());
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1173,6 +1440,19 @@ bool LuaTable::GetKeys(std::vector<std::string>& data) const
 
 bool LuaTable::GetPairs(std::vector<std::pair<int, std::string>>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->intEntries) {
+			if (entry.second.isString)
+				data.emplace_back(entry.first, entry.second.string);
+		}
+
+		using T = std::remove_reference<decltype(data)>::type;
+		using P = T::value_type;
+
+		std::stable_sort(data.begin(), data.end(), [](const P& a, const P& b) { return (a.first < b.first); });
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1201,6 +1481,19 @@ bool LuaTable::GetPairs(std::vector<std::pair<int, std::string>>& data) const
 
 bool LuaTable::GetPairs(std::vector<std::pair<std::string, float>>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->strEntries) {
+			if (entry.second.isNumber)
+				data.emplace_back(entry.first, entry.second.number);
+		}
+
+		using T = std::remove_reference<decltype(data)>::type;
+		using P = T::value_type;
+
+		std::stable_sort(data.begin(), data.end(), [](const P& a, const P& b) { return (a.first < b.first); });
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1222,6 +1515,25 @@ bool LuaTable::GetPairs(std::vector<std::pair<std::string, float>>& data) const
 
 bool LuaTable::GetPairs(std::vector<std::pair<std::string, std::string>>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->strEntries) {
+			if (entry.second.isString) { // includes numbers
+				data.emplace_back(entry.first, entry.second.string);
+				continue;
+			}
+			if (entry.second.type == LUA_TBOOLEAN) {
+				data.emplace_back(entry.first, entry.second.boolean ? "1" : "0");
+				continue;
+			}
+		}
+
+		using T = std::remove_reference<decltype(data)>::type;
+		using P = T::value_type;
+
+		std::stable_sort(data.begin(), data.end(), [](const P& a, const P& b) { return (a.first < b.first); });
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1257,6 +1569,15 @@ bool LuaTable::GetPairs(std::vector<std::pair<std::string, std::string>>& data)
 
 bool LuaTable::GetMap(spring::unordered_map<int, float>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->intEntries) {
+			if (entry.second.isNumber)
+				data[entry.first] = entry.second.number;
+		}
+
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1274,6 +1595,15 @@ bool LuaTable::GetMap(spring::unordered_map<int, float>& data) const
 
 bool LuaTable::GetMap(spring::unordered_map<int, std::string>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->intEntries) {
+			if (entry.second.isString)
+				data[entry.first] = entry.second.string;
+		}
+
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1298,6 +1628,15 @@ bool LuaTable::GetMap(spring::unordered_map<int, std::string>& data) const
 
 bool LuaTable::GetMap(spring::unordered_map<std::string, float>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->strEntries) {
+			if (entry.second.isNumber)
+				data[entry.first] = entry.second.number;
+		}
+
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1315,6 +1654,21 @@ bool LuaTable::GetMap(spring::unordered_map<std::string, float>& data) const
 
 bool LuaTable::GetMap(spring::unordered_map<std::string, std::string>& data) const
 {
+	if (snapshotNode != nullptr) {
+		for (const auto& entry: snapshotNode->strEntries) {
+			if (entry.second.isString) { // includes numbers
+				data[entry.first] = entry.second.string;
+				continue;
+			}
+			if (entry.second.type == LUA_TBOOLEAN) {
+				data[entry.first] = entry.second.boolean ? "1" : "0";
+				continue;
+			}
+		}
+
+		return true;
+	}
+
 	if (!PushTable())
 		return false;
 
@@ -1423,6 +1777,103 @@ static bool ParseBoolean(lua_State* L, int index, bool& value)
 }
 
 
+// snapshot counterparts of the above, each follows its Lua version exactly
+static bool ParseSnapshotFloat(const LuaTableSnapshotValue* value, float& ret)
+{
+	if (value == nullptr)
+		return false;
+
+	ret = value->number;
+	return (ret != 0.0f || value->isNumber || value->isString);
+}
+
+static bool ParseSnapshotInt(const LuaTableSnapshotValue* value, int& ret)
+{
+	if (value == nullptr)
+		return false;
+
+	ret = value->intValue;
+	return (ret != 0 || value->isNumber || value->isString);
+}
+
+static bool ParseSnapshotFloat3(const LuaTableSnapshotValue* value, float3& ret)
+{
+	if (value == nullptr)
+		return false;
+
+	if (value->table != nullptr) {
+		const LuaTableSnapshotNode* node = value->table;
+
+		return
+			ParseSnapshotFloat(node->Find(1), ret.x) &&
+			ParseSnapshotFloat(node->Find(2), ret.y) &&
+			ParseSnapshotFloat(node->Find(3), ret.z);
+	}
+
+	if (value->isString)
+		return (sscanf(value->string.c_str(), "%f %f %f", &ret.x, &ret.y, &ret.z) == 3);
+
+	return false;
+}
+
+static bool ParseSnapshotFloat4(const LuaTableSnapshotValue* value, float4& ret)
+{
+	if (value == nullptr)
+		return false;
+
+	if (value->table != nullptr) {
+		const LuaTableSnapshotNode* node = value->table;
+
+		return
+			ParseSnapshotFloat(node->Find(1), ret.x) &&
+			ParseSnapshotFloat(node->Find(2), ret.y) &&
+			ParseSnapshotFloat(node->Find(3), ret.z) &&
+			ParseSnapshotFloat(node->Find(4), ret.w);
+	}
+
+	if (value->isString)
+		return (sscanf(value->string.c_str(), "%f %f %f %f", &ret.x, &ret.y, &ret.z, &ret.w) == 4);
+
+	return false;
+}
+
+static bool ParseSnapshotBoolean(const LuaTableSnapshotValue* value, bool& ret)
+{
+	if (value == nullptr)
+		return false;
+
+	if (value->type == LUA_TBOOLEAN) {
+		ret = value->boolean;
+		return true;
+	}
+	if (value->isNumber) {
+		ret = (value->number != 0.0f);
+		return true;
+	}
+	if (value->isString) {
+		const std::string str = StringToLower(value->string);
+		if ((str == "1") || (str == "true")) {
+			ret = true;
+			return true;
+		}
+		if ((str == "0") || (str == "false")) {
+			ret = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ParseSnapshotString(const LuaTableSnapshotValue* value, std::string& ret)
+{
+	if (value == nullptr || !value->isString)
+		return false;
+
+	ret = value->string;
+	return true;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 //
@@ -1431,6 +1882,11 @@ static bool ParseBoolean(lua_State* L, int index, bool& value)
 
 int LuaTable::Get(const std::string& key, int def) const
 {
+	if (snapshotNode != nullptr) {
+		int value;
+		return (ParseSnapshotInt(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1446,6 +1902,11 @@ int LuaTable::Get(const std::string& key, int def) const
 
 bool LuaTable::Get(const std::string& key, bool def) const
 {
+	if (snapshotNode != nullptr) {
+		bool value;
+		return (ParseSnapshotBoolean(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1461,6 +1922,11 @@ bool LuaTable::Get(const std::string& key, bool def) const
 
 float LuaTable::Get(const std::string& key, float def) const
 {
+	if (snapshotNode != nullptr) {
+		float value;
+		return (ParseSnapshotFloat(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1477,6 +1943,11 @@ float LuaTable::Get(const std::string& key, float def) const
 
 float3 LuaTable::Get(const std::string& key, const float3& def) const
 {
+	if (snapshotNode != nullptr) {
+		float3 value;
+		return (ParseSnapshotFloat3(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1491,6 +1962,11 @@ float3 LuaTable::Get(const std::string& key, const float3& def) const
 
 float4 LuaTable::Get(const std::string& key, const float4& def) const
 {
+	if (snapshotNode != nullptr) {
+		float4 value;
+		return (ParseSnapshotFloat4(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1507,6 +1983,11 @@ float4 LuaTable::Get(const std::string& key, const float4& def) const
 
 std::string LuaTable::Get(const std::string& key, const std::string& def) const
 {
+	if (snapshotNode != nullptr) {
+		std::string value;
+		return (ParseSnapshotString(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1528,6 +2009,11 @@ std::string LuaTable::Get(const std::string& key, const std::string& def) const
 
 int LuaTable::Get(int key, int def) const
 {
+	if (snapshotNode != nullptr) {
+		int value;
+		return (ParseSnapshotInt(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1543,6 +2029,11 @@ int LuaTable::Get(int key, int def) const
 
 bool LuaTable::Get(int key, bool def) const
 {
+	if (snapshotNode != nullptr) {
+		bool value;
+		return (ParseSnapshotBoolean(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1558,6 +2049,11 @@ bool LuaTable::Get(int key, bool def) const
 
 float LuaTable::Get(int key, float def) const
 {
+	if (snapshotNode != nullptr) {
+		float value;
+		return (ParseSnapshotFloat(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1574,6 +2070,11 @@ float LuaTable::Get(int key, float def) const
 
 float3 LuaTable::Get(int key, const float3& def) const
 {
+	if (snapshotNode != nullptr) {
+		float3 value;
+		return (ParseSnapshotFloat3(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
@@ -1588,6 +2089,11 @@ float3 LuaTable::Get(int key, const float3& def) const
 
 float4 LuaTable::Get(int key, const float4& def) const
 {
+	if (snapshotNode != nullptr) {
+		float4 value;
+		return (ParseSnapshotFloat4(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key)) {
 		return def;
 	}
@@ -1604,6 +2110,11 @@ float4 LuaTable::Get(int key, const float4& def) const
 
 std::string LuaTable::Get(int key, const std::string& def) const
 {
+	if (snapshotNode != nullptr) {
+		std::string value;
+		return (ParseSnapshotString(GetSnapshotValue(key), value)? value: def);
+	}
+
 	if (!PushValue(key))
 		return def;
 
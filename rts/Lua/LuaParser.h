@@ -3,6 +3,7 @@
 #ifndef LUA_PARSER_H
 #define LUA_PARSER_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,9 @@ class float3;
 struct float4;
 class LuaTable;
 class LuaParser;
+struct LuaTableSnapshot;
+struct LuaTableSnapshotNode;
+struct LuaTableSnapshotValue;
 struct lua_State;
 
 
@@ -33,7 +37,16 @@ public:
 	LuaTable SubTable(const std::string& key) const;
 	LuaTable SubTableExpr(const std::string& expr) const;
 
-	bool IsValid() const { return (parser != nullptr); }
+	/**
+	 * Copies this table and every table reachable from it out of the Lua
+	 * state. The copy answers all queries exactly like the original, does
+	 * not depend on the parser any longer and can be read from several
+	 * threads at once (e.g. to build defs in parallel).
+	 */
+	LuaTable Snapshot() const;
+
+	bool IsValid() const { return (parser != nullptr || snapshotNode != nullptr); }
+	bool IsSnapshot() const { return (snapshotNode != nullptr); }
 
 	const std::string& GetPath() const { return path; }
 
@@ -106,12 +119,19 @@ private:
 	bool PushValue(int key) const;
 	bool PushValue(const std::string& key) const;
 
+	const LuaTableSnapshotValue* GetSnapshotValue(int key) const;
+	const LuaTableSnapshotValue* GetSnapshotValue(const std::string& key) const;
+
 private:
 	std::string path;
 	mutable bool isValid;
 	LuaParser* parser;
 	lua_State* L;
 	int refnum;
+
+	// only set for snapshots, which never touch the Lua state
+	std::shared_ptr<const LuaTableSnapshot> snapshot;
+	const LuaTableSnapshotNode* snapshotNode = nullptr;
 };
 
 
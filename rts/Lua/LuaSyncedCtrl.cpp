@@ -4006,7 +4006,7 @@ int LuaSyncedCtrl::LevelSmoothMesh(lua_State* L)
 
 	for (int z = z1; z <= z2; z++) {
 		for (int x = x1; x <= x2; x++) {
-			const int index = (z * smoothGround.GetMaxX()) + x;
+			const int index = (z * smoothGround.GetLineSize()) + x;
 			smoothGround.SetHeight(index, height);
 		}
 	}
@@ -4021,7 +4021,7 @@ int LuaSyncedCtrl::AdjustSmoothMesh(lua_State* L)
 
 	for (int z = z1; z <= z2; z++) {
 		for (int x = x1; x <= x2; x++) {
-			const int index = (z * smoothGround.GetMaxX()) + x;
+			const int index = (z * smoothGround.GetLineSize()) + x;
 			smoothGround.AddHeight(index, height);
 		}
 	}
@@ -4041,8 +4041,8 @@ int LuaSyncedCtrl::RevertSmoothMesh(lua_State* L)
 	if (origFactor == 1.0f) {
 		for (int z = z1; z <= z2; z++) {
 			for (int x = x1; x <= x2; x++) {
-				const int idx = (z * smoothGround.GetMaxX()) + x;
-				smoothGround.SetHeight(idx, origMap[idx]);
+				const int idx = (z * smoothGround.GetLineSize()) + x;
+				smoothGround.RevertHeight(idx);
 			}
 		}
 	}
@@ -4050,7 +4050,7 @@ int LuaSyncedCtrl::RevertSmoothMesh(lua_State* L)
 		const float currFactor = (1.0f - origFactor);
 		for (int z = z1; z <= z2; z++) {
 			for (int x = x1; x <= x2; x++) {
-				const int index = (z * smoothGround.GetMaxX()) + x;
+				const int index = (z * smoothGround.GetLineSize()) + x;
 				const float ofh = origFactor * origMap[index];
 				const float cfh = currFactor * currMap[index];
 				smoothGround.SetHeight(index, ofh + cfh);
@@ -4082,7 +4082,7 @@ int LuaSyncedCtrl::AddSmoothMesh(lua_State* L)
 		return 0;
 	}
 
-	const int index = (z * smoothGround.GetMaxX()) + x;
+	const int index = (z * smoothGround.GetLineSize()) + x;
 	const float oldHeight = smoothGround.GetMeshData()[index];
 	smoothMeshAmountChanged += math::fabsf(h);
 
@@ -4112,7 +4112,7 @@ int LuaSyncedCtrl::SetSmoothMesh(lua_State* L)
 		return 0;
 	}
 
-	const int index = (z * (smoothGround.GetMaxX())) + x;
+	const int index = (z * smoothGround.GetLineSize()) + x;
 	const float oldHeight = smoothGround.GetMeshData()[index];
 	float height = oldHeight;
 
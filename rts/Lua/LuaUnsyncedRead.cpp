@@ -93,6 +93,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetProfilerRecordNames);
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
+	REGISTER_LUA_CFUNC(GetLuaMemPoolStats);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
@@ -440,6 +441,40 @@ int LuaUnsyncedRead::GetLuaMemUsage(lua_State* L)
 	return 8;
 }
 
+int LuaUnsyncedRead::GetLuaMemPoolStats(lua_State* L)
+{
+	const luaContextData* lcd = GetLuaContextData(L);
+
+	std::array<LuaMemPool::SizeClassStats, 32> stats;
+
+	const size_t numStats = lcd->memPool->GetSizeClassStats(stats.data(), stats.size());
+	size_t numEntries = 0;
+
+	lua_createtable(L, numStats, 0);
+
+	// only report the classes that have seen any use; sizes in bytes
+	for (size_t i = 0; i < numStats; i++) {
+		const LuaMemPool::SizeClassStats& s = stats[i];
+
+		if (s.peakAllocs == 0 && s.poolBytes == 0)
+			continue;
+
+		lua_createtable(L, 0, 8);
+		LuaPushNamedNumber(L, "pageSize"  , s.pageSize  );
+		LuaPushNamedNumber(L, "numAllocs" , s.numAllocs );
+		LuaPushNamedNumber(L, "allocBytes", s.allocSums );
+		LuaPushNamedNumber(L, "peakAllocs", s.peakAllocs);
+		LuaPushNamedNumber(L, "peakBytes" , s.peakSums  );
+		LuaPushNamedNumber(L, "poolBytes" , s.poolBytes );
+		LuaPushNamedNumber(L, "freeBytes" , s.freeBytes );
+		LuaPushNamedNumber(L, "cacheHits" , s.cacheHits );
+		lua_rawseti(L, -2, ++numEntries);
+	}
+
+	lua_pushboolean(L, LuaMemPool::enabled);
+	return 2;
+}
+
 int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 {
 	int2 vidMemInfo;
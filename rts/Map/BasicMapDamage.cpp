@@ -8,6 +8,7 @@
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Path/IPathManager.h"
@@ -52,6 +53,8 @@ void CBasicMapDamage::Init()
 	explosionUpdateQueue.clear();
 	explosionUpdateQueue.reserve(64);
 
+	damagedAreas.clear();
+
 	std::fill(explosionSquaresPool.begin(), explosionSquaresPool.end(), 0.0f);
 }
 
@@ -216,6 +219,7 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 {
 	readMap->UpdateHeightMapSynced(SRectangle(x1, y1, x2, y2));
 	featureHandler.TerrainChanged(x1, y1, x2, y2);
+	smoothGround.MapChanged(x1, y1, x2, y2);
 	{
 		SCOPED_TIMER("Sim::BasicMapDamage::Los");
 		losHandler->UpdateHeightMapSynced(SRectangle(x1, y1, x2, y2));
@@ -226,6 +230,42 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 	}
 }
 
+void CBasicMapDamage::RecalcDamagedAreas()
+{
+	if (damagedAreas.empty())
+		return;
+
+	// merge the areas of all explosions that finished this frame
+	// so overlapping craters are only recalculated once
+	damagedAreas.Process();
+
+	for (const SRectangle& rect: damagedAreas) {
+		readMap->UpdateHeightMapSynced(rect);
+	}
+	for (const SRectangle& rect: damagedAreas) {
+		featureHandler.TerrainChanged(rect.x1, rect.z1, rect.x2, rect.z2);
+	}
+	for (const SRectangle& rect: damagedAreas) {
+		smoothGround.MapChanged(rect.x1, rect.z1, rect.x2, rect.z2);
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Los");
+
+		for (const SRectangle& rect: damagedAreas) {
+			losHandler->UpdateHeightMapSynced(rect);
+		}
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Path");
+
+		for (const SRectangle& rect: damagedAreas) {
+			pathManager->TerrainChange(rect.x1, rect.z1, rect.x2, rect.z2, TERRAINCHANGE_DAMAGE_RECALCULATION);
+		}
+	}
+
+	damagedAreas.clear();
+}
+
 
 void CBasicMapDamage::Update()
 {
@@ -266,9 +306,11 @@ void CBasicMapDamage::Update()
 		if (e.ttl != 0)
 			continue;
 
-		RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		damagedAreas.push_back(SRectangle(e.x1 - 1, e.y1 - 1, e.x2 + 1, e.y2 + 1));
 	}
 
+	RecalcDamagedAreas();
+
 
 	// pop explosions that are no longer being processed
 	while (explUpdateQueueIdx < explosionUpdateQueue.size()) {
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Misc/RectangleOverlapHandler.h"
 
 #include <vector>
 
@@ -21,6 +22,8 @@ public:
 	bool Disabled() const override { return false; }
 
 private:
+	void RecalcDamagedAreas();
+
 	void SetExplosionSquare(float v) {
 		explosionSquaresPool[explSquaresPoolIdx] = v;
 
@@ -61,6 +64,9 @@ private:
 	std::vector<float> explosionSquaresPool;
 	std::vector<Explo> explosionUpdateQueue;
 
+	// heightmap areas of all explosions finished in the current frame
+	CRectangleOverlapHandler damagedAreas;
+
 	static constexpr unsigned int CRATER_TABLE_SIZE = 200;
 	static constexpr unsigned int EXPLOSION_LIFETIME = 10;
 
@@ -6,9 +6,14 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/SpringMath.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
 
+#include <array>
 #include <cassert>
 #include <limits>
+#include <random>
+#include <vector>
 
 #undef far // avoid collision with windef.h
 #undef near
@@ -146,6 +151,127 @@ static inline float LineGroundSquareCol(
 
 
 
+/*
+ * Decides (conservatively) which heightmap squares a line can not hit,
+ * using the synced max-heightmaps: if the infinite line through <from>
+ * and <to> passes above the highest corner of a block of squares, none
+ * of the block's triangles can intersect it and LineGroundSquareCol for
+ * each square in the block would return a miss. Blocks are tested from
+ * the coarsest level down, and the last block found empty as well as the
+ * last non-empty block per level are remembered, so that walking through
+ * a block costs only a few integer compares per square.
+ */
+class CGroundRaySkipper {
+public:
+	CGroundRaySkipper(const float3& from, const float3& to, bool enabled) {
+		rayPos = from;
+		rayDir = to - from;
+
+		// vertical rays only ever touch one square
+		useSkipping = enabled && (rayDir.x != 0.0f || rayDir.z != 0.0f);
+
+		invDirX = (rayDir.x != 0.0f)? (1.0f / rayDir.x): 0.0f;
+		invDirZ = (rayDir.z != 0.0f)? (1.0f / rayDir.z): 0.0f;
+
+		emptyBlock = {-1, -1};
+		nonEmptyBlocks.fill({-1, -1});
+	}
+
+	bool SkipSquare(int x, int z) {
+		if (!useSkipping)
+			return false;
+		// leave out-of-map squares to LineGroundSquareCol
+		if (x < 0 || z < 0 || x > mapDims.mapxm1 || z > mapDims.mapym1)
+			return false;
+
+		if (emptyMip >= 0 && emptyBlock == int2(x >> emptyMip, z >> emptyMip))
+			return true;
+
+		for (int mip = CReadMap::numHeightMipMaps - 1; mip >= 0; mip--) {
+			const int2 block = {x >> mip, z >> mip};
+
+			if (block == nonEmptyBlocks[mip])
+				continue;
+
+			if (IsBlockBelowRay(block, mip)) {
+				emptyMip = mip;
+				emptyBlock = block;
+				return true;
+			}
+
+			nonEmptyBlocks[mip] = block;
+		}
+
+		return false;
+	}
+
+private:
+	bool IsBlockBelowRay(const int2 block, int mip) const {
+		// margins absorb the rounding in LineGroundSquareCol's intersection
+		// point, which may land marginally outside of the square or above
+		// its corners; for rays nearly parallel to a face the point is only
+		// imprecise along the ray, where the ray stays within a fraction of
+		// an elmo of the face (checked by /GroundRayBenchmark)
+		constexpr float xzMargin = 1.0f;
+		constexpr float yMargin = 1.0f;
+
+		const float blockSize = SQUARE_SIZE << mip;
+
+		const float minX = block.x * blockSize - xzMargin;
+		const float minZ = block.y * blockSize - xzMargin;
+		const float maxX = minX + blockSize + xzMargin * 2.0f;
+		const float maxZ = minZ + blockSize + xzMargin * 2.0f;
+
+		// parametric interval over which the line is inside the block's xz-bounds
+		float tmin = -std::numeric_limits<float>::max();
+		float tmax =  std::numeric_limits<float>::max();
+
+		if (rayDir.x != 0.0f) {
+			const float t0 = (minX - rayPos.x) * invDirX;
+			const float t1 = (maxX - rayPos.x) * invDirX;
+
+			tmin = std::max(tmin, std::min(t0, t1));
+			tmax = std::min(tmax, std::max(t0, t1));
+		} else if (rayPos.x < minX || rayPos.x > maxX) {
+			return true;
+		}
+
+		if (rayDir.z != 0.0f) {
+			const float t0 = (minZ - rayPos.z) * invDirZ;
+			const float t1 = (maxZ - rayPos.z) * invDirZ;
+
+			tmin = std::max(tmin, std::min(t0, t1));
+			tmax = std::min(tmax, std::max(t0, t1));
+		} else if (rayPos.z < minZ || rayPos.z > maxZ) {
+			return true;
+		}
+
+		if (tmin > tmax)
+			return true;
+
+		// the line is straight, so its lowest point inside the block is at either end
+		const float minY = std::min(rayPos.y + rayDir.y * tmin, rayPos.y + rayDir.y * tmax);
+		const float maxH = readMap->GetMaxHeightMapSynced(mip)[block.x + block.y * CReadMap::GetMaxHeightMapSize(mapDims.mapx, mip)];
+
+		return (minY > (maxH + yMargin));
+	}
+
+private:
+	float3 rayPos;
+	float3 rayDir;
+
+	float invDirX = 0.0f;
+	float invDirZ = 0.0f;
+
+	int emptyMip = -1;
+	int2 emptyBlock;
+
+	std::array<int2, CReadMap::numHeightMipMaps> nonEmptyBlocks;
+
+	bool useSkipping = false;
+};
+
+
 /*
 void CGround::CheckColSquare(CProjectile* p, int x, int y)
 {
@@ -208,7 +334,7 @@ inline static bool ClampInMapHeight(float3& from, float3& to)
 }
 
 
-float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+static float LineGroundColImpl(float3 from, float3 to, bool synced, bool skipEmptyBlocks)
 {
 	const float* hm  = readMap->GetSharedCornerHeightMap(synced);
 	const float3* nm = readMap->GetSharedFaceNormals(synced);
@@ -261,6 +387,9 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 	bool stopTrace = false;
 
+	// the max-heightmaps only track the synced heightmap
+	CGroundRaySkipper raySkipper(from, to, skipEmptyBlocks && synced);
+
 	if ((fsx == tsx) && (fsz == tsz)) {
 		// <from> and <to> are the same
 		const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, fsz);
@@ -276,7 +405,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int zp = fsz;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapyp1); (Square(i) <= n && zp != tsz); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
+			const float ret = raySkipper.SkipSquare(fsx, zp)? -2.0f: LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -292,7 +421,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int xp = fsx;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1); (Square(i) <= n && xp != tsx); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
+			const float ret = raySkipper.SkipSquare(xp, fsz)? -2.0f: LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -330,7 +459,8 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1) + Square(mapDims.mapyp1); !stopTrace; i++) {
 			// test for collision with the ground-square triangles
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
+			// squares in empty blocks are still visited, which keeps the traversal itself unchanged
+			const float ret = raySkipper.SkipSquare(curx, curz)? -2.0f: LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -377,12 +507,114 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 	return -1.0f;
 }
 
+float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+{
+	return (LineGroundColImpl(from, to, synced, true));
+}
+
 float CGround::LineGroundCol(const float3 pos, const float3 dir, float len, bool synced)
 {
 	return (LineGroundCol(pos, pos + dir * std::max(len, 0.0f), synced));
 }
 
 
+void CGround::BenchmarkLineGroundCol(unsigned int numRays)
+{
+	// unsynced generator, this never runs as part of the simulation
+	std::mt19937 rng(numRays);
+
+	std::uniform_real_distribution<float> xDist(0.0f, mapDims.mapx * SQUARE_SIZE);
+	std::uniform_real_distribution<float> zDist(0.0f, mapDims.mapy * SQUARE_SIZE);
+	std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+
+	std::vector< std::pair<float3, float3> > rays;
+	std::vector<float> results[2];
+
+	rays.reserve(numRays);
+	results[0].reserve(numRays);
+	results[1].reserve(numRays);
+
+	// offsets of grazing rays from the terrain, spread over several orders of magnitude
+	const auto GrazeOffset = [&]() { return ((unitDist(rng) - 0.25f) * math::pow(10.0f, unitDist(rng) * 5.0f - 4.0f)); };
+
+	for (unsigned int i = 0; i < numRays; i++) {
+		float3 from = {xDist(rng), 0.0f, zDist(rng)};
+		float3 to;
+
+		switch (i & 3) {
+			case 0: {
+				// line-of-fire style; short, just above the terrain at both ends
+				to = from + float3(unitDist(rng) - 0.5f, 0.0f, unitDist(rng) - 0.5f) * 2000.0f;
+				to.ClampInBounds();
+
+				from.y = GetHeightReal(from.x, from.z) + 5.0f + unitDist(rng) * 50.0f;
+				to.y = GetHeightReal(to.x, to.z) + 5.0f + unitDist(rng) * 50.0f;
+			} break;
+			case 1: {
+				// from high above into the ground, camera or ballistic style
+				to = {xDist(rng), 0.0f, zDist(rng)};
+
+				from.y = readMap->GetCurrMaxHeight() + unitDist(rng) * 1000.0f;
+				to.y = GetHeightReal(to.x, to.z) - 10.0f;
+			} break;
+			case 2: {
+				// (nearly) horizontal, grazing the top of a block the ray skipper tests
+				const int mip = std::uniform_int_distribution<int>(0, CReadMap::numHeightMipMaps - 1)(rng);
+				const int bx = Clamp(int(from.x / SQUARE_SIZE), 0, mapDims.mapxm1) >> mip;
+				const int bz = Clamp(int(from.z / SQUARE_SIZE), 0, mapDims.mapym1) >> mip;
+
+				to = from + float3(unitDist(rng) - 0.5f, 0.0f, unitDist(rng) - 0.5f) * 4000.0f;
+				to.ClampInBounds();
+
+				from.y = readMap->GetMaxHeightMapSynced(mip)[bx + bz * CReadMap::GetMaxHeightMapSize(mapDims.mapx, mip)] + GrazeOffset();
+				to.y = from.y + (unitDist(rng) - 0.5f) * 0.001f;
+			} break;
+			case 3: {
+				// (nearly) parallel to a terrain face, where the plane-distances
+				// in LineGroundSquareCol cancel out
+				const int sx = Clamp(int(from.x / SQUARE_SIZE), 0, mapDims.mapxm1);
+				const int sz = Clamp(int(from.z / SQUARE_SIZE), 0, mapDims.mapym1);
+
+				const float3& faceNormal = readMap->GetFaceNormalsSynced()[(sz * mapDims.mapx + sx) * 2];
+				const float3 dir = {unitDist(rng) - 0.5f, 0.0f, unitDist(rng) - 0.5f};
+
+				from.x = (sx + unitDist(rng) * 0.5f) * SQUARE_SIZE;
+				from.z = (sz + unitDist(rng) * 0.5f) * SQUARE_SIZE;
+				from.y = GetHeightReal(from.x, from.z) + GrazeOffset();
+
+				to = from + float3(dir.x, -(faceNormal.x * dir.x + faceNormal.z * dir.z) / faceNormal.y, dir.z) * 200.0f;
+				to.y += (unitDist(rng) - 0.5f) * 0.001f;
+			} break;
+		}
+
+		rays.emplace_back(from, to);
+	}
+
+	spring_time times[2];
+
+	for (int skip = 0; skip < 2; skip++) {
+		const spring_time t0 = spring_gettime();
+
+		for (const auto& ray: rays) {
+			results[skip].push_back(LineGroundColImpl(ray.first, ray.second, true, skip != 0));
+		}
+
+		times[skip] = spring_gettime() - t0;
+	}
+
+	unsigned int numHits = 0;
+	unsigned int numMismatches = 0;
+
+	for (unsigned int i = 0; i < numRays; i++) {
+		numHits += (results[0][i] >= 0.0f);
+		numMismatches += (results[0][i] != results[1][i]);
+	}
+
+	LOG("[Ground::%s] %u rays (%u hits): %.3fms per-square, %.3fms with block-skipping, %u mismatches",
+		__func__, numRays, numHits, times[0].toMilliSecsf(), times[1].toMilliSecsf(), numMismatches);
+}
+
+
 float CGround::LinePlaneCol(const float3 pos, const float3 dir, float len, float hgt)
 {
 	const float3 end = pos + dir * std::max(len, 0.0f);
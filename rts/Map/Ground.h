@@ -40,6 +40,9 @@ public:
 	static float LinePlaneCol(const float3 pos, const float3 dir, float len, float hgt);
 	static float LineGroundWaterCol(const float3 pos, const float3 dir, float len, bool testWater, bool synced = true);
 
+	/// times LineGroundCol on random (also grazing and face-parallel) rays with and without empty-block skipping, and counts differing results
+	static void BenchmarkLineGroundCol(unsigned int numRays);
+
 	static float TrajectoryGroundCol(const float3& trajStartPos, const float3& trajTargetDir, float length, float linCoeff, float qdrCoeff);
 	static float SimTrajectoryGroundColDist(const float3& startPos, const float3& trajStartDir, const float3& acc, const float2& args);
 
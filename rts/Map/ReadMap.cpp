@@ -31,6 +31,33 @@
 
 #define MAX_UHM_RECTS_PER_FRAME static_cast<size_t>(128)
 
+// heightmap derivatives are updated in parallel bands of this many rows
+static constexpr int HEIGHTMAP_ROW_TILE_SIZE = 16;
+
+// calls f(z) for every row in [z1, z2], one tile of rows per task
+template<typename F>
+static void for_mt_rows(int z1, int z2, F&& f)
+{
+	const int numTiles = (z2 - z1 + HEIGHTMAP_ROW_TILE_SIZE) / HEIGHTMAP_ROW_TILE_SIZE;
+
+	// not worth waking up the pool
+	if (numTiles <= 1) {
+		for (int z = z1; z <= z2; z++) {
+			f(z);
+		}
+		return;
+	}
+
+	for_mt(0, numTiles, [&](const int tile) {
+		const int tz1 = z1 + tile * HEIGHTMAP_ROW_TILE_SIZE;
+		const int tz2 = std::min(z2, tz1 + HEIGHTMAP_ROW_TILE_SIZE - 1);
+
+		for (int z = tz1; z <= tz2; z++) {
+			f(z);
+		}
+	});
+}
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -69,6 +96,7 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(originalHeightMap),
 	CR_IGNORED(centerHeightMap),
 	CR_IGNORED(mipCenterHeightMaps),
+	CR_IGNORED(maxHeightMaps),
 	*/
 	CR_IGNORED(mipPointerHeightMaps),
 	/*
@@ -112,6 +140,7 @@ MapDimensions mapDims;
 std::vector<float> CReadMap::originalHeightMap;
 std::vector<float> CReadMap::centerHeightMap;
 std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipCenterHeightMaps;
+std::array<std::vector<float>, CReadMap::numHeightMipMaps> CReadMap::maxHeightMaps;
 
 std::vector<float3> CReadMap::visVertexNormals;
 std::vector<float3> CReadMap::faceNormalsSynced;
@@ -297,6 +326,10 @@ void CReadMap::Initialize()
 		for (int i = 1; i < numHeightMipMaps; i++) {
 			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * sizeof(float)) / 1024);
 		}
+		// maxHeightMaps[i]
+		for (int i = 0; i < numHeightMipMaps; i++) {
+			reqMemFootPrintKB += (((GetMaxHeightMapSize(mapDims.mapx, i) * GetMaxHeightMapSize(mapDims.mapy, i)) * sizeof(float)) / 1024);
+		}
 
 		sprintf(loadMsg, fmtString, reqMemFootPrintKB / 1024);
 		loadscreen->SetLoadMessage(loadMsg);
@@ -327,6 +360,11 @@ void CReadMap::Initialize()
 		mipPointerHeightMaps[i] = &mipCenterHeightMaps[i - 1][0];
 	}
 
+	for (int i = 0; i < numHeightMipMaps; i++) {
+		maxHeightMaps[i].clear();
+		maxHeightMaps[i].resize(GetMaxHeightMapSize(mapDims.mapx, i) * GetMaxHeightMapSize(mapDims.mapy, i));
+	}
+
 	slopeMap.clear();
 	slopeMap.resize(mapDims.hmapx * mapDims.hmapy);
 
@@ -503,6 +541,7 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect, bool initiali
 
 	UpdateCenterHeightmap(centerRect, initialize);
 	UpdateMipHeightmaps(centerRect, initialize);
+	UpdateMaxHeightmaps(centerRect, initialize);
 	UpdateFaceNormals(centerRect, initialize);
 	UpdateSlopemap(centerRect, initialize); // must happen after UpdateFaceNormals()!
 
@@ -540,7 +579,7 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 {
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
-	for (int y = rect.z1; y <= rect.z2; y++) {
+	for_mt_rows(rect.z1, rect.z2, [&](const int y) {
 		for (int x = rect.x1; x <= rect.x2; x++) {
 			const int idxTL = (y    ) * mapDims.mapxp1 + x;
 			const int idxTR = (y    ) * mapDims.mapxp1 + x + 1;
@@ -554,7 +593,7 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 				heightmapSynced[idxBR];
 			centerHeightMap[y * mapDims.mapx + x] = height * 0.25f;
 		}
-	}
+	});
 }
 
 
@@ -571,7 +610,10 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		float* topMipMap = mipPointerHeightMaps[i    ];
 		float* subMipMap = mipPointerHeightMaps[i + 1];
 
-		for (int y = sy; y < ey; y += 2) {
+		// each level depends on the previous one, only its rows are independent
+		for_mt_rows(sy / 2, (ey + 1) / 2 - 1, [&](const int sz) {
+			const int y = sz * 2;
+
 			for (int x = sx; x < ex; x += 2) {
 				const float height =
 					topMipMap[(x    ) + (y    ) * hmapx] +
@@ -580,7 +622,53 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 					topMipMap[(x + 1) + (y + 1) * hmapx];
 				subMipMap[(x / 2) + (y / 2) * hmapx / 2] = height * 0.25f;
 			}
+		});
+	}
+}
+
+
+void CReadMap::UpdateMaxHeightmaps(const SRectangle& rect, bool initialize)
+{
+	const float* heightmapSynced = GetCornerHeightMapSynced();
+
+	for_mt_rows(rect.z1, rect.z2, [&](const int y) {
+		for (int x = rect.x1; x <= rect.x2; x++) {
+			const int idxTL = (y    ) * mapDims.mapxp1 + x;
+			const int idxTR = (y    ) * mapDims.mapxp1 + x + 1;
+			const int idxBL = (y + 1) * mapDims.mapxp1 + x;
+			const int idxBR = (y + 1) * mapDims.mapxp1 + x + 1;
+
+			const float height = std::max(
+				std::max(heightmapSynced[idxTL], heightmapSynced[idxTR]),
+				std::max(heightmapSynced[idxBL], heightmapSynced[idxBR])
+			);
+			maxHeightMaps[0][y * mapDims.mapx + x] = height;
 		}
+	});
+
+	for (int i = 1; i < numHeightMipMaps; i++) {
+		const int topSizeX = GetMaxHeightMapSize(mapDims.mapx, i - 1);
+		const int topSizeY = GetMaxHeightMapSize(mapDims.mapy, i - 1);
+		const int subSizeX = GetMaxHeightMapSize(mapDims.mapx, i    );
+
+		const float* topMaxMap = &maxHeightMaps[i - 1][0];
+		      float* subMaxMap = &maxHeightMaps[i    ][0];
+
+		for_mt_rows((rect.z1 >> i), (rect.z2 >> i), [&](const int y) {
+			for (int x = (rect.x1 >> i); x <= (rect.x2 >> i); x++) {
+				// blocks at the edges of odd-sized levels only cover one row or column
+				const int tx0 = x * 2;
+				const int ty0 = y * 2;
+				const int tx1 = std::min(tx0 + 1, topSizeX - 1);
+				const int ty1 = std::min(ty0 + 1, topSizeY - 1);
+
+				const float height = std::max(
+					std::max(topMaxMap[tx0 + ty0 * topSizeX], topMaxMap[tx1 + ty0 * topSizeX]),
+					std::max(topMaxMap[tx0 + ty1 * topSizeX], topMaxMap[tx1 + ty1 * topSizeX])
+				);
+				subMaxMap[x + y * subSizeX] = height;
+			}
+		});
 	}
 }
 
@@ -594,7 +682,7 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 	const int z2 = std::min(mapDims.mapym1, rect.z2 + 1);
 	const int x2 = std::min(mapDims.mapxm1, rect.x2 + 1);
 
-	for_mt(z1, z2+1, [&](const int y) {
+	for_mt_rows(z1, z2, [&](const int y) {
 		float3 fnTL;
 		float3 fnBR;
 
@@ -662,7 +750,7 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 	const int sy = std::max(0,                 (rect.z1 / 2) - 1);
 	const int ey = std::min(mapDims.hmapy - 1, (rect.z2 / 2) + 1);
 
-	for (int y = sy; y <= ey; y++) {
+	for_mt_rows(sy, ey, [&](const int y) {
 		for (int x = sx; x <= ex; x++) {
 			const int idx0 = (y*2    ) * (mapDims.mapx) + x*2;
 			const int idx1 = (y*2 + 1) * (mapDims.mapx) + x*2;
@@ -693,7 +781,7 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 
 			slopeMap[y * mapDims.hmapx + x] = 1.0f - slope;
 		}
-	}
+	});
 }
 
 
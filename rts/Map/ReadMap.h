@@ -158,6 +158,7 @@ public:
 	const float* GetOriginalHeightMapSynced() const { return &originalHeightMap[0]; }
 	const float* GetCenterHeightMapSynced() const { return &centerHeightMap[0]; }
 	const float* GetMIPHeightMapSynced(unsigned int mip) const { return mipPointerHeightMaps[mip]; }
+	const float* GetMaxHeightMapSynced(unsigned int mip) const { return &maxHeightMaps[mip][0]; }
 	const float* GetSlopeMapSynced() const { return &slopeMap[0]; }
 	const uint8_t* GetTypeMapSynced() const { return &typeMap[0]; }
 	      uint8_t* GetTypeMapSynced()       { return &typeMap[0]; }
@@ -209,6 +210,7 @@ public:
 private:
 	void UpdateCenterHeightmap(const SRectangle& rect, bool initialize);
 	void UpdateMipHeightmaps(const SRectangle& rect, bool initialize);
+	void UpdateMaxHeightmaps(const SRectangle& rect, bool initialize);
 	void UpdateFaceNormals(const SRectangle& rect, bool initialize);
 	void UpdateSlopemap(const SRectangle& rect, bool initialize);
 
@@ -219,6 +221,9 @@ public:
 	/// number of heightmap mipmaps, including full resolution
 	static constexpr int numHeightMipMaps = 7;
 
+	/// width or height (in blocks) of a max-heightmap level, partial blocks at the map edges included
+	static int GetMaxHeightMapSize(int numSquares, unsigned int mip) { return ((numSquares + (1 << mip) - 1) >> mip); }
+
 protected:
 	// these point to the actual heightmap data
 	// which is allocated by subclass instances
@@ -239,6 +244,14 @@ protected:
 	 */
 	std::array<float*, numHeightMipMaps> mipPointerHeightMaps;
 
+	/**
+	 * maxHeightMaps[0  ] holds the highest corner of each square (mapx*mapy)
+	 * maxHeightMaps[n+1] holds the maximum of each 2x2 block of maxHeightMaps[n]
+	 * unlike the mipCenterHeightMaps these bound the terrain from above, which
+	 * lets CGround::LineGroundCol skip whole blocks of squares [SYNCED]
+	 */
+	static std::array<std::vector<float>, numHeightMipMaps> maxHeightMaps;
+
 	static std::vector<float3> visVertexNormals;      //< size:  (mapx + 1) * (mapy + 1), contains one vertex normal per corner-heightmap pixel [UNSYNCED]
 	static std::vector<float3> faceNormalsSynced;     //< size: 2*mapx      *  mapy     , contains 2 normals per quad -> triangle strip [SYNCED]
 	static std::vector<float3> faceNormalsUnsynced;   //< size: 2*mapx      *  mapy     , contains 2 normals per quad -> triangle strip [UNSYNCED]
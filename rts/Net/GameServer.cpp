@@ -67,7 +67,8 @@ using netcode::RawPacket;
 
 
 CONFIG(int, AutohostPort).defaultValue(0);
-CONFIG(int, ServerSleepTime).defaultValue(5).description("number of milliseconds to sleep per tick");
+CONFIG(int, ServerSleepTime).defaultValue(5).description("maximum number of milliseconds to wait for network data per tick; the server wakes up as soon as data arrives from the socket or the local client");
+CONFIG(int, ServerNetIOThreads).defaultValue(0).minimumValue(0).maximumValue(16).description("number of extra threads used to chunk and send outgoing data to clients, only used with 4 or more connections; measured as a net loss with up to 32 clients on a single core");
 CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2)
 	.description("Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest");
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).dedicatedValue(false).description("allow any unauthenticated clients to join as spectator with any name, name will be prefixed with ~");
@@ -168,7 +169,7 @@ void CGameServer::Initialize()
 
 	// start network
 	if (!myGameSetup->onlyLocal)
-		udpListener.reset(new netcode::UDPListener(myClientSetup->hostPort, myClientSetup->hostIP));
+		udpListener.reset(new netcode::UDPListener(myClientSetup->hostPort, myClientSetup->hostIP, configHandler->GetInt("ServerNetIOThreads")));
 
 	AddAutohostInterface(StringToLower(configHandler->GetString("AutohostIP")), configHandler->GetInt("AutohostPort"));
 	Message(spring::format(ServerStart, myClientSetup->hostPort), false);
@@ -358,7 +359,10 @@ void CGameServer::AddLocalClient(const std::string& myName, const std::string& m
 	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
 	assert(!HasLocalClient());
 
-	localClientNumber = BindConnection(std::shared_ptr<netcode::CConnection>(new netcode::CLocalConnection()), myName, "", myVersion, myPlatform, true);
+	std::shared_ptr<netcode::CLocalConnection> localConn(new netcode::CLocalConnection());
+
+	localClientLink = localConn;
+	localClientNumber = BindConnection(localConn, myName, "", myVersion, myPlatform, true);
 }
 
 void CGameServer::AddAutohostInterface(const std::string& autohostIP, const int autohostPort)
@@ -535,6 +539,9 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 		demoReader.reset();
 		Message(DemoEnd);
 
+		// local client quits (and writes its report) on receiving our NETMSG_QUIT
+		quitServer = quitServer || myClientSetup->batchReplay;
+
 		ret = false;
 	}
 
@@ -2539,6 +2546,17 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 	if (demoReader != nullptr) {
 		CheckSync();
 		SendDemoData(-1);
+
+		// batch-replay; keep the local client fed with up to GAME_SPEED frames
+		// regardless of wall-clock time, so it simulates as fast as it can
+		while (myClientSetup->batchReplay && demoReader != nullptr && !isPaused && HasLocalClient()) {
+			if ((serverFrameNum - players[localClientNumber].lastFrameResponse) >= GAME_SPEED)
+				break;
+
+			modGameTime = demoReader->GetModGameTime() + 0.001f;
+			SendDemoData(-1);
+		}
+
 		return;
 	}
 
@@ -2676,15 +2694,30 @@ void CGameServer::UpdateLoop()
 		Threading::SetThreadName("netcode");
 		Threading::SetAffinity(~0);
 
+		// only touched by this thread, renewed under gameServerMutex
+		std::shared_ptr<netcode::CLocalConnection> localLink;
+
 		while (!quitServer) {
-			spring_msecs(loopSleepTime).sleep(true);
+			// block until packets arrive, either on the socket or from the local
+			// client; the timeout remains because frame pacing and UDP resends
+			// are time-driven and handled by Update()
+			if (udpListener != nullptr) {
+				// packets already queued by the local client must not wait for the socket
+				if (localLink == nullptr || !localLink->HasIncomingData())
+					udpListener->WaitForData(loopSleepTime);
 
-			if (udpListener != nullptr)
 				udpListener->Update();
+			} else if (localLink != nullptr) {
+				localLink->WaitForData(loopSleepTime);
+			} else {
+				spring_msecs(loopSleepTime).sleep(true);
+			}
 
 			std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
 			ServerReadNet();
 			Update();
+
+			localLink = localClientLink.lock();
 		}
 
 		if (hostif != nullptr)
@@ -31,6 +31,7 @@ namespace netcode
 {
 	class RawPacket;
 	class CConnection;
+	class CLocalConnection;
 	class UDPListener;
 }
 class CDemoReader;
@@ -285,6 +286,8 @@ private:
 	static std::array<std::string, 25> commandBlacklist;
 
 	std::unique_ptr<netcode::UDPListener> udpListener;
+	/// server-side end of the local client's connection, UpdateLoop waits on it
+	std::weak_ptr<netcode::CLocalConnection> localClientLink;
 	std::unique_ptr<CDemoReader> demoReader;
 	std::unique_ptr<CDemoRecorder> demoRecorder;
 	std::unique_ptr<AutohostInterface> hostif;
@@ -18,6 +18,7 @@
 #include "Game/InMapDraw.h"
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
+#include "Game/ReplayReport.h"
 #include "Game/UI/GameSetupDrawer.h"
 #include "Game/UI/MouseHandler.h"
 #include "Lua/LuaHandle.h"
@@ -278,6 +279,9 @@ void CGame::ClientReadNet()
 		if (packet == nullptr)
 			break;
 
+		// asynchronous AIs read sim-state, let them finish before it changes
+		eoh->SyncSkirmishAIs();
+
 		lastReceivedNetPacketTime = spring_gettime();
 
 		const uint8_t* inbuf = packet->data;
@@ -297,6 +301,10 @@ void CGame::ClientReadNet()
 					GameEnd({});
 					AddTraffic(-1, packetCode, dataLength);
 					clientNet->Close(true);
+
+					// batch-replay; server quits after the last demo frame was sent
+					if (replayReport.Write())
+						gu->globalQuit = true;
 				} catch (const netcode::UnpackPacketException& ex) {
 					LOG_L(L_ERROR, "[Game::%s][NETMSG_QUIT] exception \"%s\"", __func__, ex.what());
 				}
@@ -570,6 +578,8 @@ void CGame::ClientReadNet()
 				// buffer all checksums, so we can check sync later between demo & local
 				if (haveServerDemo)
 					localSyncChecksums[gs->frameNum] = CSyncChecker::GetChecksum();
+				if (replayReport.IsEnabled())
+					replayReport.SimFrame(gs->frameNum, CSyncChecker::GetChecksum());
 
 				// reset checksum every 4096 frames =~ 2.5 minutes
 				if ((gs->frameNum & 4095) == 0)
@@ -608,6 +618,7 @@ void CGame::ClientReadNet()
 					const char* fmtStr = "[DESYNC WARNING] checksum %x from demo %s %d (%s) does not match our checksum %x for frame-number %d";
 
 					LOG_L(L_ERROR, fmtStr, checkSum, pType, playerNum, pName, ourCheckSum, frameNum);
+					replayReport.Desync(frameNum, playerNum, checkSum, ourCheckSum);
 				}
 #endif
 			} break;
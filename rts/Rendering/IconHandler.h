@@ -4,6 +4,7 @@
 #define ICON_HANDLER_H
 
 #include <array>
+#include <atomic>
 #include <string>
 
 #include "Icon.h"
@@ -32,7 +33,7 @@ namespace icon {
 			CIconData& operator = (CIconData&& id) {
 				std::swap(name, id.name);
 
-				std::swap(refCount, id.refCount);
+				refCount = id.refCount.exchange(refCount);
 				std::swap(texID, id.texID);
 
 				xsize = id.xsize;
@@ -85,7 +86,8 @@ namespace icon {
 		private:
 			std::string name;
 
-			int refCount = 123456;
+			// icons are referenced by defs, which are built on worker threads
+			std::atomic<int> refCount = {123456};
 			unsigned int texID = 0;
 			int xsize = 1;
 			int ysize = 1;
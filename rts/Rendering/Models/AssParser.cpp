@@ -9,12 +9,19 @@
 #include "Sim/Misc/CollisionVolume.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
+#include "System/CRC.h"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 #include "System/Exceptions.h"
+#include "System/MainDefines.h"
 #include "System/ScopedFPUSettings.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/Archives/FileView.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Misc/SpringTime.h"
 
 #include "lib/assimp/include/assimp/config.h"
 #include "lib/assimp/include/assimp/defs.h"
@@ -24,7 +31,15 @@
 #include "lib/assimp/include/assimp/Importer.hpp"
 #include "lib/assimp/include/assimp/DefaultLogger.hpp"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
 #include <regex>
+#include <type_traits>
+
+
+CONFIG(bool, AssimpModelCache).defaultValue(true).description("Cache the processed geometry of Assimp-loaded models (dae, obj, ...) on disk, so later loads of an unchanged model file skip the import.");
 
 
 #define IS_QNAN(f) (f != f)
@@ -54,6 +69,38 @@ static constexpr unsigned int ASS_LOGGING_OPTIONS =
 	Assimp::Logger::Err |
 	Assimp::Logger::Warn;
 
+/*
+ * Cache-file layout (native byte-order, like the binary ArchiveCache):
+ *   SceneCacheHeader
+ *   uint32 numMeshes, numMaterials, numTextures, numTextureFiles, numNodes
+ *   per texture file: uint16 length, char[length]
+ *   per node: uint16 nameLength, char[nameLength], int32 parent,
+ *             uint32 numMeshes, uint32 numTexCoorChannels,
+ *             float3 scale, float4 rotation, float3 translation, float3 mins, float3 maxs,
+ *             uint32 numVertices, uint32 numIndices,
+ *             SAssVertex[numVertices], uint32[numIndices]
+ * dataCRC covers everything following the header. Files are named after
+ * the CRC and size of the model file, which the header repeats; changes
+ * to the importer limits or options also invalidate them.
+ */
+constexpr static char SCENE_CACHE_MAGIC[8] = {'S', 'P', 'R', 'A', 'S', 'S', 'M', 'C'};
+constexpr static uint32_t SCENE_CACHE_VER = 1;
+
+struct SceneCacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t options;
+	uint32_t maxVertices;
+	uint32_t maxIndices;
+	uint64_t fileSize;
+	uint32_t fileCRC;
+	uint32_t vertexSize;
+	uint32_t dataSize;
+	uint32_t dataCRC;
+};
+
+static_assert(std::is_trivially_copyable<SAssVertex>::value, "vertices are cached as raw memory");
+
 
 
 static inline float3 aiVectorToFloat3(const aiVector3D v)
@@ -131,6 +178,11 @@ void CAssParser::Init()
 	maxVertices = std::max(globalRendering->glslMaxRecommendedVertices, 1024);
 	numPoolPieces = 0;
 
+	cacheDir.clear();
+
+	if (configHandler->GetBool("AssimpModelCache"))
+		cacheDir = dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + "/models/", FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
 	Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
 	// create a logger for debugging model loading issues
 	Assimp::DefaultLogger::get()->attachStream(new AssLogStream(), ASS_LOGGING_OPTIONS);
@@ -182,13 +234,6 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 		LOG_SL(LOG_SECTION_MODEL, L_INFO, "No valid model metadata in '%s' or no meta-file", metaFileName.c_str());
 
 
-	Assimp::Importer importer;
-
-	// speed-up processing by skipping things we don't need
-	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
-
 	if (!file.IsBuffered()) {
 		fileBuf.resize(file.FileSize(), 0);
 		file.Read(fileBuf.data(), fileBuf.size());
@@ -202,24 +247,44 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 	}
 
 
-	// Read the model file to build a scene object
-	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Importing model file: %s", modelFilePath.c_str());
+	// the cache only replaces the import, metadata is always applied anew
+	const unsigned int fileCRC = CRC::CalcDigest(fileBuf.data(), fileBuf.size());
+	const std::string& cacheFileName = GetCacheFileName(fileBuf, fileCRC);
 
-	const aiScene* scene = nullptr;
+	SAssScene scene;
 
-	{
-		// ASSIMP spams many SIGFPEs atm in normal & tangent generation
-		ScopedDisableFpuExceptions fe;
-		scene = importer.ReadFileFromMemory(fileBuf.data(), fileBuf.size(), ASS_POSTPROCESS_OPTIONS);
-	}
+	if (!ReadCachedScene(cacheFileName, fileBuf, fileCRC, scene)) {
+		Assimp::Importer importer;
+
+		// speed-up processing by skipping things we don't need
+		importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
+		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
+		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
 
-	if (scene == nullptr)
-		throw content_error("[AssimpParser] Model Import: " + std::string(importer.GetErrorString()));
+		// Read the model file to build a scene object
+		LOG_SL(LOG_SECTION_MODEL, L_INFO, "Importing model file: %s", modelFilePath.c_str());
+
+		const aiScene* importedScene = nullptr;
+
+		{
+			// ASSIMP spams many SIGFPEs atm in normal & tangent generation
+			ScopedDisableFpuExceptions fe;
+			importedScene = importer.ReadFileFromMemory(fileBuf.data(), fileBuf.size(), ASS_POSTPROCESS_OPTIONS);
+		}
+
+		if (importedScene == nullptr)
+			throw content_error("[AssimpParser] Model Import: " + std::string(importer.GetErrorString()));
+
+		ConvertScene(importedScene, scene);
+		WriteCachedScene(cacheFileName, fileBuf, fileCRC, scene);
+	} else {
+		LOG_SL(LOG_SECTION_MODEL, L_INFO, "Read cached model file: %s", cacheFileName.c_str());
+	}
 
 	LOG_SL(LOG_SECTION_MODEL, L_INFO,
 		"Processing scene for model: %s (%d meshes / %d materials / %d textures)",
-		modelFilePath.c_str(), scene->mNumMeshes, scene->mNumMaterials,
-		scene->mNumTextures
+		modelFilePath.c_str(), scene.numMeshes, scene.numMaterials,
+		scene.numTextures
 	);
 
 	ModelPieceMap pieceMap;
@@ -236,8 +301,8 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 	textureHandlerS3O.PreloadTexture(&model, modelTable.GetBool("fliptextures", true), modelTable.GetBool("invertteamcolor", true));
 
 	// Load all pieces in the model
-	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading pieces from root node '%s'", scene->mRootNode->mName.data);
-	LoadPiece(&model, scene->mRootNode, scene, modelTable, pieceMap, parentMap);
+	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading pieces from root node '%s'", scene.nodes[0].name.c_str());
+	LoadPiece(&model, scene, 0, modelTable, pieceMap, parentMap);
 
 	// Update piece hierarchy based on metadata
 	BuildPieceHierarchy(&model, pieceMap, parentMap);
@@ -298,6 +363,403 @@ void CAssParser::PreProcessFileBuffer(std::vector<unsigned char>& fileBuffer)
 	}
 }
 
+void CAssParser::ConvertScene(const aiScene* scene, SAssScene& assScene)
+{
+	assScene.numMeshes = scene->mNumMeshes;
+	assScene.numMaterials = scene->mNumMaterials;
+	assScene.numTextures = scene->mNumTextures;
+
+	if (scene->mNumMaterials > 0) {
+		constexpr unsigned int texTypes[] = {
+			aiTextureType_SPECULAR,
+			aiTextureType_UNKNOWN,
+			aiTextureType_DIFFUSE,
+			/*
+			// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
+			aiTextureType_EMISSIVE,
+			aiTextureType_HEIGHT,
+			aiTextureType_NORMALS,
+			aiTextureType_SHININESS,
+			aiTextureType_OPACITY,
+			*/
+		};
+		for (unsigned int texType: texTypes) {
+			aiString textureFile;
+			if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
+				continue;
+
+			assert(textureFile.length > 0);
+			assScene.textures.emplace_back(textureFile.data);
+		}
+	}
+
+	ConvertNode(scene, scene->mRootNode, -1, assScene);
+}
+
+void CAssParser::ConvertNode(const aiScene* scene, const aiNode* node, int parentIndex, SAssScene& assScene)
+{
+	const unsigned int nodeIndex = assScene.nodes.size();
+
+	if (parentIndex >= 0)
+		assScene.nodes[parentIndex].children.push_back(nodeIndex);
+
+	{
+		assScene.nodes.emplace_back();
+
+		SAssNode& assNode = assScene.nodes.back();
+
+		aiVector3D aiScaleVec;
+		aiVector3D aiTransVec;
+		aiQuaternion aiRotateQuat;
+
+		node->mTransformation.Decompose(aiScaleVec, aiRotateQuat, aiTransVec);
+
+		assNode.name = std::string(node->mName.data);
+		assNode.parent = parentIndex;
+		assNode.numMeshes = node->mNumMeshes;
+
+		assNode.scale = aiVectorToFloat3(aiScaleVec);
+		assNode.rotation = float4(aiRotateQuat.x, aiRotateQuat.y, aiRotateQuat.z, aiRotateQuat.w);
+		assNode.translation = aiVectorToFloat3(aiTransVec);
+
+		ConvertNodeGeometry(scene, node, assNode);
+	}
+
+	// children are appended behind their parent, which keeps the nodes in depth-first order
+	for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+		ConvertNode(scene, node->mChildren[i], nodeIndex, assScene);
+	}
+}
+
+void CAssParser::ConvertNodeGeometry(const aiScene* scene, const aiNode* node, SAssNode& assNode)
+{
+	std::vector<unsigned> meshVertexMapping;
+
+	// Get vertex data from node meshes
+	for (unsigned meshListIndex = 0; meshListIndex < node->mNumMeshes; ++meshListIndex) {
+		const unsigned int meshIndex = node->mMeshes[meshListIndex];
+		const aiMesh* mesh = scene->mMeshes[meshIndex];
+
+		LOG_SL(LOG_SECTION_PIECE, L_DEBUG, "Fetching mesh %d from scene", meshIndex);
+		LOG_SL(LOG_SECTION_PIECE, L_DEBUG,
+			"Processing vertices for mesh %d (%d vertices)",
+			meshIndex, mesh->mNumVertices);
+		LOG_SL(LOG_SECTION_PIECE, L_DEBUG,
+			"Normals: %s Tangents/Bitangents: %s TexCoords: %s",
+			(mesh->HasNormals() ? "Y" : "N"),
+			(mesh->HasTangentsAndBitangents() ? "Y" : "N"),
+			(mesh->HasTextureCoords(0) ? "Y" : "N"));
+
+		assNode.vertices.reserve(assNode.vertices.size() + mesh->mNumVertices);
+		assNode.indices.reserve(assNode.indices.size() + mesh->mNumFaces * 3);
+
+		meshVertexMapping.clear();
+		meshVertexMapping.reserve(mesh->mNumVertices);
+
+		// extract vertex data per mesh
+		for (unsigned vertexIndex = 0; vertexIndex < mesh->mNumVertices; ++vertexIndex) {
+			const aiVector3D& aiVertex = mesh->mVertices[vertexIndex];
+
+			SAssVertex vertex;
+
+			// vertex coordinates
+			vertex.pos = aiVectorToFloat3(aiVertex);
+
+			// update node min/max extents
+			assNode.mins = float3::min(assNode.mins, vertex.pos);
+			assNode.maxs = float3::max(assNode.maxs, vertex.pos);
+
+			// vertex normal
+			const aiVector3D& aiNormal = mesh->mNormals[vertexIndex];
+
+			if (!IS_QNAN(aiNormal))
+				vertex.normal = (aiVectorToFloat3(aiNormal)).SafeANormalize();
+
+			// vertex tangent, x is positive in texture axis
+			if (mesh->HasTangentsAndBitangents()) {
+				const aiVector3D& aiTangent = mesh->mTangents[vertexIndex];
+				const aiVector3D& aiBitangent = mesh->mBitangents[vertexIndex];
+
+				vertex.sTangent = (aiVectorToFloat3(aiTangent)).SafeANormalize();
+				vertex.tTangent = (aiVectorToFloat3(aiBitangent)).SafeANormalize();
+				vertex.tTangent *= -1.0f; // LH (assimp) to RH
+			}
+
+			// vertex tex-coords per channel
+			for (unsigned int uvChanIndex = 0; uvChanIndex < NUM_MODEL_UVCHANNS; uvChanIndex++) {
+				if (!mesh->HasTextureCoords(uvChanIndex))
+					break;
+
+				assNode.numTexCoorChannels = uvChanIndex + 1;
+
+				vertex.texCoords[uvChanIndex].x = mesh->mTextureCoords[uvChanIndex][vertexIndex].x;
+				vertex.texCoords[uvChanIndex].y = mesh->mTextureCoords[uvChanIndex][vertexIndex].y;
+			}
+
+			meshVertexMapping.push_back(assNode.vertices.size());
+			assNode.vertices.push_back(vertex);
+		}
+
+		// extract face data
+		LOG_SL(LOG_SECTION_PIECE, L_DEBUG, "Processing faces for mesh %d (%d faces)", meshIndex, mesh->mNumFaces);
+
+		/*
+		 * since aiProcess_SortByPType is being used,
+		 * we're sure we'll get only 1 type here,
+		 * so combination check isn't needed, also
+		 * anything more complex than triangles is
+		 * being split thanks to aiProcess_Triangulate
+		 */
+		for (unsigned faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex) {
+			const aiFace& face = mesh->mFaces[faceIndex];
+
+			// some models contain lines (mNumIndices == 2) which
+			// we cannot render and they would need a 2nd drawcall)
+			if (face.mNumIndices != 3)
+				continue;
+
+			for (unsigned vertexListID = 0; vertexListID < face.mNumIndices; ++vertexListID) {
+				const unsigned int vertexFaceIdx = face.mIndices[vertexListID];
+				const unsigned int vertexDrawIdx = meshVertexMapping[vertexFaceIdx];
+				assNode.indices.push_back(vertexDrawIdx);
+			}
+		}
+	}
+}
+
+
+std::string CAssParser::GetCacheFileName(const std::vector<unsigned char>& fileBuffer, unsigned int fileCRC) const
+{
+	if (cacheDir.empty())
+		return "";
+
+	char fileName[64];
+	SNPRINTF(fileName, sizeof(fileName), "%08x%08x.smc", fileCRC, static_cast<unsigned int>(fileBuffer.size()));
+	return (FileSystem::EnsurePathSepAtEnd(cacheDir) + fileName);
+}
+
+bool CAssParser::ReadCachedScene(
+	const std::string& cacheFileName,
+	const std::vector<unsigned char>& fileBuffer,
+	unsigned int fileCRC,
+	SAssScene& assScene
+) const {
+	if (cacheFileName.empty())
+		return false;
+
+	// a single mapping of the whole file, vertex and index arrays are copied straight out of it
+	const std::shared_ptr<const CMappedFile> file = CMappedFile::Open(cacheFileName);
+
+	if (file == nullptr || file->GetSize() < sizeof(SceneCacheHeader))
+		return false;
+
+	SceneCacheHeader header;
+	std::memcpy(&header, file->GetData(), sizeof(header));
+
+	const std::uint8_t* data = file->GetData() + sizeof(header);
+	const size_t dataSize = file->GetSize() - sizeof(header);
+
+	bool valid = true;
+	valid = valid && (std::memcmp(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == SCENE_CACHE_VER);
+	valid = valid && (header.options == ASS_POSTPROCESS_OPTIONS && header.maxVertices == maxVertices && header.maxIndices == maxIndices);
+	valid = valid && (header.fileSize == fileBuffer.size() && header.fileCRC == fileCRC && header.vertexSize == sizeof(SAssVertex));
+	valid = valid && (header.dataSize == dataSize && CRC::CalcDigest(data, dataSize) == header.dataCRC);
+
+	if (!valid)
+		return false;
+
+	size_t pos = 0;
+
+	const auto ReadData = [&](void* p, size_t size) {
+		if ((pos + size) > dataSize)
+			return false;
+
+		std::memcpy(p, data + pos, size);
+		pos += size;
+		return true;
+	};
+	const auto ReadString = [&](std::string& s) {
+		uint16_t length = 0;
+
+		if (!ReadData(&length, sizeof(length)) || (pos + length) > dataSize)
+			return false;
+
+		s.assign(reinterpret_cast<const char*>(data + pos), length);
+		pos += length;
+		return true;
+	};
+
+	uint32_t numTextureFiles = 0;
+	uint32_t numNodes = 0;
+
+	valid = valid && ReadData(&assScene.numMeshes, sizeof(uint32_t));
+	valid = valid && ReadData(&assScene.numMaterials, sizeof(uint32_t));
+	valid = valid && ReadData(&assScene.numTextures, sizeof(uint32_t));
+	valid = valid && ReadData(&numTextureFiles, sizeof(uint32_t));
+	valid = valid && ReadData(&numNodes, sizeof(uint32_t));
+	valid = valid && (numNodes > 0 && numTextureFiles <= dataSize && numNodes <= dataSize);
+
+	if (valid) {
+		assScene.textures.resize(numTextureFiles);
+		assScene.nodes.resize(numNodes);
+	}
+
+	for (size_t i = 0; valid && i < assScene.textures.size(); i++) {
+		valid = ReadString(assScene.textures[i]);
+	}
+
+	for (size_t i = 0; valid && i < assScene.nodes.size(); i++) {
+		SAssNode& assNode = assScene.nodes[i];
+
+		int32_t parent = -1;
+		uint32_t numVertices = 0;
+		uint32_t numIndices = 0;
+
+		valid = valid && ReadString(assNode.name);
+		valid = valid && ReadData(&parent, sizeof(parent));
+		valid = valid && ReadData(&assNode.numMeshes, sizeof(uint32_t));
+		valid = valid && ReadData(&assNode.numTexCoorChannels, sizeof(uint32_t));
+		valid = valid && ReadData(&assNode.scale, sizeof(float3));
+		valid = valid && ReadData(&assNode.rotation, sizeof(float4));
+		valid = valid && ReadData(&assNode.translation, sizeof(float3));
+		valid = valid && ReadData(&assNode.mins, sizeof(float3));
+		valid = valid && ReadData(&assNode.maxs, sizeof(float3));
+		valid = valid && ReadData(&numVertices, sizeof(uint32_t));
+		valid = valid && ReadData(&numIndices, sizeof(uint32_t));
+
+		// only the root has no parent, everything else follows its parent
+		valid = valid && ((i == 0 && parent == -1) || (i > 0 && parent >= 0 && size_t(parent) < i));
+		valid = valid && ((numVertices * size_t(sizeof(SAssVertex)) + numIndices * size_t(sizeof(uint32_t))) <= (dataSize - pos));
+
+		if (!valid)
+			break;
+
+		assNode.parent = parent;
+		assNode.vertices.resize(numVertices);
+		assNode.indices.resize(numIndices);
+
+		ReadData(assNode.vertices.data(), numVertices * sizeof(SAssVertex));
+		ReadData(assNode.indices.data(), numIndices * sizeof(uint32_t));
+
+		for (const unsigned int index: assNode.indices) {
+			valid = valid && (index < numVertices);
+		}
+
+		if (parent >= 0)
+			assScene.nodes[parent].children.push_back(i);
+	}
+
+	if (!valid) {
+		LOG_SL(LOG_SECTION_MODEL, L_WARNING, "Ignoring invalid model cache-file \"%s\"", cacheFileName.c_str());
+		assScene = {};
+		return false;
+	}
+
+	return true;
+}
+
+void CAssParser::WriteCachedScene(
+	const std::string& cacheFileName,
+	const std::vector<unsigned char>& fileBuffer,
+	unsigned int fileCRC,
+	const SAssScene& assScene
+) const {
+	if (cacheFileName.empty())
+		return;
+
+	size_t reserveSize = 5 * sizeof(uint32_t);
+
+	for (const SAssNode& assNode: assScene.nodes) {
+		reserveSize += (128 + assNode.vertices.size() * sizeof(SAssVertex) + assNode.indices.size() * sizeof(uint32_t));
+	}
+
+	std::vector<uint8_t> data;
+	data.reserve(reserveSize);
+
+	const auto AppendData = [&](const void* p, size_t size) { data.insert(data.end(), reinterpret_cast<const uint8_t*>(p), reinterpret_cast<const uint8_t*>(p) + size); };
+	const auto AppendString = [&](const std::string& s) {
+		const uint16_t length = std::min(s.size(), size_t(0xFFFF));
+
+		AppendData(&length, sizeof(length));
+		AppendData(s.data(), length);
+	};
+
+	const uint32_t numTextureFiles = assScene.textures.size();
+	const uint32_t numNodes = assScene.nodes.size();
+
+	AppendData(&assScene.numMeshes, sizeof(uint32_t));
+	AppendData(&assScene.numMaterials, sizeof(uint32_t));
+	AppendData(&assScene.numTextures, sizeof(uint32_t));
+	AppendData(&numTextureFiles, sizeof(uint32_t));
+	AppendData(&numNodes, sizeof(uint32_t));
+
+	for (const std::string& textureFile: assScene.textures) {
+		AppendString(textureFile);
+	}
+
+	for (const SAssNode& assNode: assScene.nodes) {
+		const int32_t parent = assNode.parent;
+		const uint32_t numVertices = assNode.vertices.size();
+		const uint32_t numIndices = assNode.indices.size();
+
+		AppendString(assNode.name);
+		AppendData(&parent, sizeof(parent));
+		AppendData(&assNode.numMeshes, sizeof(uint32_t));
+		AppendData(&assNode.numTexCoorChannels, sizeof(uint32_t));
+		AppendData(&assNode.scale, sizeof(float3));
+		AppendData(&assNode.rotation, sizeof(float4));
+		AppendData(&assNode.translation, sizeof(float3));
+		AppendData(&assNode.mins, sizeof(float3));
+		AppendData(&assNode.maxs, sizeof(float3));
+		AppendData(&numVertices, sizeof(uint32_t));
+		AppendData(&numIndices, sizeof(uint32_t));
+		AppendData(assNode.vertices.data(), numVertices * sizeof(SAssVertex));
+		AppendData(assNode.indices.data(), numIndices * sizeof(uint32_t));
+	}
+
+	SceneCacheHeader header;
+	std::memcpy(header.magic, SCENE_CACHE_MAGIC, sizeof(header.magic));
+	header.version = SCENE_CACHE_VER;
+	header.options = ASS_POSTPROCESS_OPTIONS;
+	header.maxVertices = maxVertices;
+	header.maxIndices = maxIndices;
+	header.fileSize = fileBuffer.size();
+	header.fileCRC = fileCRC;
+	header.vertexSize = sizeof(SAssVertex);
+	header.dataSize = data.size();
+	header.dataCRC = CRC::CalcDigest(data.data(), data.size());
+
+	// models can be loaded concurrently (and the same file can be used by
+	// more than one of them, or by another engine process sharing the cache
+	// directory), so write to a name private to this call and move it over
+	static const unsigned int procToken = std::random_device()() ^ static_cast<unsigned int>(spring_gettime().toNanoSecsi());
+	static std::atomic<unsigned int> tempFileCounter = {0};
+
+	char tempSuffix[32];
+	SNPRINTF(tempSuffix, sizeof(tempSuffix), ".%08x.%u.tmp", procToken, tempFileCounter.fetch_add(1));
+
+	const std::string tempFileName = cacheFileName + tempSuffix;
+
+	FILE* out = fopen(tempFileName.c_str(), "wb");
+
+	if (out == nullptr) {
+		LOG_SL(LOG_SECTION_MODEL, L_WARNING, "Failed to write model cache-file \"%s\"", cacheFileName.c_str());
+		return;
+	}
+
+	bool ok = true;
+	ok &= (fwrite(&header, sizeof(header), 1, out) == 1);
+	ok &= (fwrite(data.data(), 1, data.size(), out) == data.size());
+	ok &= (fclose(out) != EOF);
+
+	// fails on some platforms if another thread got there first, which is fine
+	if (!ok || std::rename(tempFileName.c_str(), cacheFileName.c_str()) != 0)
+		std::remove(tempFileName.c_str());
+
+	if (!ok)
+		LOG_SL(LOG_SECTION_MODEL, L_WARNING, "Failed to write model cache-file \"%s\"", cacheFileName.c_str());
+}
+
 /*
 void CAssParser::CalculateModelMeshBounds(S3DModel* model, const aiScene* scene)
 {
@@ -332,22 +794,20 @@ void CAssParser::CalculateModelMeshBounds(S3DModel* model, const aiScene* scene)
 void CAssParser::LoadPieceTransformations(
 	SAssPiece* piece,
 	const S3DModel* model,
-	const aiNode* pieceNode,
+	const SAssNode& pieceNode,
 	const LuaTable& pieceTable
 ) {
-	aiVector3D aiScaleVec;
-	aiVector3D aiTransVec;
-	aiQuaternion aiRotateQuat;
-
-	// process transforms
-	pieceNode->mTransformation.Decompose(aiScaleVec, aiRotateQuat, aiTransVec);
+	// process transforms (decomposed during conversion)
+	const float3& scaleVec = pieceNode.scale;
+	const float3& transVec = pieceNode.translation;
+	const aiQuaternion aiRotateQuat(pieceNode.rotation.w, pieceNode.rotation.x, pieceNode.rotation.y, pieceNode.rotation.z);
 
 	const aiMatrix3x3t<float> aiBakedRotMatrix = aiRotateQuat.GetMatrix();
 	const aiMatrix4x4t<float> aiBakedMatrix = aiMatrix4x4t<float>(aiBakedRotMatrix);
 	CMatrix44f bakedMatrix = aiMatrixToMatrix(aiBakedMatrix);
 
 	// metadata-scaling
-	piece->scales   = pieceTable.GetFloat3("scale", aiVectorToFloat3(aiScaleVec));
+	piece->scales   = pieceTable.GetFloat3("scale", scaleVec);
 	piece->scales.x = pieceTable.GetFloat("scalex", piece->scales.x);
 	piece->scales.y = pieceTable.GetFloat("scaley", piece->scales.y);
 	piece->scales.z = pieceTable.GetFloat("scalez", piece->scales.z);
@@ -359,7 +819,7 @@ void CAssParser::LoadPieceTransformations(
 	}
 
 	// metadata-translation
-	piece->offset   = pieceTable.GetFloat3("offset", aiVectorToFloat3(aiTransVec));
+	piece->offset   = pieceTable.GetFloat3("offset", transVec);
 	piece->offset.x = pieceTable.GetFloat("offsetx", piece->offset.x);
 	piece->offset.y = pieceTable.GetFloat("offsety", piece->offset.y);
 	piece->offset.z = pieceTable.GetFloat("offsetz", piece->offset.z);
@@ -381,9 +841,9 @@ void CAssParser::LoadPieceTransformations(
 	LOG_SL(LOG_SECTION_PIECE, L_INFO,
 		"(%d:%s) Assimp offset (%f,%f,%f), rotate (%f,%f,%f,%f), scale (%f,%f,%f)",
 		model->numPieces, piece->name.c_str(),
-		aiTransVec.x, aiTransVec.y, aiTransVec.z,
+		transVec.x, transVec.y, transVec.z,
 		aiRotateQuat.w, aiRotateQuat.x, aiRotateQuat.y, aiRotateQuat.z,
-		aiScaleVec.x, aiScaleVec.y, aiScaleVec.z
+		scaleVec.x, scaleVec.y, scaleVec.z
 	);
 	LOG_SL(LOG_SECTION_PIECE, L_INFO,
 		"(%d:%s) Relative offset (%f,%f,%f), rotate (%f,%f,%f), scale (%f,%f,%f)",
@@ -406,11 +866,11 @@ void CAssParser::LoadPieceTransformations(
 void CAssParser::SetPieceName(
 	SAssPiece* piece,
 	const S3DModel* model,
-	const aiNode* pieceNode,
+	const SAssNode& pieceNode,
 	ModelPieceMap& pieceMap
 ) {
 	assert(piece->name.empty());
-	piece->name = std::string(pieceNode->mName.data);
+	piece->name = pieceNode.name;
 
 	if (piece->name.empty()) {
 		if (piece == model->GetRootPiece()) {
@@ -440,7 +900,8 @@ void CAssParser::SetPieceName(
 void CAssParser::SetPieceParentName(
 	SAssPiece* piece,
 	const S3DModel* model,
-	const aiNode* pieceNode,
+	const SAssScene& scene,
+	const SAssNode& pieceNode,
 	const LuaTable& pieceTable,
 	ParentNameMap& parentMap
 ) {
@@ -454,12 +915,12 @@ void CAssParser::SetPieceParentName(
 		return;
 	}
 
-	if (pieceNode->mParent == nullptr)
+	if (pieceNode.parent < 0)
 		return;
 
-	if (pieceNode->mParent->mParent != nullptr) {
+	if (scene.nodes[pieceNode.parent].parent >= 0) {
 		// parent is not the root
-		parentMap[piece->name] = std::string(pieceNode->mParent->mName.data);
+		parentMap[piece->name] = scene.nodes[pieceNode.parent].name;
 	} else {
 		// parent is the root (which must already exist)
 		assert(model->GetRootPiece() != nullptr);
@@ -467,100 +928,16 @@ void CAssParser::SetPieceParentName(
 	}
 }
 
-void CAssParser::LoadPieceGeometry(SAssPiece* piece, const aiNode* pieceNode, const aiScene* scene)
+void CAssParser::LoadPieceGeometry(SAssPiece* piece, SAssNode& pieceNode)
 {
-	std::vector<unsigned> meshVertexMapping;
-
-	// Get vertex data from node meshes
-	for (unsigned meshListIndex = 0; meshListIndex < pieceNode->mNumMeshes; ++meshListIndex) {
-		const unsigned int meshIndex = pieceNode->mMeshes[meshListIndex];
-		const aiMesh* mesh = scene->mMeshes[meshIndex];
-
-		LOG_SL(LOG_SECTION_PIECE, L_DEBUG, "Fetching mesh %d from scene", meshIndex);
-		LOG_SL(LOG_SECTION_PIECE, L_DEBUG,
-			"Processing vertices for mesh %d (%d vertices)",
-			meshIndex, mesh->mNumVertices);
-		LOG_SL(LOG_SECTION_PIECE, L_DEBUG,
-			"Normals: %s Tangents/Bitangents: %s TexCoords: %s",
-			(mesh->HasNormals() ? "Y" : "N"),
-			(mesh->HasTangentsAndBitangents() ? "Y" : "N"),
-			(mesh->HasTextureCoords(0) ? "Y" : "N"));
-
-		piece->vertices.reserve(piece->vertices.size() + mesh->mNumVertices);
-		piece->indices.reserve(piece->indices.size() + mesh->mNumFaces * 3);
-
-		meshVertexMapping.clear();
-		meshVertexMapping.reserve(mesh->mNumVertices);
-
-		// extract vertex data per mesh
-		for (unsigned vertexIndex = 0; vertexIndex < mesh->mNumVertices; ++vertexIndex) {
-			const aiVector3D& aiVertex = mesh->mVertices[vertexIndex];
-
-			SAssVertex vertex;
-
-			// vertex coordinates
-			vertex.pos = aiVectorToFloat3(aiVertex);
-
-			// update piece min/max extents
-			piece->mins = float3::min(piece->mins, vertex.pos);
-			piece->maxs = float3::max(piece->maxs, vertex.pos);
+	// the scene is discarded after loading, take over its buffers
+	piece->vertices = std::move(pieceNode.vertices);
+	piece->indices = std::move(pieceNode.indices);
 
-			// vertex normal
-			const aiVector3D& aiNormal = mesh->mNormals[vertexIndex];
-
-			if (!IS_QNAN(aiNormal))
-				vertex.normal = (aiVectorToFloat3(aiNormal)).SafeANormalize();
-
-			// vertex tangent, x is positive in texture axis
-			if (mesh->HasTangentsAndBitangents()) {
-				const aiVector3D& aiTangent = mesh->mTangents[vertexIndex];
-				const aiVector3D& aiBitangent = mesh->mBitangents[vertexIndex];
-
-				vertex.sTangent = (aiVectorToFloat3(aiTangent)).SafeANormalize();
-				vertex.tTangent = (aiVectorToFloat3(aiBitangent)).SafeANormalize();
-				vertex.tTangent *= -1.0f; // LH (assimp) to RH
-			}
-
-			// vertex tex-coords per channel
-			for (unsigned int uvChanIndex = 0; uvChanIndex < NUM_MODEL_UVCHANNS; uvChanIndex++) {
-				if (!mesh->HasTextureCoords(uvChanIndex))
-					break;
-
-				piece->SetNumTexCoorChannels(uvChanIndex + 1);
-
-				vertex.texCoords[uvChanIndex].x = mesh->mTextureCoords[uvChanIndex][vertexIndex].x;
-				vertex.texCoords[uvChanIndex].y = mesh->mTextureCoords[uvChanIndex][vertexIndex].y;
-			}
-
-			meshVertexMapping.push_back(piece->vertices.size());
-			piece->vertices.push_back(vertex);
-		}
-
-		// extract face data
-		LOG_SL(LOG_SECTION_PIECE, L_DEBUG, "Processing faces for mesh %d (%d faces)", meshIndex, mesh->mNumFaces);
-
-		/*
-		 * since aiProcess_SortByPType is being used,
-		 * we're sure we'll get only 1 type here,
-		 * so combination check isn't needed, also
-		 * anything more complex than triangles is
-		 * being split thanks to aiProcess_Triangulate
-		 */
-		for (unsigned faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex) {
-			const aiFace& face = mesh->mFaces[faceIndex];
-
-			// some models contain lines (mNumIndices == 2) which
-			// we cannot render and they would need a 2nd drawcall)
-			if (face.mNumIndices != 3)
-				continue;
+	piece->mins = pieceNode.mins;
+	piece->maxs = pieceNode.maxs;
 
-			for (unsigned vertexListID = 0; vertexListID < face.mNumIndices; ++vertexListID) {
-				const unsigned int vertexFaceIdx = face.mIndices[vertexListID];
-				const unsigned int vertexDrawIdx = meshVertexMapping[vertexFaceIdx];
-				piece->indices.push_back(vertexDrawIdx);
-			}
-		}
-	}
+	piece->SetNumTexCoorChannels(pieceNode.numTexCoorChannels);
 }
 
 // Not efficient, but there aren't that many pieces
@@ -609,8 +986,8 @@ SAssPiece* CAssParser::AllocPiece()
 
 SAssPiece* CAssParser::LoadPiece(
 	S3DModel* model,
-	const aiNode* pieceNode,
-	const aiScene* scene,
+	SAssScene& scene,
+	unsigned int nodeIndex,
 	const LuaTable& modelTable,
 	ModelPieceMap& pieceMap,
 	ParentNameMap& parentMap
@@ -618,16 +995,17 @@ SAssPiece* CAssParser::LoadPiece(
 	++model->numPieces;
 
 	SAssPiece* piece = AllocPiece();
+	SAssNode& pieceNode = scene.nodes[nodeIndex];
 
-	if (pieceNode->mParent == nullptr) {
+	if (pieceNode.parent < 0) {
 		// set the model's root piece ASAP, needed in SetPiece*Name
-		assert(pieceNode == scene->mRootNode);
+		assert(nodeIndex == 0);
 		model->AddPiece(piece);
 	}
 
 	SetPieceName(piece, model, pieceNode, pieceMap);
 
-	LOG_SL(LOG_SECTION_PIECE, L_INFO, "Converting node '%s' to piece '%s' (%d meshes).", pieceNode->mName.data, piece->name.c_str(), pieceNode->mNumMeshes);
+	LOG_SL(LOG_SECTION_PIECE, L_INFO, "Converting node '%s' to piece '%s' (%d meshes).", pieceNode.name.c_str(), piece->name.c_str(), pieceNode.numMeshes);
 
 	// Load additional piece properties from metadata
 	const LuaTable& pieceTable = GetPieceTableRecursively(modelTable.SubTable("pieces"), piece->name, "", parentMap);
@@ -637,8 +1015,8 @@ SAssPiece* CAssParser::LoadPiece(
 
 
 	LoadPieceTransformations(piece, model, pieceNode, pieceTable);
-	LoadPieceGeometry(piece, pieceNode, scene);
-	SetPieceParentName(piece, model, pieceNode, pieceTable, parentMap);
+	LoadPieceGeometry(piece, pieceNode);
+	SetPieceParentName(piece, model, scene, pieceNode, pieceTable, parentMap);
 
 	{
 		// operator[] creates an empty string if piece is not in map
@@ -646,14 +1024,14 @@ SAssPiece* CAssParser::LoadPiece(
 		const std::string& parentName = (parentNameIt != parentMap.end())? (parentNameIt->second).c_str(): "[null]";
 
 		// Verbose logging of piece properties
-		LOG_SL(LOG_SECTION_PIECE, L_INFO, "Loaded model piece: %s with %d meshes", piece->name.c_str(), pieceNode->mNumMeshes);
+		LOG_SL(LOG_SECTION_PIECE, L_INFO, "Loaded model piece: %s with %d meshes", piece->name.c_str(), pieceNode.numMeshes);
 		LOG_SL(LOG_SECTION_PIECE, L_INFO, "piece->name: %s", piece->name.c_str());
 		LOG_SL(LOG_SECTION_PIECE, L_INFO, "piece->parent: %s", parentName.c_str());
 	}
 
 	// Recursively process all child pieces
-	for (unsigned int i = 0; i < pieceNode->mNumChildren; ++i) {
-		LoadPiece(model, pieceNode->mChildren[i], scene, modelTable, pieceMap, parentMap);
+	for (const unsigned int childIndex: pieceNode.children) {
+		LoadPiece(model, scene, childIndex, modelTable, pieceMap, parentMap);
 	}
 
 	pieceMap[piece->name] = piece;
@@ -778,7 +1156,7 @@ static std::string FindTextureByRegex(const std::string& regex_path, const std::
 
 void CAssParser::FindTextures(
 	S3DModel* model,
-	const aiScene* scene,
+	const SAssScene& scene,
 	const LuaTable& modelTable,
 	const std::string& modelPath,
 	const std::string& modelName
@@ -794,28 +1172,8 @@ void CAssParser::FindTextures(
 	if (model->texs[1].empty()) model->texs[1] = FindTextureByRegex(modelPath, "glow"); // lowest-priority name
 
 	// 2. gather model-defined textures of first material (medium priority)
-	if (scene->mNumMaterials > 0) {
-		constexpr unsigned int texTypes[] = {
-			aiTextureType_SPECULAR,
-			aiTextureType_UNKNOWN,
-			aiTextureType_DIFFUSE,
-			/*
-			// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
-			aiTextureType_EMISSIVE,
-			aiTextureType_HEIGHT,
-			aiTextureType_NORMALS,
-			aiTextureType_SHININESS,
-			aiTextureType_OPACITY,
-			*/
-		};
-		for (unsigned int texType: texTypes) {
-			aiString textureFile;
-			if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
-				continue;
-
-			assert(textureFile.length > 0);
-			model->texs[0] = FindTexture(textureFile.data, modelPath, model->texs[0]);
-		}
+	for (const std::string& textureFile: scene.textures) {
+		model->texs[0] = FindTexture(textureFile, modelPath, model->texs[0]);
 	}
 
 	// 3. try to load from metafile (highest priority)
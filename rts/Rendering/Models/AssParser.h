@@ -8,6 +8,7 @@
 #include "3DModel.h"
 #include "IModelParser.h"
 #include "System/float3.h"
+#include "System/float4.h"
 #include "System/type2.h"
 #include "System/UnorderedMap.hpp"
 
@@ -79,38 +80,78 @@ public:
 	S3DModel Load(const std::string& modelFileName) override;
 
 private:
+	// everything Load needs from an imported aiNode, independent of assimp
+	struct SAssNode {
+		std::string name;
+		std::vector<unsigned int> children;
+
+		// index of the parent in SAssScene::nodes, -1 for the root
+		int parent = -1;
+
+		unsigned int numMeshes = 0;
+		unsigned int numTexCoorChannels = 0;
+
+		// decomposed node transform (rotation is a quaternion)
+		float3 scale;
+		float4 rotation;
+		float3 translation;
+
+		float3 mins = DEF_MIN_SIZE;
+		float3 maxs = DEF_MAX_SIZE;
+
+		std::vector<SAssVertex> vertices;
+		std::vector<unsigned int> indices;
+	};
+
+	// a post-processed assimp scene; this is what gets cached on disk
+	struct SAssScene {
+		// depth-first order, root first
+		std::vector<SAssNode> nodes;
+		// texture files of the first material
+		std::vector<std::string> textures;
+
+		unsigned int numMeshes = 0;
+		unsigned int numMaterials = 0;
+		unsigned int numTextures = 0;
+	};
+
 	static void PreProcessFileBuffer(std::vector<unsigned char>& fileBuffer);
 
+	static void ConvertScene(const aiScene* scene, SAssScene& assScene);
+	static void ConvertNode(const aiScene* scene, const aiNode* node, int parentIndex, SAssScene& assScene);
+	static void ConvertNodeGeometry(const aiScene* scene, const aiNode* node, SAssNode& assNode);
+
+	std::string GetCacheFileName(const std::vector<unsigned char>& fileBuffer, unsigned int fileCRC) const;
+	bool ReadCachedScene(const std::string& cacheFileName, const std::vector<unsigned char>& fileBuffer, unsigned int fileCRC, SAssScene& assScene) const;
+	void WriteCachedScene(const std::string& cacheFileName, const std::vector<unsigned char>& fileBuffer, unsigned int fileCRC, const SAssScene& assScene) const;
+
 	static void SetPieceName(
 		SAssPiece* piece,
 		const S3DModel* model,
-		const aiNode* pieceNode,
+		const SAssNode& pieceNode,
 		ModelPieceMap& pieceMap
 	);
 	static void SetPieceParentName(
 		SAssPiece* piece,
 		const S3DModel* model,
-		const aiNode* pieceNode,
+		const SAssScene& scene,
+		const SAssNode& pieceNode,
 		const LuaTable& pieceTable,
 		ParentNameMap& parentMap
 	);
 	static void LoadPieceTransformations(
 		SAssPiece* piece,
 		const S3DModel* model,
-		const aiNode* pieceNode,
+		const SAssNode& pieceNode,
 		const LuaTable& pieceTable
 	);
-	static void LoadPieceGeometry(
-		SAssPiece* piece,
-		const aiNode* pieceNode,
-		const aiScene* scene
-	);
+	static void LoadPieceGeometry(SAssPiece* piece, SAssNode& pieceNode);
 
 	SAssPiece* AllocPiece();
 	SAssPiece* LoadPiece(
 		S3DModel* model,
-		const aiNode* pieceNode,
-		const aiScene* scene,
+		SAssScene& scene,
+		unsigned int nodeIndex,
 		const LuaTable& modelTable,
 		ModelPieceMap& pieceMap,
 		ParentNameMap& parentMap
@@ -121,7 +162,7 @@ private:
 	static void CalculateModelProperties(S3DModel* model, const LuaTable& pieceTable);
 	static void FindTextures(
 		S3DModel* model,
-		const aiScene* scene,
+		const SAssScene& scene,
 		const LuaTable& pieceTable,
 		const std::string& modelPath,
 		const std::string& modelName
@@ -132,6 +173,9 @@ private:
 	unsigned int maxVertices = 0;
 	unsigned int numPoolPieces = 0;
 
+	// where processed scenes are cached, empty if disabled
+	std::string cacheDir;
+
 	std::vector<SAssPiece> piecePool;
 	spring::mutex poolMutex;
 };
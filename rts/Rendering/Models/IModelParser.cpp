@@ -8,6 +8,7 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Net/Protocol/NetProtocol.h" // NETLOG
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
@@ -15,10 +16,13 @@
 #include "System/Exceptions.h"
 #include "System/MainDefines.h" // SNPRINTF
 #include "System/SafeUtil.h"
+#include "System/Misc/SpringTime.h"
 #include "System/Threading/ThreadPool.h"
 #include "lib/assimp/include/assimp/Importer.hpp"
 
 
+CONFIG(int, ModelPreloadCacheSize).defaultValue(256).minimumValue(0).description("Maximum size (in MB) of decoded model textures held in memory at once while all models are preloaded during game load. 0 disables the bulk preload, models are then loaded when first needed.");
+
 CModelLoader modelLoader;
 
 static C3DOParser g3DOParser;
@@ -222,6 +226,52 @@ void CModelLoader::PreloadModel(const std::string& modelName)
 	});
 }
 
+void CModelLoader::PreloadModels(std::vector<std::string> names)
+{
+	const size_t maxCacheSize = configHandler->GetInt("ModelPreloadCacheSize") * size_t(1024 * 1024);
+
+	if (maxCacheSize == 0)
+		return;
+
+	for (std::string& name: names) {
+		StringToLowerInPlace(name);
+	}
+
+	// LoadModel is not atomic, make sure no model is parsed twice
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+	names.erase(std::remove(names.begin(), names.end(), ""), names.end());
+
+	const spring_time startTime = spring_gettime();
+	const size_t batchSize = ThreadPool::GetNumThreads() * 4;
+
+	std::vector<S3DModel*> loadedModels(names.size(), nullptr);
+
+	for (size_t i = 0, j = 0, k = 0; i < names.size(); i = j) {
+		j = std::min(i + batchSize, names.size());
+
+		// parse models and decode their textures on all threads; the textures
+		// are kept as bitmaps until the GL objects are created on this thread
+		for_mt(i, j, [&](const int n) {
+			loadedModels[n] = LoadModel(names[n], true);
+		});
+
+		if (j < names.size() && textureHandlerS3O.GetBitmapCacheSize() < maxCacheSize)
+			continue;
+
+		std::lock_guard<spring::mutex> lock(mutex);
+
+		for (; k < j; k++) {
+			if (loadedModels[k] == nullptr || loadedModels[k]->id == 0)
+				continue;
+
+			CreateLists(loadedModels[k]);
+		}
+	}
+
+	LOG("[ModelLoader::%s] preloaded %u models in %ims", __func__, static_cast<unsigned int>(names.size()), int((spring_gettime() - startTime).toMilliSecsi()));
+}
+
 void CModelLoader::LogErrors()
 {
 	assert(Threading::IsMainThread());
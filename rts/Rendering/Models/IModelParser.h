@@ -32,6 +32,8 @@ public:
 
 	bool IsValid() const { return (!formats.empty()); }
 	void PreloadModel(const std::string& name);
+	/// parses <names> and decodes their textures in parallel, then uploads them to GL in batches
+	void PreloadModels(std::vector<std::string> names);
 	void LogErrors();
 
 public:
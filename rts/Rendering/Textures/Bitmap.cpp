@@ -470,6 +470,7 @@ bool CBitmap::Load(std::string const& filename, uint8_t defaultAlpha)
 
 	CFileHandler file(filename);
 	std::vector<uint8_t> buffer;
+	CFileView bufferView;
 
 	if (!file.FileExists()) {
 		AllocDummy();
@@ -479,9 +480,10 @@ bool CBitmap::Load(std::string const& filename, uint8_t defaultAlpha)
 	if (!file.IsBuffered()) {
 		buffer.resize(file.FileSize(), 0);
 		file.Read(buffer.data(), buffer.size());
+		bufferView = CFileView(buffer.data(), buffer.size());
 	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
+		// reference (without copying) if file was loaded from VFS
+		bufferView = file.GetBufferView();
 	}
 
 
@@ -501,7 +503,7 @@ bool CBitmap::Load(std::string const& filename, uint8_t defaultAlpha)
 			// do not signal floating point exceptions in devil library
 			ScopedDisableFpuExceptions fe;
 
-			isLoaded = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), buffer.size());
+			isLoaded = !!ilLoadL(IL_TYPE_UNKNOWN, bufferView.GetData(), bufferView.GetSize());
 			isValid = (isLoaded && IsValidImageFormat(ilGetInteger(IL_IMAGE_FORMAT)));
 			noAlpha = (isValid && (ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL) != 4));
 
@@ -566,13 +568,15 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 		return false;
 
 	std::vector<uint8_t> buffer;
+	CFileView bufferView;
 
 	if (!file.IsBuffered()) {
 		buffer.resize(file.FileSize() + 1, 0);
 		file.Read(buffer.data(), file.FileSize());
+		bufferView = CFileView(buffer.data(), buffer.size());
 	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
+		// reference (without copying) if file was loaded from VFS
+		bufferView = file.GetBufferView();
 	}
 
 	{
@@ -585,7 +589,7 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 		ilGenImages(1, &imageID);
 		ilBindImage(imageID);
 
-		const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), buffer.size());
+		const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, bufferView.GetData(), bufferView.GetSize());
 		ilDisable(IL_ORIGIN_SET);
 
 		if (!success)
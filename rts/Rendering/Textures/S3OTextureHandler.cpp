@@ -60,15 +60,15 @@ void CS3OTextureHandler::Kill()
 	textureCache.clear();
 	textureTable.clear();
 	bitmapCache.clear();
+
+	bitmapCacheSize = 0;
 }
 
 
 void CS3OTextureHandler::PreloadTexture(S3DModel* model, bool invertAxis, bool invertAlpha)
 {
-	cacheMutex.lock();
-	LoadAndCacheTexture(model, 0, invertAxis, invertAlpha, true);
-	LoadAndCacheTexture(model, 1, invertAxis,       false, true); // never invert alpha for tex2
-	cacheMutex.unlock();
+	PreloadBitmap(model, 0, invertAxis, invertAlpha);
+	PreloadBitmap(model, 1, invertAxis,       false); // never invert alpha for tex2
 }
 
 
@@ -76,8 +76,8 @@ void CS3OTextureHandler::LoadTexture(S3DModel* model)
 {
 	cacheMutex.lock();
 
-	const unsigned int tex1ID = LoadAndCacheTexture(model, 0, false, false, false);
-	const unsigned int tex2ID = LoadAndCacheTexture(model, 1, false, false, false);
+	const unsigned int tex1ID = LoadAndCacheTexture(model, 0);
+	const unsigned int tex2ID = LoadAndCacheTexture(model, 1);
 
 	const auto texTableIter = textureTable.find(TEX_MAT_UID(tex1ID, tex2ID));
 
@@ -92,66 +92,96 @@ void CS3OTextureHandler::LoadTexture(S3DModel* model)
 	cacheMutex.unlock();
 }
 
-unsigned int CS3OTextureHandler::LoadAndCacheTexture(
+void CS3OTextureHandler::PreloadBitmap(
 	const S3DModel* model,
 	unsigned int texNum,
 	bool invertAxis,
-	bool invertAlpha,
-	bool preloadCall
+	bool invertAlpha
 ) {
-	CBitmap* bitmap = nullptr;
-
 	const auto& textureName = model->texs[texNum];
-	const auto textureIt = textureCache.find(textureName);
 
-	if (textureIt != textureCache.end())
-		return textureIt->second.texID;
+	const auto IsCached = [&]() {
+		return (textureCache.find(textureName) != textureCache.end() || bitmapCache.find(textureName) != bitmapCache.end());
+	};
 
-	const auto bitmapIt = bitmapCache.find(textureName);
+	{
+		std::lock_guard<spring::mutex> lock(cacheMutex);
 
-	if (bitmapIt != bitmapCache.end()) {
-		// bitmap was previously preloaded but not yet loaded
-		// if !preloading, we will now turn the bitmap into a
-		// texture and cache it
-		bitmap = &(bitmapIt->second);
-	} else {
-		// bitmap was not yet preloaded, meaning we are the
-		// first to (all non-3DO model textures are always
-		// preloaded)
-		assert(preloadCall);
+		if (IsCached())
+			return;
+	}
 
-		auto pair = bitmapCache.emplace(textureName, {});
-		auto iter = pair.first;
+	// decode without holding the lock, models are preloaded in parallel
+	// (two threads might decode the same texture, the first one is kept)
+	CBitmap bitmap;
+	LoadBitmap(bitmap, model, texNum, invertAxis, invertAlpha);
 
-		bitmap = &(iter->second);
+	std::lock_guard<spring::mutex> lock(cacheMutex);
 
-		if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
-			if (texNum == 0)
-				LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
+	if (IsCached())
+		return;
 
-			// file not found (or headless build), set a single pixel so model is visible
-			bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
-		}
+	bitmapCacheSize += bitmap.GetMemSize();
+	bitmapCache[textureName] = std::move(bitmap);
+}
 
-		if (invertAxis)
-			bitmap->ReverseYAxis();
-		if (invertAlpha)
-			bitmap->InvertAlpha();
+void CS3OTextureHandler::LoadBitmap(
+	CBitmap& bitmap,
+	const S3DModel* model,
+	unsigned int texNum,
+	bool invertAxis,
+	bool invertAlpha
+) {
+	const auto& textureName = model->texs[texNum];
+
+	if (!bitmap.Load(textureName) && !bitmap.Load("unittextures/" + textureName)) {
+		if (texNum == 0)
+			LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
+
+		// file not found (or headless build), set a single pixel so model is visible
+		bitmap.AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
 	}
 
-	// don't generate a texture yet, just save the bitmap for later
-	if (preloadCall)
-		return 0;
+	if (invertAxis)
+		bitmap.ReverseYAxis();
+	if (invertAlpha)
+		bitmap.InvertAlpha();
+}
+
+unsigned int CS3OTextureHandler::LoadAndCacheTexture(const S3DModel* model, unsigned int texNum)
+{
+	// caller has lock
+	const auto& textureName = model->texs[texNum];
+	const auto textureIt = textureCache.find(textureName);
+
+	if (textureIt != textureCache.end())
+		return textureIt->second.texID;
+
+	auto bitmapIt = bitmapCache.find(textureName);
+
+	// all non-3DO model textures are normally preloaded by
+	// their parser, otherwise the bitmap has to be loaded now
+	if (bitmapIt == bitmapCache.end()) {
+		CBitmap& bitmap = bitmapCache[textureName];
+
+		LoadBitmap(bitmap, model, texNum, false, false);
+
+		bitmapCacheSize += bitmap.GetMemSize();
+		bitmapIt = bitmapCache.find(textureName);
+	}
 
-	const unsigned int texID = bitmap->CreateMipMapTexture();
+	// turn the bitmap into a texture and cache it
+	const CBitmap& bitmap = bitmapIt->second;
+	const unsigned int texID = bitmap.CreateMipMapTexture();
 
 	textureCache[textureName] = {
 		texID,
-		static_cast<unsigned int>(bitmap->xsize),
-		static_cast<unsigned int>(bitmap->ysize)
+		static_cast<unsigned int>(bitmap.xsize),
+		static_cast<unsigned int>(bitmap.ysize)
 	};
 
-	bitmapCache.erase(textureName);
+	bitmapCacheSize -= bitmap.GetMemSize();
+	bitmapCache.erase(bitmapIt);
 	return texID;
 }
 
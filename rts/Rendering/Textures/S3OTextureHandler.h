@@ -41,6 +41,12 @@ public:
 	void LoadTexture(S3DModel* model);
 	void PreloadTexture(S3DModel* model, bool invertAxis = false, bool invertAlpha = false);
 
+	/// memory held by textures that were preloaded but not yet turned into GL textures
+	size_t GetBitmapCacheSize() {
+		std::lock_guard<spring::mutex> lock(cacheMutex);
+		return bitmapCacheSize;
+	}
+
 public:
 	const S3OTexMat* GetTexture(unsigned int num) {
 		if (num < textures.size())
@@ -50,13 +56,9 @@ public:
 	}
 
 private:
-	unsigned int LoadAndCacheTexture(
-		const S3DModel* model,
-		unsigned int texNum,
-		bool invertAxis,
-		bool invertAlpha,
-		bool preloadCall
-	);
+	unsigned int LoadAndCacheTexture(const S3DModel* model, unsigned int texNum);
+	void PreloadBitmap(const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha);
+	static void LoadBitmap(CBitmap& bitmap, const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha);
 	unsigned int InsertTextureMat(const S3DModel* model);
 
 private:
@@ -70,6 +72,8 @@ private:
 
 	spring::mutex cacheMutex;
 
+	size_t bitmapCacheSize = 0;
+
 	std::vector<S3OTexMat> textures;
 };
 
@@ -295,6 +295,7 @@ bool CDDSImage::load(string filename, bool flipImage)
 	CFileHandler file(filename);
 
 	std::vector<uint8_t> fileBuf;
+	CFileView fileView;
 	int filePos = 0;
 
 	if (!file.FileExists())
@@ -342,9 +343,9 @@ bool CDDSImage::load(string filename, bool flipImage)
 	file.Read(&ddsh.dwCaps2, tmp);
 	file.Read(&ddsh.dwReserved2, tmp*3);
 
-	// if in VFS, read post-header data directly from buffer
+	// if in VFS, read post-header data directly from buffer (or mapped file)
 	if (file.IsBuffered()) {
-		fileBuf = std::move(file.GetBuffer());
+		fileView = file.GetBufferView();
 		filePos = file.GetPos();
 	}
 #endif
@@ -458,7 +459,7 @@ bool CDDSImage::load(string filename, bool flipImage)
 
 		fread(pixels, 1, size, fp);
 	#else
-		if (fileBuf.empty()) {
+		if (!fileView.IsValid()) {
 			fileBuf.resize(size);
 
 			file.Read(fileBuf.data(), size);
@@ -466,7 +467,7 @@ bool CDDSImage::load(string filename, bool flipImage)
 
 			fileBuf.clear();
 		} else {
-			img.create(width, height, depth, size, fileBuf.data() + filePos);
+			img.create(width, height, depth, size, fileView.GetData() + filePos);
 			filePos += size;
 		}
 	#endif
@@ -505,7 +506,7 @@ bool CDDSImage::load(string filename, bool flipImage)
 
 			fread(pixels, 1, size, fp);
 		#else
-			if (fileBuf.empty()) {
+			if (!fileView.IsValid()) {
 				fileBuf.resize(size);
 
 				file.Read(fileBuf.data(), size);
@@ -513,7 +514,7 @@ bool CDDSImage::load(string filename, bool flipImage)
 
 				fileBuf.clear();
 			} else {
-				mipmap.create(w, h, d, size, fileBuf.data() + filePos);
+				mipmap.create(w, h, d, size, fileView.GetData() + filePos);
 				filePos += size;
 			}
 		#endif
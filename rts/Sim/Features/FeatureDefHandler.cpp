@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <exception>
+
 #include "FeatureDefHandler.h"
 
 #include "FeatureDef.h"
@@ -10,33 +12,69 @@
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/UnorderedSet.hpp"
 
 static CFeatureDefHandler gFeatureDefHandler;
 CFeatureDefHandler* featureDefHandler = &gFeatureDefHandler;
 
 void CFeatureDefHandler::Init(LuaParser* defsParser)
 {
-	const LuaTable rootTable = defsParser->GetRoot().SubTable("FeatureDefs");
+	// the snapshot holds no Lua state, so defs can be parsed from it on any thread
+	const LuaTable rootTable = defsParser->GetRoot().SubTable("FeatureDefs").Snapshot();
 
 	if (!rootTable.IsValid())
 		throw content_error("Error loading FeatureDefs");
 
 	// get most of the feature defs (excluding map-defined trees and geovents)
 	std::vector<std::string> keys;
+	std::vector<int> defIDs;
+	std::vector<std::exception_ptr> exceptions;
 	rootTable.GetKeys(keys);
 
 	// FeatureDef ID's start with 1
 	featureDefIDs.reserve(keys.size());
-	featureDefsVector.reserve(keys.size());
+	featureDefsVector.reserve(keys.size() + 1);
 	featureDefsVector.emplace_back();
 
+	defIDs.resize(keys.size(), 0);
+	exceptions.resize(keys.size());
+
+	{
+		// IDs follow the key order; of several keys differing only in case the first one wins
+		spring::unordered_set<std::string> names;
+
+		names.reserve(keys.size());
+
+		for (unsigned int i = 0; i < keys.size(); i++) {
+			if (!names.insert(StringToLower(keys[i])).second)
+				continue;
+
+			defIDs[i] = GetNewFeatureDef().id;
+		}
+	}
+
+	for_mt(0, keys.size(), [&](const int i) {
+		if (defIDs[i] == 0)
+			return;
+
+		try {
+			ParseFeatureDef(featureDefsVector[defIDs[i]], rootTable.SubTable(keys[i]), StringToLower(keys[i]));
+		} catch (...) {
+			exceptions[i] = std::current_exception();
+		}
+	});
+
 	for (unsigned int i = 0; i < keys.size(); i++) {
-		const std::string& nameMixedCase = keys[i];
-		const std::string& nameLowerCase = StringToLower(nameMixedCase);
-		const LuaTable& fdTable = rootTable.SubTable(nameMixedCase);
+		if (exceptions[i] != nullptr)
+			std::rethrow_exception(exceptions[i]);
+
+		if (defIDs[i] == 0)
+			continue;
 
-		AddFeatureDef(nameLowerCase, CreateFeatureDef(fdTable, nameLowerCase), false);
+		AddFeatureDef(StringToLower(keys[i]), &featureDefsVector[defIDs[i]], false);
 	}
+
 	for (unsigned int i = 0; i < keys.size(); i++) {
 		const std::string& nameMixedCase = keys[i];
 		const std::string& nameLowerCase = StringToLower(nameMixedCase);
@@ -80,15 +118,8 @@ FeatureDef& CFeatureDefHandler::GetNewFeatureDef()
 }
 
 
-FeatureDef* CFeatureDefHandler::CreateFeatureDef(const LuaTable& fdTable, const std::string& mixedCase)
+void CFeatureDefHandler::ParseFeatureDef(FeatureDef& fd, const LuaTable& fdTable, const std::string& name)
 {
-	const std::string& name = StringToLower(mixedCase);
-
-	if (featureDefIDs.find(name) != featureDefIDs.end())
-		return nullptr;
-
-	FeatureDef& fd = GetNewFeatureDef();
-
 	fd.name = name;
 	fd.description = fdTable.GetString("description", "");
 
@@ -142,8 +173,6 @@ FeatureDef* CFeatureDefHandler::CreateFeatureDef(const LuaTable& fdTable, const
 
 	// custom parameters table
 	fdTable.SubTable("customParams").GetMap(fd.customParams);
-
-	return &fd;
 }
 
 
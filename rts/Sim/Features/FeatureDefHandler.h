@@ -48,7 +48,8 @@ private:
 
 	FeatureDef* CreateDefaultTreeFeatureDef(const std::string& name);
 	FeatureDef* CreateDefaultGeoFeatureDef(const std::string& name);
-	FeatureDef* CreateFeatureDef(const LuaTable& luaTable, const std::string& name);
+	/// fills in everything but the ID, safe to call for different defs in parallel
+	static void ParseFeatureDef(FeatureDef& fd, const LuaTable& fdTable, const std::string& name);
 
 	FeatureDef& GetNewFeatureDef();
 
@@ -2,6 +2,7 @@
 
 #include "CollisionHandler.h"
 #include "CollisionVolume.h"
+#include "CollisionVolumeBatch.h"
 #include "Map/ReadMap.h" // mapDims
 #include "Rendering/Models/3DModel.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
@@ -13,6 +14,17 @@
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
 
+// scratch space for the batched tests
+static struct PieceBatch {
+	CCollisionVolumeBatch volumes;
+	std::vector<const LocalModelPiece*> pieces;
+} pieceBatch;
+
+static struct ObjectBatch {
+	CCollisionVolumeBatch volumes;
+	std::vector<int> volumeIndices;
+} objectBatch;
+
 
 
 void CCollisionHandler::PrintStats()
@@ -72,6 +84,65 @@ bool CCollisionHandler::DetectHit(
 
 
 
+int CCollisionHandler::DetectFirstHit(
+	const CSolidObject* const* objs,
+	const CMatrix44f* mats,
+	unsigned int numObjs,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cq
+) {
+	CCollisionVolumeBatch& volumes = objectBatch.volumes;
+
+	volumes.Reset();
+	objectBatch.volumeIndices.assign(numObjs, -1);
+
+	// plain continuous volumes can be tested together, everything else takes the regular path
+	for (unsigned int n = 0; n < numObjs; n++) {
+		const CSolidObject* o = objs[n];
+		const CollisionVolume* v = &o->collisionVolume;
+
+		if (o->IsInVoid() || v->DefaultToPieceTree() || v->IgnoreHits() || !v->UseContHitTest())
+			continue;
+
+		// same as Intersect(o, v, mats[n], ...)
+		CMatrix44f mr = mats[n];
+
+		mr.Translate(o->relMidPos);
+		mr.Translate(v->GetOffsets());
+
+		objectBatch.volumeIndices[n] = volumes.AddVolume(mr, v->GetHScales());
+	}
+
+	volumes.Transform(p0, p1);
+
+	numContTests += volumes.GetNumVolumes();
+
+	for (unsigned int n = 0; n < numObjs; n++) {
+		const int idx = objectBatch.volumeIndices[n];
+
+		if (idx < 0) {
+			if (CCollisionHandler::DetectHit(objs[n], mats[n], p0, p1, cq))
+				return n;
+
+			continue;
+		}
+
+		if (cq != nullptr)
+			cq->Reset();
+
+		if (!volumes.CanHit(idx))
+			continue;
+
+		if (CCollisionHandler::IntersectVolumeSpace(&objs[n]->collisionVolume, volumes.GetMatrix(idx), volumes.GetVolumeSpacePos0(idx), volumes.GetVolumeSpacePos1(idx), cq))
+			return n;
+	}
+
+	return -1;
+}
+
+
+
 bool CCollisionHandler::Collision(
 	const CSolidObject* o,
 	const CollisionVolume* v,
@@ -258,11 +329,16 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	const float3& p1,
 	CollisionQuery* cq
 ) {
+	CCollisionVolumeBatch& volumes = pieceBatch.volumes;
+
 	CMatrix44f volMat;
 
 	float minDistSq = std::numeric_limits<float>::max();
 	float curDistSq = minDistSq;
 
+	volumes.Reset();
+	pieceBatch.pieces.clear();
+
 	for (unsigned int n = 0; n < o->localModel.pieces.size(); n++) {
 		const LocalModelPiece* lmp = o->localModel.GetPiece(n);
 		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
@@ -273,8 +349,24 @@ bool CCollisionHandler::IntersectPiecesHelper(
 		volMat = m * lmp->GetModelSpaceMatrix();
 		volMat.Translate(lmpVol->GetOffsets());
 
+		volumes.AddVolume(volMat, lmpVol->GetHScales());
+		pieceBatch.pieces.push_back(lmp);
+	}
+
+	// reject all pieces the segment passes by in one go
+	volumes.Transform(p0, p1);
+
+	numContTests += volumes.GetNumVolumes();
+
+	for (unsigned int n = 0; n < volumes.GetNumVolumes(); n++) {
+		if (!volumes.CanHit(n))
+			continue;
+
+		const LocalModelPiece* lmp = pieceBatch.pieces[n];
+		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
+
 		CollisionQuery cqn;
-		if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cqn))
+		if (!CCollisionHandler::IntersectVolumeSpace(lmpVol, volumes.GetMatrix(n), volumes.GetVolumeSpacePos0(n), volumes.GetVolumeSpacePos1(n), &cqn))
 			continue;
 
 		// skip if neither an ingress nor an egress hit
@@ -350,7 +442,6 @@ bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m,
 	const CMatrix44f mInv = m.InvertAffine();
 	const float3 pi0 = mInv.Mul(p0);
 	const float3 pi1 = mInv.Mul(p1);
-	bool intersect = false;
 
 	// minimum and maximum (x, y, z) coordinates of transformed ray
 	const float3 rmin = float3::min(pi0, pi1);
@@ -368,6 +459,13 @@ bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m,
 	if (rmax.z < vmin.z || rmin.z > vmax.z)
 		return false;
 
+	return (CCollisionHandler::IntersectVolumeSpace(v, m, pi0, pi1, q));
+}
+
+bool CCollisionHandler::IntersectVolumeSpace(const CollisionVolume* v, const CMatrix44f& m, const float3& pi0, const float3& pi1, CollisionQuery* q)
+{
+	bool intersect = false;
+
 	switch (v->GetVolumeType()) {
 		case CollisionVolume::COLVOL_TYPE_ELLIPSOID:
 		case CollisionVolume::COLVOL_TYPE_SPHERE: {
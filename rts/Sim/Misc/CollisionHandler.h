@@ -112,6 +112,20 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr,
 			bool forceTrace = false
 		);
+		/**
+		 * Equivalent to calling DetectHit(objs[n], mats[n], p0, p1, cq) for
+		 * n = 0, 1, ... until the first hit, but tests all objects with plain
+		 * continuous volumes at once (see CCollisionVolumeBatch).
+		 * @return index of the first object hit, or -1 if none was
+		 */
+		static int DetectFirstHit(
+			const CSolidObject* const* objs,
+			const CMatrix44f* mats,
+			unsigned int numObjs,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cq = nullptr
+		);
 		static bool MouseHit(
 			const CSolidObject* o,
 			const CMatrix44f& m,
@@ -159,6 +173,14 @@ class CCollisionHandler {
 		 * @param p1 end of ray (in world-coordinates)
 		 */
 		static bool Intersect(const CollisionVolume* v, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
+		/**
+		 * Narrow-phase part of Intersect for a segment already transformed
+		 * into volume-space whose bounding box test has passed.
+		 * @param m volumes transformation matrix (for the query)
+		 * @param pi0 start of ray (in volume-coordinates)
+		 * @param pi1 end of ray (in volume-coordinates)
+		 */
+		static bool IntersectVolumeSpace(const CollisionVolume* v, const CMatrix44f& m, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectPieceTree(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
 		static bool IntersectPiecesHelper(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cqp);
 
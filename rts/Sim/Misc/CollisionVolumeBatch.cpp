@@ -0,0 +1,94 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CollisionVolumeBatch.h"
+#include "System/MainDefines.h"
+
+#include <algorithm>
+#include <xmmintrin.h>
+
+
+unsigned int CCollisionVolumeBatch::AddVolume(const CMatrix44f& volMat, const float3& hScales)
+{
+	const unsigned int idx = matrices.size();
+	const unsigned int lane = idx & 3;
+
+	if (lane == 0)
+		blocks.emplace_back();
+
+	// invert exactly like Intersect does, only the products are vectorized
+	const CMatrix44f invMat = volMat.InvertAffine();
+
+	VolumeBlock& block = blocks.back();
+
+	for (unsigned int col = 0; col < 4; col++) {
+		for (unsigned int row = 0; row < 3; row++) {
+			block.invMat[col * 3 + row][lane] = invMat[col * 4 + row];
+		}
+	}
+
+	block.hScales[0][lane] = hScales.x;
+	block.hScales[1][lane] = hScales.y;
+	block.hScales[2][lane] = hScales.z;
+
+	matrices.push_back(volMat);
+	return idx;
+}
+
+
+__FORCE_ALIGN_STACK__
+unsigned int CCollisionVolumeBatch::Transform(const float3& p0, const float3& p1)
+{
+	const __m128 zero = _mm_setzero_ps();
+
+	const __m128 p0x = _mm_set1_ps(p0.x), p0y = _mm_set1_ps(p0.y), p0z = _mm_set1_ps(p0.z);
+	const __m128 p1x = _mm_set1_ps(p1.x), p1y = _mm_set1_ps(p1.y), p1z = _mm_set1_ps(p1.z);
+
+	unsigned int numHits = 0;
+
+	for (unsigned int n = 0; n < blocks.size(); n++) {
+		VolumeBlock& block = blocks[n];
+
+		// lanes past the last volume hold zero-matrices, never report those
+		const unsigned int numLanes = std::min(matrices.size() - n * 4, size_t(4));
+
+		__m128 miss = zero;
+
+		for (unsigned int row = 0; row < 3; row++) {
+			const __m128 c0 = _mm_loadu_ps(block.invMat[    row]);
+			const __m128 c1 = _mm_loadu_ps(block.invMat[3 + row]);
+			const __m128 c2 = _mm_loadu_ps(block.invMat[6 + row]);
+			const __m128 c3 = _mm_loadu_ps(block.invMat[9 + row]);
+
+			// same accumulation order as CMatrix44f::operator*(float4), w=1
+			__m128 pi0 =                 _mm_mul_ps(c0, p0x) ;
+			       pi0 = _mm_add_ps(pi0, _mm_mul_ps(c1, p0y));
+			       pi0 = _mm_add_ps(pi0, _mm_mul_ps(c2, p0z));
+			       pi0 = _mm_add_ps(pi0, c3);
+			__m128 pi1 =                 _mm_mul_ps(c0, p1x) ;
+			       pi1 = _mm_add_ps(pi1, _mm_mul_ps(c1, p1y));
+			       pi1 = _mm_add_ps(pi1, _mm_mul_ps(c2, p1z));
+			       pi1 = _mm_add_ps(pi1, c3);
+
+			_mm_storeu_ps(block.pos0[row], pi0);
+			_mm_storeu_ps(block.pos1[row], pi1);
+
+			// operands swapped to match std::{min,max}(pi0, pi1) as used by float3::{min,max}
+			const __m128 rmin = _mm_min_ps(pi1, pi0);
+			const __m128 rmax = _mm_max_ps(pi1, pi0);
+			const __m128 vmax = _mm_loadu_ps(block.hScales[row]);
+			const __m128 vmin = _mm_sub_ps(zero, vmax);
+
+			miss = _mm_or_ps(miss, _mm_cmplt_ps(rmax, vmin));
+			miss = _mm_or_ps(miss, _mm_cmpgt_ps(rmin, vmax));
+		}
+
+		block.hitMask = (~_mm_movemask_ps(miss)) & ((1 << numLanes) - 1);
+
+		numHits += ((block.hitMask >> 0) & 1);
+		numHits += ((block.hitMask >> 1) & 1);
+		numHits += ((block.hitMask >> 2) & 1);
+		numHits += ((block.hitMask >> 3) & 1);
+	}
+
+	return numHits;
+}
@@ -0,0 +1,66 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COLLISION_VOLUME_BATCH_H
+#define COLLISION_VOLUME_BATCH_H
+
+#include <vector>
+
+#include "System/float3.h"
+#include "System/Matrix44f.h"
+
+/**
+ * Moves one ray-segment into the spaces of many collision volumes at once
+ * (four volumes per SSE instruction) and rejects every volume whose bounding
+ * box the segment misses, which is the common case for projectiles passing
+ * by multi-piece models.
+ *
+ * The volume-space points are computed with the same operations in the same
+ * order as CMatrix44f::Mul on the inverted volume matrix, so they and hence
+ * all hit results derived from them are bit-identical to testing the volumes
+ * one at a time with CCollisionHandler::Intersect.
+ */
+class CCollisionVolumeBatch {
+public:
+	void Reset() {
+		matrices.clear();
+		blocks.clear();
+	}
+
+	/// @param hScales half-length axis scales of the volume (CollisionVolume::GetHScales)
+	/// @return index of the volume within the batch
+	unsigned int AddVolume(const CMatrix44f& volMat, const float3& hScales);
+
+	/// @return number of volumes whose bounding box the segment <p0, p1> intersects
+	unsigned int Transform(const float3& p0, const float3& p1);
+
+	unsigned int GetNumVolumes() const { return matrices.size(); }
+
+	/// only valid after Transform
+	bool CanHit(unsigned int i) const { return ((blocks[i >> 2].hitMask & (1 << (i & 3))) != 0); }
+
+	/// segment end-points in the space of volume <i>, only valid after Transform
+	float3 GetVolumeSpacePos0(unsigned int i) const { return (blocks[i >> 2].GetPos(blocks[i >> 2].pos0, i & 3)); }
+	float3 GetVolumeSpacePos1(unsigned int i) const { return (blocks[i >> 2].GetPos(blocks[i >> 2].pos1, i & 3)); }
+
+	const CMatrix44f& GetMatrix(unsigned int i) const { return matrices[i]; }
+
+private:
+	// four volumes in SoA layout, [component][lane]
+	struct VolumeBlock {
+		float3 GetPos(const float (&pos)[3][4], unsigned int lane) const { return {pos[0][lane], pos[1][lane], pos[2][lane]}; }
+
+		// upper 4x3 part of the inverse volume matrices
+		float invMat[12][4];
+		float hScales[3][4];
+
+		float pos0[3][4];
+		float pos1[3][4];
+
+		int hitMask;
+	};
+
+	std::vector<CMatrix44f> matrices;
+	std::vector<VolumeBlock> blocks;
+};
+
+#endif // COLLISION_VOLUME_BATCH_H
@@ -96,8 +96,13 @@ class DynDamageArray : public DamageArray
 public:
 	DynDamageArray(float damage = 1.0f);
 	DynDamageArray(const DynDamageArray& da) { *this = da; fromDef = false; refCount = 1; }
+	// moving keeps fromDef, defs are parsed elsewhere and moved into place
+	DynDamageArray(DynDamageArray&& da) = default;
 	~DynDamageArray();
 
+	DynDamageArray& operator = (const DynDamageArray& da) = default;
+	DynDamageArray& operator = (DynDamageArray&& da) = default;
+
 	void PostLoad();
 
 	DamageArray GetDynamicDamages(const float3& startPos, const float3& curPos) const;
@@ -18,6 +18,9 @@ using std::cout;
 	LOG_L(L_ERROR, "%s:%d: " fmt, (data)->GetDeclarationFile().Get().c_str(), (data)->GetDeclarationLine().Get(), ## __VA_ARGS__) \
 
 
+thread_local const LuaTable* DefType::luaTable = nullptr;
+
+
 DefType::DefType(const char* n): name(n) {
 	metaDataMem.fill(0);
 	defInitFuncs.fill(nullptr);
@@ -267,7 +267,9 @@ private:
 	unsigned int metaDataMemIdx = 0;
 
 	const char* name = nullptr;
-	const LuaTable* luaTable = nullptr;
+
+	// table passed to the Load call running on this thread (defs are loaded in parallel)
+	static thread_local const LuaTable* luaTable;
 
 private:
 	static std::vector<const DefType*>& GetTypes() {
@@ -0,0 +1,179 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <limits>
+
+#include "InterceptGrid.h"
+#include "System/SpringMath.h"
+
+
+// absorbs differences in rounding between the footprints and the
+// (3D) distance tests of CInterceptHandler, which must never miss
+static constexpr float ROUNDING_MARGIN = 1.0f;
+
+
+static float SqDistanceToSegment2D(const float3& p, const float3& a, const float3& b)
+{
+	const float dx = b.x - a.x;
+	const float dz = b.z - a.z;
+	const float sqLen = dx * dx + dz * dz;
+
+	float t = 0.0f;
+
+	if (sqLen > 0.0f)
+		t = Clamp(((p.x - a.x) * dx + (p.z - a.z) * dz) / sqLen, 0.0f, 1.0f);
+
+	return (Square(a.x + dx * t - p.x) + Square(a.z + dz * t - p.z));
+}
+
+
+
+void CInterceptGrid::Init(float sizeX, float sizeZ, float cellSize_)
+{
+	cellSize = cellSize_;
+
+	numCellsX = std::max(1, int(math::ceil(sizeX / cellSize)));
+	numCellsZ = std::max(1, int(math::ceil(sizeZ / cellSize)));
+
+	cells.resize(numCellsX * numCellsZ);
+
+	Clear();
+}
+
+void CInterceptGrid::Clear()
+{
+	for (std::vector<int>& cell: cells) {
+		cell.clear();
+	}
+
+	footprints.clear();
+	queryNums.clear();
+
+	queryNum = 0;
+}
+
+
+// positions outside the map fall into the border cells
+int CInterceptGrid::GetCellX(float x) const { return Clamp(int(x / cellSize), 0, numCellsX - 1); }
+int CInterceptGrid::GetCellZ(float z) const { return Clamp(int(z / cellSize), 0, numCellsZ - 1); }
+
+
+int CInterceptGrid::AddObject(const float3& p0, const float3& p1, const float3& q)
+{
+	const int idx = footprints.size();
+
+	footprints.push_back({p0, p1, q});
+	queryNums.push_back(queryNum);
+
+	const float minX = std::min(p0.x, p1.x);
+	const float maxX = std::max(p0.x, p1.x);
+	const float minZ = std::min(p0.z, p1.z);
+	const float maxZ = std::max(p0.z, p1.z);
+
+	const int cz1 = GetCellZ(minZ - ROUNDING_MARGIN);
+	const int cz2 = GetCellZ(maxZ + ROUNDING_MARGIN);
+
+	// rasterize the segment row by row; each row covers
+	// the x-range the segment spans within its z-range
+	for (int cz = cz1; cz <= cz2; cz++) {
+		float xa = minX;
+		float xb = maxX;
+
+		if (p0.z != p1.z) {
+			// the first and last rows also cover any part beyond the map
+			const float za = (cz == cz1)? minZ: Clamp(cz * cellSize - ROUNDING_MARGIN, minZ, maxZ);
+			const float zb = (cz == cz2)? maxZ: Clamp((cz + 1) * cellSize + ROUNDING_MARGIN, minZ, maxZ);
+			const float slope = (p1.x - p0.x) / (p1.z - p0.z);
+
+			xa = Clamp(p0.x + (za - p0.z) * slope, minX, maxX);
+			xb = Clamp(p0.x + (zb - p0.z) * slope, minX, maxX);
+		}
+
+		const int cx1 = GetCellX(std::min(xa, xb) - ROUNDING_MARGIN);
+		const int cx2 = GetCellX(std::max(xa, xb) + ROUNDING_MARGIN);
+
+		for (int cx = cx1; cx <= cx2; cx++) {
+			cells[cz * numCellsX + cx].push_back(idx);
+		}
+	}
+
+	std::vector<int>& targetCell = cells[GetCellZ(q.z) * numCellsX + GetCellX(q.x)];
+
+	// skip the target if its cell is already covered by the segment
+	if (targetCell.empty() || targetCell.back() != idx)
+		targetCell.push_back(idx);
+
+	return idx;
+}
+
+
+void CInterceptGrid::GetObjects(const float3& pos, float radius, std::vector<int>& objects)
+{
+	objects.clear();
+
+	if (radius <= 0.0f)
+		return;
+
+	queryNum += 1;
+
+	const float maxDist = radius + ROUNDING_MARGIN;
+	const float sqMaxDist = maxDist * maxDist;
+
+	const int cx1 = GetCellX(pos.x - maxDist);
+	const int cx2 = GetCellX(pos.x + maxDist);
+	const int cz1 = GetCellZ(pos.z - maxDist);
+	const int cz2 = GetCellZ(pos.z + maxDist);
+
+	for (int cz = cz1; cz <= cz2; cz++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			for (const int idx: cells[cz * numCellsX + cx]) {
+				if (queryNums[idx] == queryNum)
+					continue;
+
+				queryNums[idx] = queryNum;
+
+				const Footprint& fp = footprints[idx];
+
+				if (fp.q.SqDistance2D(pos) >= sqMaxDist && SqDistanceToSegment2D(pos, fp.p0, fp.p1) >= sqMaxDist)
+					continue;
+
+				objects.push_back(idx);
+			}
+		}
+	}
+
+	std::sort(objects.begin(), objects.end());
+}
+
+
+float CInterceptGrid::GetTrajectoryLength(const float3& pos, const float3& dir, float minHeight, float sizeX, float sizeZ)
+{
+	float enterDist = 0.0f;
+	float exitDist = std::numeric_limits<float>::max();
+
+	// distances along the ray at which it enters and leaves the map
+	if (dir.x != 0.0f) {
+		const float tx0 = (0.0f  - pos.x) / dir.x;
+		const float tx1 = (sizeX - pos.x) / dir.x;
+
+		enterDist = std::max(enterDist, std::min(tx0, tx1));
+		exitDist = std::min(exitDist, std::max(tx0, tx1));
+	}
+	if (dir.z != 0.0f) {
+		const float tz0 = (0.0f  - pos.z) / dir.z;
+		const float tz1 = (sizeZ - pos.z) / dir.z;
+
+		enterDist = std::max(enterDist, std::min(tz0, tz1));
+		exitDist = std::min(exitDist, std::max(tz0, tz1));
+	}
+
+	// the ground inside the map is nowhere lower than minHeight
+	if (dir.y < 0.0f)
+		exitDist = std::min(exitDist, std::max(enterDist, (pos.y - minHeight) / -dir.y));
+
+	// a vertical ray that never descends has a point-footprint, any length will do
+	if (exitDist == std::numeric_limits<float>::max())
+		return 0.0f;
+
+	return std::max(exitDist, 0.0f);
+}
@@ -0,0 +1,65 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef INTERCEPT_GRID_H
+#define INTERCEPT_GRID_H
+
+#include <vector>
+
+#include "System/float3.h"
+
+/**
+ * Coarse 2D grid over the trajectory footprints of interceptable projectiles
+ * so that each interceptor only has to look at the projectiles that can come
+ * within its coverage range, instead of at all of them.
+ *
+ * A footprint is the ground-projected segment a projectile may still travel
+ * along (see GetTrajectoryLength) plus the position it is targeting; objects
+ * are identified by the order they were added in.
+ */
+class CInterceptGrid {
+public:
+	void Init(float sizeX, float sizeZ, float cellSize);
+	void Clear();
+
+	/// @return index of the object, its footprint is <p0, p1> and <q> (ignoring y)
+	int AddObject(const float3& p0, const float3& p1, const float3& q);
+
+	/**
+	 * Collects (in ascending order) the indices of all objects whose footprint
+	 * comes within <radius> (in 2D) of <pos>, plus a small rounding margin.
+	 */
+	void GetObjects(const float3& pos, float radius, std::vector<int>& objects);
+
+	int GetNumObjects() const { return footprints.size(); }
+
+	/**
+	 * Upper bound on the distance along <dir> at which CGround::LineGroundCol
+	 * can report a ground hit for a ray starting at <pos>: the ray has to be
+	 * inside the map (of size <sizeX, sizeZ>) for a hit and will have hit
+	 * once it descends below <minHeight> there.
+	 */
+	static float GetTrajectoryLength(const float3& pos, const float3& dir, float minHeight, float sizeX, float sizeZ);
+
+private:
+	struct Footprint {
+		float3 p0;
+		float3 p1;
+		float3 q;
+	};
+
+	int GetCellX(float x) const;
+	int GetCellZ(float z) const;
+
+	float cellSize = 1.0f;
+
+	int numCellsX = 0;
+	int numCellsZ = 0;
+	int queryNum = 0;
+
+	std::vector<Footprint> footprints;
+	// last query each object was returned by
+	std::vector<int> queryNums;
+	std::vector< std::vector<int> > cells;
+};
+
+#endif // INTERCEPT_GRID_H
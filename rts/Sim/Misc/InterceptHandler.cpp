@@ -6,6 +6,7 @@
 #include "InterceptHandler.h"
 
 #include "Map/Ground.h"
+#include "Map/ReadMap.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Weapons/Weapon.h"
@@ -21,16 +22,38 @@
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(interceptables)
+	CR_MEMBER(interceptables),
+	CR_IGNORED(interceptablesGrid),
+	CR_IGNORED(candidateIndices)
 ))
 
 CInterceptHandler interceptHandler;
 
+static constexpr float INTERCEPT_GRID_CELL_SIZE = SQUARE_SIZE * 64.0f;
+
 
 
 void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
+	if (interceptors.empty())
+		return;
+
+	const float mapSizeX = mapDims.mapx * SQUARE_SIZE;
+	const float mapSizeZ = mapDims.mapy * SQUARE_SIZE;
+	const float minHeight = readMap->GetCurrMinHeight();
+
+	interceptablesGrid.Init(mapSizeX, mapSizeZ, INTERCEPT_GRID_CELL_SIZE);
+
+	// index everywhere each projectile could be intercepted; this covers
+	// its current and target positions and all positions that the tests
+	// below can project along its direction (up to where it leaves the
+	// map or has to have hit the ground)
+	for (const CWeaponProjectile* p: interceptables) {
+		const float trajLength = CInterceptGrid::GetTrajectoryLength(p->pos, p->dir, minHeight, mapSizeX, mapSizeZ);
+
+		interceptablesGrid.AddObject(p->pos - p->dir, p->pos + p->dir * trajLength, p->GetTargetPos());
+	}
 
 	for (CWeapon* w: interceptors) {
 		const WeaponDef* wDef = w->weaponDef;
@@ -38,7 +61,13 @@ void CInterceptHandler::Update(bool forced) {
 
 		assert(wDef->interceptor || wDef->isShield);
 
-		for (CWeaponProjectile* p: interceptables) {
+		// only projectiles that can come within coverage range in 2D
+		// can pass any of the tests, skip all others
+		interceptablesGrid.GetObjects(w->aimFromPos, wDef->coverageRange, candidateIndices);
+
+		for (const int candidateIdx: candidateIndices) {
+			CWeaponProjectile* p = interceptables[candidateIdx];
+
 			if (!p->CanBeInterceptedBy(wDef))
 				continue;
 			if (w->HasIncomingProjectile(p->id))
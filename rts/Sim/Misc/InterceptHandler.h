@@ -4,6 +4,9 @@
 #define INTERCEPT_HANDLER_H
 
 #include <deque>
+#include <vector>
+
+#include "InterceptGrid.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/Object.h"
 
@@ -29,6 +32,10 @@ public:
 private:
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
+
+	// rebuilt every Update, indices refer to <interceptables>
+	CInterceptGrid interceptablesGrid;
+	std::vector<int> candidateIndices;
 };
 
 extern CInterceptHandler interceptHandler;
@@ -30,7 +30,10 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+
+	CR_IGNORED(featureQuadVersions),
+	CR_IGNORED(featureQueryCache)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -121,6 +124,8 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 	invQuadSize = {1.0f / quadSizeX, 1.0f / quadSizeZ};
 
 	baseQuads.resize(numQuadsX * numQuadsZ);
+	featureQuadVersions.clear();
+	featureQuadVersions.resize(numQuadsX * numQuadsZ, 0);
 	tempQuads.ReserveAll(numQuadsX * numQuadsZ);
 	tempQuads.ReleaseAll();
 
@@ -144,6 +149,13 @@ void CQuadField::Kill()
 	tempProjectiles.ReleaseAll();
 	tempSolids.ReleaseAll();
 	tempQuads.ReleaseAll();
+
+	for (FeatureQueryCacheEntry& entry: featureQueryCache) {
+		entry.radius = -1.0f;
+		entry.lastFrame = -1;
+		entry.quads.clear();
+		entry.features.clear();
+	}
 }
 
 
@@ -455,6 +467,7 @@ void CQuadField::AddFeature(CFeature* feature)
 
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
+		featureQuadVersions[qi] += 1;
 	}
 }
 
@@ -465,6 +478,7 @@ void CQuadField::RemoveFeature(CFeature* feature)
 
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorErase(baseQuads[qi].features, feature);
+		featureQuadVersions[qi] += 1;
 	}
 
 	#ifdef DEBUG_QUADFIELD
@@ -665,6 +679,57 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 	return;
 }
 
+void CQuadField::GetFeaturesExactCached(QuadFieldQuery& qfq, const float3& pos, float radius)
+{
+	FeatureQueryCacheEntry* entry = &featureQueryCache[0];
+
+	bool cached = false;
+
+	for (FeatureQueryCacheEntry& e: featureQueryCache) {
+		// GetFeaturesExact only looks at the 2D position when not spherical
+		if (e.radius == radius && e.pos.x == pos.x && e.pos.z == pos.z) {
+			entry = &e;
+			cached = true;
+			break;
+		}
+
+		if (e.lastFrame < entry->lastFrame)
+			entry = &e;
+	}
+
+	entry->lastFrame = gs->frameNum;
+
+	// the contents (and order) of the quads are unchanged iff their versions are
+	if (cached && GetFeatureQuadsVersion(entry->quads) == entry->quadsVersion) {
+		qfq.features = tempFeatures.ReserveVector();
+		qfq.features->assign(entry->features.begin(), entry->features.end());
+		return;
+	}
+
+	GetFeaturesExact(qfq, pos, radius, false);
+
+	QuadFieldQuery qfQuery;
+	GetQuads(qfQuery, pos, radius);
+
+	entry->pos = pos;
+	entry->radius = radius;
+	entry->quadsVersion = GetFeatureQuadsVersion(*qfQuery.quads);
+	entry->quads.assign(qfQuery.quads->begin(), qfQuery.quads->end());
+	entry->features.assign(qfq.features->begin(), qfq.features->end());
+}
+
+unsigned int CQuadField::GetFeatureQuadsVersion(const std::vector<int>& quads) const
+{
+	// versions only ever increase, so the sum changes if any of them does
+	unsigned int version = 0;
+
+	for (const int qi: quads) {
+		version += featureQuadVersions[qi];
+	}
+
+	return version;
+}
+
 
 
 void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, float radius)
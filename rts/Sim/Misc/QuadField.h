@@ -131,6 +131,14 @@ public:
 	 * mins and maxs, which extends infinitely along the y-axis
 	 */
 	void GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
+	/**
+	 * Same as GetFeaturesExact(qfq, pos, radius, false), but reuses the result
+	 * of an earlier query for the same area for as long as no feature has been
+	 * added to or removed from (which includes moving between) any of its quads
+	 * since, so repeated area-searches (e.g. by builders) do not have to redo
+	 * the gathering and distance-tests every time
+	 */
+	void GetFeaturesExactCached(QuadFieldQuery& qfq, const float3& pos, float radius);
 
 	void GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, float radius);
 	void GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
@@ -235,9 +243,29 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	unsigned int GetFeatureQuadsVersion(const std::vector<int>& quads) const;
+
+private:
+	struct FeatureQueryCacheEntry {
+		float3 pos;
+		float radius = -1.0f;
+
+		int lastFrame = -1;
+		// sum of the versions of <quads> when <features> was gathered
+		unsigned int quadsVersion = 0;
+
+		std::vector<int> quads;
+		std::vector<CFeature*> features;
+	};
+
 private:
 	std::vector<Quad> baseQuads;
 
+	// bumped whenever a feature is added to or removed from the respective quad
+	std::vector<unsigned int> featureQuadVersions;
+	// results of GetFeaturesExactCached, least recently used ones get replaced
+	std::array<FeatureQueryCacheEntry, 32> featureQueryCache;
+
 	// preallocated vectors for Get*Exact functions
 	QueryVectorCache<CUnit*> tempUnits;
 	QueryVectorCache<CFeature*> tempFeatures;
@@ -1,23 +1,38 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <cassert>
-#include <limits>
 
 #include "SmoothHeightMesh.h"
 
-#include "Map/Ground.h"
-#include "Map/ReadMap.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/float3.h"
 #include "System/SpringMath.h"
-#include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
+#ifndef UNIT_TEST
+	#include "Map/Ground.h"
+	#include "Map/ReadMap.h"
+	#include "System/TimeProfiler.h"
+#endif
+
 
 
 SmoothHeightMesh smoothGround;
 
 
+#ifndef UNIT_TEST
+static float GetGroundHeight(float x, float z) { return (CGround::GetHeightAboveWater(x, z)); }
+static float GetMaxGroundHeight() { return (readMap->GetCurrMaxHeight()); }
+#else
+// provided by the test
+float GetGroundHeight(float x, float z);
+float GetMaxGroundHeight();
+#endif
+
+
 static float Interpolate(float x, float y, const int maxx, const int maxy, const float res, const float* heightmap)
 {
 	x = Clamp(x / res, 0.0f, maxx - 1.0f);
@@ -30,10 +45,12 @@ static float Interpolate(float x, float y, const int maxx, const int maxy, const
 	const int sxp1 = std::min(sx + 1, maxx - 1);
 	const int syp1 = std::min(sy + 1, maxy - 1);
 
-	const float& h1 = heightmap[sx   + sy   * maxx];
-	const float& h2 = heightmap[sxp1 + sy   * maxx];
-	const float& h3 = heightmap[sx   + syp1 * maxx];
-	const float& h4 = heightmap[sxp1 + syp1 * maxx];
+	const int lineSize = maxx + 1;
+
+	const float& h1 = heightmap[sx   + sy   * lineSize];
+	const float& h2 = heightmap[sxp1 + sy   * lineSize];
+	const float& h3 = heightmap[sx   + syp1 * lineSize];
+	const float& h4 = heightmap[sxp1 + syp1 * lineSize];
 
 	const float hi1 = mix(h1, h2, dx);
 	const float hi2 = mix(h3, h4, dx);
@@ -56,6 +73,8 @@ void SmoothHeightMesh::Kill() {
 
 	mesh.clear();
 	origMesh.clear();
+	groundHeights.clear();
+	modifiedCells.clear();
 }
 
 
@@ -76,319 +95,225 @@ float SmoothHeightMesh::GetHeightAboveWater(float x, float y)
 
 float SmoothHeightMesh::SetHeight(int index, float h)
 {
+	modifiedCells[index] = true;
 	return (mesh[index] = h);
 }
 
 float SmoothHeightMesh::AddHeight(int index, float h)
 {
+	modifiedCells[index] = true;
 	return (mesh[index] += h);
 }
 
 float SmoothHeightMesh::SetMaxHeight(int index, float h)
 {
+	modifiedCells[index] = true;
 	return (mesh[index] = std::max(h, mesh[index]));
 }
 
-
-
-inline static void FindMaximumColumnHeights(
-	const int maxx,
-	const int maxy,
-	const int winSize,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	// initialize the algorithm: find the maximum
-	// height per column and the corresponding row
-	for (int y = 0; y <= std::min(maxy, winSize); ++y) {
-		for (int x = 0; x <= maxx; ++x)  {
-			const float curx = x * resolution;
-			const float cury = y * resolution;
-			const float curh = CGround::GetHeightAboveWater(curx, cury);
-
-			if (curh > colsMaxima[x]) {
-				colsMaxima[x] = curh;
-				maximaRows[x] = y;
-			}
-		}
-	}
+float SmoothHeightMesh::RevertHeight(int index)
+{
+	modifiedCells[index] = false;
+	return (mesh[index] = origMesh[index]);
 }
 
-inline static void AdvanceMaximaRows(
-	const int y,
-	const int maxx,
-	const float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<int>& maximaRows
-) {
-	const float cury = y * resolution;
 
-	// try to advance rows if they're equal to current maximum but are further away
-	for (int x = 0; x <= maxx; ++x) {
-		if (maximaRows[x] == (y - 1)) {
-			const float curx = x * resolution;
-			const float curh = CGround::GetHeightAboveWater(curx, cury);
 
-			if (curh == colsMaxima[x]) {
-				maximaRows[x] = y;
-			}
+static constexpr int BLUR_SIZE = 3;
+static constexpr int NUM_BLURS = 3;
 
-			assert(curh <= colsMaxima[x]);
-		}
-	}
+static SRectangle GrowRect(const SRectangle& r, int dx, int dz, int maxx, int maxy)
+{
+	return {std::max(r.x1 - dx, 0), std::max(r.z1 - dz, 0), std::min(r.x2 + dx, maxx), std::min(r.z2 + dz, maxy)};
 }
 
 
 
-inline static void FindRadialMaximum(
-	int y,
-	int maxx,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<float>& mesh
+inline static void FindRadialMaxima(
+	const SRectangle& area,
+	const int maxx,
+	const int maxy,
+	const int winSize,
+	const std::vector<float>& groundHeights,
+	      std::vector<float>& colsMaxima,
+	      std::vector<float>& maxima
 ) {
-	const float cury = y * resolution;
-
-	for (int x = 0; x <= maxx; ++x) {
-		float maxRowHeight = -std::numeric_limits<float>::max();
+	const int lineSize = maxx + 1;
+	const int areaSizeX = area.x2 - area.x1 + 1;
 
-		// find current maximum within radius smoothRadius
-		// (in every column stack) along the current row
-		const int startx = std::max(x - winSize, 0);
-		const int endx = std::min(maxx, x + winSize);
+	// colsMaxima rows cover the columns [area.x1 - winSize, area.x2 + winSize]
+	const int colsSizeX = areaSizeX + winSize * 2;
+	const int colsStart = area.x1 - winSize;
+	const int colsX1 = std::max(colsStart, 0);
+	const int colsX2 = std::min(area.x2 + winSize, maxx);
 
-		for (int i = startx; i <= endx; ++i) {
-			assert(i >= 0);
-			assert(i <= maxx);
-			assert(CGround::GetHeightReal(i * resolution, cury) <= colsMaxima[i]);
+	for_mt(area.z1, area.z2 + 1, [&](const int y) {
+		float* colsMaxRow = &colsMaxima[(y - area.z1) * colsSizeX];
+		float* maxRow = &maxima[(y - area.z1) * areaSizeX];
 
-			maxRowHeight = std::max(colsMaxima[i], maxRowHeight);
-		}
+		const int y1 = std::max(y - winSize, 0);
+		const int y2 = std::min(y + winSize, maxy);
 
-#ifndef NDEBUG
-		const float curx = x * resolution;
-		assert(maxRowHeight <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-		assert(maxRowHeight >= CGround::GetHeightAboveWater(curx, cury));
+		// maximum height per column within the window rows
+		std::copy(&groundHeights[colsX1 + y1 * lineSize], &groundHeights[colsX2 + y1 * lineSize] + 1, &colsMaxRow[colsX1 - colsStart]);
 
-	#ifdef SMOOTHMESH_CORRECTNESS_CHECK
-		// naive algorithm
-		float maxRowHeightAlt = -std::numeric_limits<float>::max();
+		for (int wy = y1 + 1; wy <= y2; ++wy) {
+			const float* groundRow = &groundHeights[wy * lineSize];
 
-		for (float y1 = cury - smoothRadius; y1 <= cury + smoothRadius; y1 += resolution) {
-			for (float x1 = curx - smoothRadius; x1 <= curx + smoothRadius; x1 += resolution) {
-				maxRowHeightAlt = std::max(maxRowHeightAlt, CGround::GetHeightAboveWater(x1, y1));
+			for (int x = colsX1; x <= colsX2; ++x) {
+				colsMaxRow[x - colsStart] = std::max(colsMaxRow[x - colsStart], groundRow[x]);
 			}
 		}
 
-		assert(maxRowHeightAlt == maxRowHeight);
-	#endif
-#endif
-
-		mesh[x + y * maxx] = maxRowHeight;
-	}
-}
-
-
-
-inline static void FixRemainingMaxima(
-	const int y,
-	const int maxx,
-	const int maxy,
-	const int winSize,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	// fix remaining maximums after a pass
-	const int nextrow = y + winSize + 1;
-	const float nextrowy = nextrow * resolution;
-
-	for (int x = 0; x <= maxx; ++x) {
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - winSize); y1 <= std::min(maxy, y + winSize); ++y1) {
-			assert(CGround::GetHeightReal(x * resolution, y1 * resolution) <= colsMaxima[x]);
-		}
-#endif
-		const float curx = x * resolution;
-
-		if (maximaRows[x] <= (y - winSize)) {
-			// find a new maximum if the old one left the window
-			colsMaxima[x] = -std::numeric_limits<float>::max();
+		// windows are clipped at the map border, equivalent to repeating the border columns
+		std::fill(&colsMaxRow[0], &colsMaxRow[colsX1 - colsStart], colsMaxRow[colsX1 - colsStart]);
+		std::fill(&colsMaxRow[colsX2 - colsStart + 1], &colsMaxRow[0] + colsSizeX, colsMaxRow[colsX2 - colsStart]);
 
-			for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, nextrow); ++y1) {
-				const float h = CGround::GetHeightAboveWater(curx, y1 * resolution);
+		// maximum of the column maxima within the window columns
+		std::copy(&colsMaxRow[0], &colsMaxRow[0] + areaSizeX, maxRow);
 
-				if (h > colsMaxima[x]) {
-					colsMaxima[x] = h;
-					maximaRows[x] = y1;
-				} else if (colsMaxima[x] == h) {
-					// if equal, move as far down as possible
-					maximaRows[x] = y1;
-				}
-			}
-		} else if (nextrow <= maxy) {
-			// else, just check if a new maximum has entered the window
-			const float h = CGround::GetHeightAboveWater(curx, nextrowy);
-
-			if (h > colsMaxima[x]) {
-				colsMaxima[x] = h;
-				maximaRows[x] = nextrow;
+		for (int wx = 1; wx <= winSize * 2; ++wx) {
+			for (int x = 0; x < areaSizeX; ++x) {
+				maxRow[x] = std::max(maxRow[x], colsMaxRow[x + wx]);
 			}
 		}
-
-		assert(maximaRows[x] <= nextrow);
-		assert(maximaRows[x] >= y - winSize + 1);
-
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-			assert(colsMaxima[x] >= CGround::GetHeightReal(curx, y1 * resolution));
-		}
-#endif
-	}
+	});
 }
 
 
 
+inline static float BlurredHeight(float groundHeight, float smoothHeight, float maxHeight)
+{
+	return std::min(maxHeight, std::max(groundHeight, smoothHeight));
+}
+
+/**
+ * Box-blurs <mesh> into <smoothed> within <rect>; both are laid out like
+ * <area>, which must contain <rect> grown by BLUR_SIZE along the blur axis.
+ * Every value is summed in a fixed order regardless of <rect>, so partial
+ * and full passes agree exactly.
+ */
 inline static void BlurHorizontal(
+	const SRectangle& rect,
+	const SRectangle& area,
 	const int maxx,
-	const int maxy,
-	const int blurSize,
-	const float resolution,
+	const float maxHeight,
+	const std::vector<float>& groundHeights,
 	const std::vector<float>& mesh,
 	      std::vector<float>& smoothed
 ) {
-	const float n = 2.0f * blurSize + 1.0f;
+	const float n = 2.0f * BLUR_SIZE + 1.0f;
 	const float recipn = 1.0f / n;
 	const int lineSize = maxx + 1;
+	const int areaSizeX = area.x2 - area.x1 + 1;
 
-	for_mt(0, maxy+1, [&](const int y) {
-		float avg = 0.0f;
+	// non-border columns within rect
+	const int x1 = std::max(rect.x1, BLUR_SIZE + 1);
+	const int x2 = std::min(rect.x2, maxx - BLUR_SIZE);
 
-		for (int x = 0; x <= 2 * blurSize; ++x) {
-			avg += mesh[x + y * lineSize];
-		}
+	for_mt(rect.z1, rect.z2 + 1, [&](const int y) {
+		const float* meshRow = &mesh[(y - area.z1) * areaSizeX];
+		const float* groundRow = &groundHeights[y * lineSize];
+		float* smoothedRow = &smoothed[(y - area.z1) * areaSizeX];
 
-		for (int x = 0; x <= maxx; ++x) {
-			const int idx = x + y * lineSize;
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			if (x > BLUR_SIZE && x <= (maxx - BLUR_SIZE))
+				continue;
 
-			if (x <= blurSize || x > (maxx - blurSize)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
+			// map-border case
+			const int xstart = std::max(x - BLUR_SIZE, 0);
+			const int xend   = std::min(x + BLUR_SIZE, maxx);
 
-				const int xstart = std::max(x - blurSize, 0);
-				const int xend   = std::min(x + blurSize, maxx);
+			float sum = 0.0f;
 
-				for (int x1 = xstart; x1 <= xend; ++x1) {
-					smoothed[idx] += mesh[x1 + y * lineSize];
-				}
-
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (xend - xstart + 1);
+			for (int x1 = xstart; x1 <= xend; ++x1) {
+				sum += meshRow[x1 - area.x1];
+			}
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[idx + blurSize] - mesh[idx - blurSize - 1];
+			smoothedRow[x - area.x1] = BlurredHeight(groundRow[x], sum / (xend - xstart + 1), maxHeight);
+		}
 
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
+		if (x1 > x2)
+			return;
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
+		// non-border case, one tap at a time across the row
+		for (int x = x1; x <= x2; ++x) {
+			smoothedRow[x - area.x1] = meshRow[x - area.x1 - BLUR_SIZE];
+		}
+		for (int k = -BLUR_SIZE + 1; k <= BLUR_SIZE; ++k) {
+			for (int x = x1; x <= x2; ++x) {
+				smoothedRow[x - area.x1] += meshRow[x - area.x1 + k];
 			}
-
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
+		}
+		for (int x = x1; x <= x2; ++x) {
+			smoothedRow[x - area.x1] = BlurredHeight(groundRow[x], recipn * smoothedRow[x - area.x1], maxHeight);
 		}
 	});
 }
 
 inline static void BlurVertical(
+	const SRectangle& rect,
+	const SRectangle& area,
 	const int maxx,
 	const int maxy,
-	const int blurSize,
-	const float resolution,
+	const float maxHeight,
+	const std::vector<float>& groundHeights,
 	const std::vector<float>& mesh,
 	      std::vector<float>& smoothed
 ) {
-	const float n = 2.0f * blurSize + 1.0f;
+	const float n = 2.0f * BLUR_SIZE + 1.0f;
 	const float recipn = 1.0f / n;
 	const int lineSize = maxx + 1;
+	const int areaSizeX = area.x2 - area.x1 + 1;
 
-	for_mt(0, maxx+1, [&](const int x) {
-		float avg = 0.0f;
+	for_mt(rect.z1, rect.z2 + 1, [&](const int y) {
+		const float* groundRow = &groundHeights[y * lineSize];
+		float* smoothedRow = &smoothed[(y - area.z1) * areaSizeX];
 
-		for (int y = 0; y <= 2 * blurSize; ++y) {
-			avg += mesh[x + y * lineSize];
-		}
-
-		for (int y = 0; y <= maxy; ++y) {
-			const int idx = x + y * lineSize;
+		if (y <= BLUR_SIZE || y > (maxy - BLUR_SIZE)) {
+			// map-border case
+			const int ystart = std::max(y - BLUR_SIZE, 0);
+			const int yend   = std::min(y + BLUR_SIZE, maxy);
 
-			if (y <= blurSize || y > (maxy - blurSize)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
-
-				const int ystart = std::max(y - blurSize, 0);
-				const int yend   = std::min(y + blurSize, maxy);
+			for (int x = rect.x1; x <= rect.x2; ++x) {
+				float sum = 0.0f;
 
 				for (int y1 = ystart; y1 <= yend; ++y1) {
-					smoothed[idx] += mesh[x + y1 * lineSize];
+					sum += mesh[(x - area.x1) + (y1 - area.z1) * areaSizeX];
 				}
 
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (yend - ystart + 1);
-
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[x + (y + blurSize) * lineSize] - mesh[x + (y - blurSize - 1) * lineSize];
-
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
-
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
+				smoothedRow[x - area.x1] = BlurredHeight(groundRow[x], sum / (yend - ystart + 1), maxHeight);
 			}
 
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
+			return;
 		}
-	});
-}
 
+		// non-border case, one tap-row at a time
+		const float* meshRow = &mesh[(y - area.z1 - BLUR_SIZE) * areaSizeX];
 
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			smoothedRow[x - area.x1] = meshRow[x - area.x1];
+		}
+		for (int k = -BLUR_SIZE + 1; k <= BLUR_SIZE; ++k) {
+			meshRow = &mesh[(y - area.z1 + k) * areaSizeX];
 
-inline static void CheckInvariants(
-	int y,
-	int maxx,
-	int maxy,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	const std::vector<int>& maximaRows
-) {
-	// check invariants
-	if (y < maxy) {
-		for (int x = 0; x <= maxx; ++x) {
-			assert(maximaRows[x] > y - winSize);
-			assert(maximaRows[x] <= maxy);
-			assert(colsMaxima[x] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(colsMaxima[x] >=          readMap->GetCurrMinHeight()       );
+			for (int x = rect.x1; x <= rect.x2; ++x) {
+				smoothedRow[x - area.x1] += meshRow[x - area.x1];
+			}
 		}
-	}
-	for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-		for (int x1 = 0; x1 <= maxx; ++x1) {
-			assert(CGround::GetHeightReal(x1 * resolution, y1 * resolution) <= colsMaxima[x1]);
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			smoothedRow[x - area.x1] = BlurredHeight(groundRow[x], recipn * smoothedRow[x - area.x1], maxHeight);
 		}
-	}
+	});
 }
 
 
 
 void SmoothHeightMesh::MakeSmoothMesh()
 {
+#ifndef UNIT_TEST
 	ScopedOnceTimer timer("SmoothHeightMesh::MakeSmoothMesh");
+#endif
 
 	// info:
 	//   height-value array has size <maxx + 1> * <maxy + 1>
@@ -398,43 +323,116 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	//   row-width (number of height-value corners per row) is (maxx + 1)
 	//   col-height (number of height-value corners per col) is (maxy + 1)
 	//
-	//   1st row has indices [maxx*(  0) + (  0), maxx*(1) + (  0)] inclusive
-	//   2nd row has indices [maxx*(  1) + (  1), maxx*(2) + (  1)] inclusive
-	//   3rd row has indices [maxx*(  2) + (  2), maxx*(3) + (  2)] inclusive
+	//   1st row has indices [(maxx+1)*(  0), (maxx+1)*(1) - 1] inclusive
+	//   2nd row has indices [(maxx+1)*(  1), (maxx+1)*(2) - 1] inclusive
 	//   ...
-	//   Nth row has indices [maxx*(N-1) + (N-1), maxx*(N) + (N-1)] inclusive
-	//
-	// use sliding window of maximums to reduce computational complexity
-	const     int winSize = smoothRadius / resolution;
-	constexpr int blurSize = 3;
-
+	//   Nth row has indices [(maxx+1)*(N-1), (maxx+1)*(N) - 1] inclusive
 	assert(mesh.empty());
 	mesh.resize((maxx + 1) * (maxy + 1), 0.0f);
 	origMesh.resize((maxx + 1) * (maxy + 1), 0.0f);
+	groundHeights.resize((maxx + 1) * (maxy + 1), 0.0f);
+	modifiedCells.resize((maxx + 1) * (maxy + 1), false);
 
-	colsMaxima.clear();
-	colsMaxima.resize(maxx + 1, -std::numeric_limits<float>::max());
-	maximaRows.clear();
-	maximaRows.resize(maxx + 1, -1);
+	const SRectangle fullRect = {0, 0, maxx, maxy};
 
-	FindMaximumColumnHeights(maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
+	UpdateGroundHeights(fullRect);
+	SmoothArea(fullRect);
+}
 
-	for (int y = 0; y <= maxy; ++y) {
-		AdvanceMaximaRows(y, maxx, resolution, colsMaxima, maximaRows);
-		FindRadialMaximum(y, maxx, winSize, resolution, colsMaxima, mesh);
-		FixRemainingMaxima(y, maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
+void SmoothHeightMesh::MapChanged(int x1, int z1, int x2, int z2)
+{
+	if (mesh.empty())
+		return;
 
-#ifdef _DEBUG
-		CheckInvariants(y, maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
-#endif
+	// mesh vertices sampling the ground anywhere within the squares around the changed corners
+	const float scale = SQUARE_SIZE / resolution;
+	const SRectangle groundRect = {
+		std::max(int(math::floor((x1 - 1) * scale)), 0),
+		std::max(int(math::floor((z1 - 1) * scale)), 0),
+		std::min(int(math::ceil ((x2 + 1) * scale)), maxx),
+		std::min(int(math::ceil ((z2 + 1) * scale)), maxy),
+	};
+
+	if (groundRect.x1 > groundRect.x2 || groundRect.z1 > groundRect.z2)
+		return;
+
+	UpdateGroundHeights(groundRect);
+
+	// every vertex whose maximum-window or blur-kernels reach into groundRect
+	const int reach = int(smoothRadius / resolution) + NUM_BLURS * BLUR_SIZE;
+
+	SmoothArea(GrowRect(groundRect, reach, reach, maxx, maxy));
+}
+
+
+void SmoothHeightMesh::UpdateGroundHeights(const SRectangle& rect)
+{
+	const int lineSize = maxx + 1;
+
+	for_mt(rect.z1, rect.z2 + 1, [&](const int y) {
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			groundHeights[x + y * lineSize] = GetGroundHeight(x * resolution, y * resolution);
+		}
+	});
+}
+
+void SmoothHeightMesh::SmoothArea(const SRectangle& rect)
+{
+	// the maximum-window is exact, so unlike a sliding window
+	// it can be (re)computed for any part of the mesh in isolation
+	const int winSize = smoothRadius / resolution;
+	const int lineSize = maxx + 1;
+	const float maxHeight = GetMaxGroundHeight();
+
+	// region each pass has to produce, working back from the final
+	// one; pass 0 finds the maxima, odd passes blur horizontally and
+	// even passes vertically
+	std::array<SRectangle, NUM_BLURS * 2 + 1> passRects;
+
+	passRects[NUM_BLURS * 2] = rect;
+
+	for (int pass = NUM_BLURS * 2; pass > 0; --pass) {
+		const bool horizontal = ((pass & 1) != 0);
+		passRects[pass - 1] = GrowRect(passRects[pass], BLUR_SIZE * horizontal, BLUR_SIZE * (!horizontal), maxx, maxy);
 	}
 
+	// all scratch buffers are laid out like the largest region
+	const SRectangle& area = passRects[0];
+	const int areaSizeX = area.x2 - area.x1 + 1;
+	const int areaSizeY = area.z2 - area.z1 + 1;
+
+	colsMaxima.resize((areaSizeX + winSize * 2) * areaSizeY);
+	tempMeshes[0].resize(areaSizeX * areaSizeY);
+	tempMeshes[1].resize(areaSizeX * areaSizeY);
+
+	FindRadialMaxima(area, maxx, maxy, winSize, groundHeights, colsMaxima, tempMeshes[0]);
+
 	// actually smooth with approximate Gaussian blur passes
-	for (int numBlurs = 3; numBlurs > 0; --numBlurs) {
-		BlurHorizontal(maxx, maxy, blurSize, resolution, mesh, origMesh); mesh.swap(origMesh);
-		BlurVertical(maxx, maxy, blurSize, resolution, mesh, origMesh); mesh.swap(origMesh);
+	for (int pass = 1; pass <= NUM_BLURS * 2; ++pass) {
+		const std::vector<float>& src = tempMeshes[(pass - 1) & 1];
+		      std::vector<float>& dst = tempMeshes[(pass    ) & 1];
+
+		if ((pass & 1) != 0) {
+			BlurHorizontal(passRects[pass], area, maxx, maxHeight, groundHeights, src, dst);
+		} else {
+			BlurVertical(passRects[pass], area, maxx, maxy, maxHeight, groundHeights, src, dst);
+		}
 	}
 
-	// <mesh> now contains the final smoothed heightmap, save it in origMesh
-	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
+	// the final pass wrote to tempMeshes[0], save it in origMesh and
+	// in mesh except where Lua has changed the height of a vertex
+	const std::vector<float>& smoothed = tempMeshes[(NUM_BLURS * 2) & 1];
+
+	for (int y = rect.z1; y <= rect.z2; ++y) {
+		const float* srcRow = &smoothed[(rect.x1 - area.x1) + (y - area.z1) * areaSizeX];
+
+		std::copy(srcRow, srcRow + (rect.x2 - rect.x1 + 1), &origMesh[rect.x1 + y * lineSize]);
+
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			if (modifiedCells[x + y * lineSize])
+				continue;
+
+			mesh[x + y * lineSize] = srcRow[x - rect.x1];
+		}
+	}
 }
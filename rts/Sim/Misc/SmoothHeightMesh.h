@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "System/Rectangle.h"
+
 class CGround;
 
 /**
@@ -16,14 +18,26 @@ public:
 	void Init(float mx, float my, float res, float smoothRad);
 	void Kill();
 
+	/**
+	 * Re-smooths the part of the mesh that depends on the heightmap corners
+	 * within [x1, x2] x [z1, z2] (inclusive), which gives exactly the same
+	 * values as rebuilding the whole mesh. Vertices changed through Lua
+	 * keep their height, only their original (unmodified) height is updated.
+	 */
+	void MapChanged(int x1, int z1, int x2, int z2);
+
 	float GetHeight(float x, float y);
 	float GetHeightAboveWater(float x, float y);
 	float SetHeight(int index, float h);
 	float AddHeight(int index, float h);
 	float SetMaxHeight(int index, float h);
+	/// restores the original height and lets the vertex follow terrain changes again
+	float RevertHeight(int index);
 
 	int GetMaxX() const { return maxx; }
 	int GetMaxY() const { return maxy; }
+	/// number of height-values per mesh row
+	int GetLineSize() const { return (maxx + 1); }
 	float GetFMaxX() const { return fmaxx; }
 	float GetFMaxY() const { return fmaxy; }
 	float GetResolution() const { return resolution; }
@@ -34,6 +48,9 @@ public:
 private:
 	void MakeSmoothMesh();
 
+	void UpdateGroundHeights(const SRectangle& rect);
+	void SmoothArea(const SRectangle& rect);
+
 	int maxx = 0;
 	int maxy = 0;
 	float fmaxx = 0.0f;
@@ -44,8 +61,15 @@ private:
 	std::vector<float> mesh;
 	std::vector<float> origMesh;
 
+	/// ground height above water at every mesh vertex
+	std::vector<float> groundHeights;
+
+	/// vertices whose height was changed through Lua, MapChanged leaves them alone
+	std::vector<bool> modifiedCells;
+
+	/// scratch buffers for SmoothArea
 	std::vector<float> colsMaxima;
-	std::vector<int> maximaRows;
+	std::vector<float> tempMeshes[2];
 };
 
 extern SmoothHeightMesh smoothGround;
@@ -39,8 +39,13 @@ struct SolidObjectDef {
 public:
 
 	SolidObjectDef();
+	SolidObjectDef(const SolidObjectDef&) = default;
+	SolidObjectDef(SolidObjectDef&&) = default;
 	virtual ~SolidObjectDef() { }
 
+	SolidObjectDef& operator = (const SolidObjectDef&) = default;
+	SolidObjectDef& operator = (SolidObjectDef&&) = default;
+
 	S3DModel* LoadModel() const;
 	void PreloadModel() const;
 	float GetModelRadius() const;
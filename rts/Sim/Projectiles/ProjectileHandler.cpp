@@ -468,6 +468,10 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 }
 
 
+// candidates for CCollisionHandler::DetectFirstHit, shared by units and features
+static std::vector<CSolidObject*> hitTestObjects;
+static std::vector<CMatrix44f> hitTestMatrices;
+
 void CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
 	std::vector<CUnit*>& tempUnits,
@@ -479,6 +483,9 @@ void CProjectileHandler::CheckUnitCollisions(
 
 	CollisionQuery cq;
 
+	hitTestObjects.clear();
+	hitTestMatrices.clear();
+
 	for (CUnit* unit: tempUnits) {
 		assert(unit != nullptr);
 
@@ -491,20 +498,27 @@ void CProjectileHandler::CheckUnitCollisions(
 		if (!CheckProjectileCollisionFlags(p, unit))
 			continue;
 
-		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+		hitTestObjects.push_back(unit);
+		hitTestMatrices.push_back(unit->GetTransformMatrix(true));
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(unit);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(unit);
-			}
+	// test all candidates at once, the first one hit (in quad-order) wins
+	const int hitIdx = CCollisionHandler::DetectFirstHit(hitTestObjects.data(), hitTestMatrices.data(), hitTestObjects.size(), ppos0, ppos1, &cq);
 
-			break;
-		}
+	if (hitIdx < 0)
+		return;
+
+	CUnit* unit = static_cast<CUnit*>(hitTestObjects[hitIdx]);
+
+	if (cq.GetHitPiece() != nullptr)
+		unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(unit);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(unit);
 	}
 }
 
@@ -523,26 +537,35 @@ void CProjectileHandler::CheckFeatureCollisions(
 
 	CollisionQuery cq;
 
+	hitTestObjects.clear();
+	hitTestMatrices.clear();
+
 	for (CFeature* feature: tempFeatures) {
 		assert(feature != nullptr);
 
 		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
 			continue;
 
-		if (CCollisionHandler::DetectHit(feature, feature->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+		hitTestObjects.push_back(feature);
+		hitTestMatrices.push_back(feature->GetTransformMatrix(true));
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(feature);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(feature);
-			}
+	const int hitIdx = CCollisionHandler::DetectFirstHit(hitTestObjects.data(), hitTestMatrices.data(), hitTestObjects.size(), ppos0, ppos1, &cq);
 
-			break;
-		}
+	if (hitIdx < 0)
+		return;
+
+	CFeature* feature = static_cast<CFeature*>(hitTestObjects[hitIdx]);
+
+	if (cq.GetHitPiece() != nullptr)
+		feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(feature);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(feature);
 	}
 }
 
@@ -1538,7 +1538,7 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 		best = nullptr;
 		const CTeam* team = teamHandler.Team(owner->team);
 		QuadFieldQuery qfQuery;
-		quadField.GetFeaturesExact(qfQuery, pos, radius, false);
+		quadField.GetFeaturesExactCached(qfQuery, pos, radius);
 		bool metal = false;
 
 		for (const CFeature* f: *qfQuery.features) {
@@ -1614,7 +1614,7 @@ bool CBuilderCAI::FindResurrectableFeatureAndResurrect(
 	bool freshOnly
 ) {
 	QuadFieldQuery qfQuery;
-	quadField.GetFeaturesExact(qfQuery, pos, radius, false);
+	quadField.GetFeaturesExactCached(qfQuery, pos, radius);
 
 	const CFeature* best = nullptr;
 	float bestDist = 1.0e30f;
@@ -39,11 +39,11 @@ UnitDefWeapon::UnitDefWeapon(const WeaponDef* weaponDef, const LuaTable& weaponT
 	//     (arcs are always symmetric around mainDir)
 	this->maxMainDirAngleDif = math::cos((weaponTable.GetFloat("maxAngleDif", 360.0f) * 0.5f) * math::DEG_TO_RAD);
 
-	const string& btcString = weaponTable.GetString("badTargetCategory", "");
-	const string& otcString = weaponTable.GetString("onlyTargetCategory", "");
+	this->badTargetCatString = weaponTable.GetString("badTargetCategory", "");
+	this->onlyTargetCatString = weaponTable.GetString("onlyTargetCategory", "");
 
-	this->badTargetCat =                                   CCategoryHandler::Instance()->GetCategories(btcString);
-	this->onlyTargetCat = (otcString.empty())? 0xffffffff: CCategoryHandler::Instance()->GetCategories(otcString);
+	// the masks themselves are set by UnitDef::ResolveCategories
+	this->onlyTargetCat = (onlyTargetCatString.empty())? 0xffffffff: 0;
 
 	this->mainDir = weaponTable.GetFloat3("mainDir", FwdVector);
 	this->mainDir.SafeNormalize();
@@ -480,9 +480,7 @@ UnitDef::UnitDef(const LuaTable& udTable, const std::string& unitName, int id)
 	maxThisUnit = std::min(maxThisUnit, gameSetup->GetRestrictedUnitLimit(name, MAX_UNITS));
 
 	categoryString = udTable.GetString("category", "");
-
-	category = CCategoryHandler::Instance()->GetCategories(udTable.GetString("category", ""));
-	noChaseCategory = CCategoryHandler::Instance()->GetCategories(udTable.GetString("noChaseCategory", ""));
+	noChaseCategoryString = udTable.GetString("noChaseCategory", "");
 
 	iconType = icon::iconHandler.GetIcon(udTable.GetString("iconType", "default"));
 
@@ -786,6 +784,20 @@ void UnitDef::CreateYardMap(std::string&& yardMapStr)
 
 
 
+void UnitDef::ResolveCategories()
+{
+	category = CCategoryHandler::Instance()->GetCategories(categoryString);
+	noChaseCategory = CCategoryHandler::Instance()->GetCategories(noChaseCategoryString);
+
+	for (UnitDefWeapon& udw: weapons) {
+		udw.badTargetCat = CCategoryHandler::Instance()->GetCategories(udw.badTargetCatString);
+
+		if (!udw.onlyTargetCatString.empty())
+			udw.onlyTargetCat = CCategoryHandler::Instance()->GetCategories(udw.onlyTargetCatString);
+	}
+}
+
+
 void UnitDef::SetNoCost(bool noCost)
 {
 	if (noCost) {
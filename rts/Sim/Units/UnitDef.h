@@ -42,6 +42,10 @@ struct UnitDefWeapon {
 	unsigned int onlyTargetCat = 0;
 
 	float3 mainDir = FwdVector;
+
+	// resolved into the bitmasks above by UnitDef::ResolveCategories
+	std::string badTargetCatString;
+	std::string onlyTargetCatString;
 };
 
 
@@ -53,6 +57,13 @@ public:
 
 	void SetNoCost(bool noCost);
 
+	/**
+	 * Category bits are handed out in order of first use, so unlike
+	 * the rest of the def they can not be assigned during parallel
+	 * construction; the handler calls this serially in ID order.
+	 */
+	void ResolveCategories();
+
 	bool IsTransportUnit()     const { return (transportCapacity > 0 && transportMass > 0.0f); }
 	bool IsImmobileUnit()      const { return (pathType == -1U && !canfly && speed <= 0.0f); }
 	bool IsBuildingUnit()      const { return (IsImmobileUnit() && !yardmap.empty()); }
@@ -208,6 +219,7 @@ public:
 	std::string tooltip;
 	std::string wreckName;
 	std::string categoryString;
+	std::string noChaseCategoryString;
 	std::string buildPicName;
 
 	std::array<UnitDefWeapon, MAX_WEAPONS_PER_UNIT> weapons;
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <locale>
 #include <cctype>
+#include <exception>
 
 #include "UnitDefHandler.h"
 #include "UnitDef.h"
@@ -13,6 +14,7 @@
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/Sound/ISound.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static CUnitDefHandler gUnitDefHandler;
@@ -30,24 +32,49 @@ void CUnitDefHandler::Init(LuaParser* defsParser)
 {
 	noCost = false;
 
-	const LuaTable& rootTable = defsParser->GetRoot().SubTable("UnitDefs");
+	// the snapshot holds no Lua state, so defs can be parsed from it on any thread
+	const LuaTable& rootTable = defsParser->GetRoot().SubTable("UnitDefs").Snapshot();
 
 	if (!rootTable.IsValid())
 		throw content_error("Error loading UnitDefs");
 
 	std::vector<std::string> unitDefNames;
+	std::vector<UnitDef> parsedDefs;
+	std::vector<std::exception_ptr> exceptions;
 	rootTable.GetKeys(unitDefNames);
 
 	unitDefIDs.reserve(unitDefNames.size() + 1);
 	unitDefsVector.reserve(unitDefNames.size() + 1);
 	unitDefsVector.emplace_back();
 
+	parsedDefs.resize(unitDefNames.size());
+	exceptions.resize(unitDefNames.size());
+
+	// parse the unitdef data (but don't load buildpics, etc...)
+	for_mt(0, unitDefNames.size(), [&](const int a) {
+		try {
+			parsedDefs[a] = UnitDef(rootTable.SubTable(unitDefNames[a]), StringToLower(unitDefNames[a]), 0);
+		} catch (...) {
+			exceptions[a] = std::current_exception();
+		}
+	});
+
+	// IDs, categories and sound-sets are assigned in order of registration
 	for (unsigned int a = 0; a < unitDefNames.size(); ++a) {
-		const string& unitName = unitDefNames[a];
-		const LuaTable& udTable = rootTable.SubTable(unitName);
+		const std::string& unitName = StringToLower(unitDefNames[a]);
+
+		if (std::find_if(unitName.begin(), unitName.end(), isblank) != unitName.end())
+			LOG_L(L_WARNING, "[%s] UnitDef name \"%s\" contains white-spaces", __func__, unitName.c_str());
 
-		// parse the unitdef data (but don't load buildpics, etc...)
-		PushNewUnitDef(StringToLower(unitName), udTable);
+		try {
+			if (exceptions[a] != nullptr)
+				std::rethrow_exception(exceptions[a]);
+		} catch (const content_error& err) {
+			LOG_L(L_ERROR, "%s", err.what());
+			continue;
+		}
+
+		PushNewUnitDef(unitName, rootTable.SubTable(unitDefNames[a]), std::move(parsedDefs[a]));
 	}
 
 	CleanBuildOptions();
@@ -56,16 +83,15 @@ void CUnitDefHandler::Init(LuaParser* defsParser)
 
 
 
-int CUnitDefHandler::PushNewUnitDef(const std::string& unitName, const LuaTable& udTable)
+int CUnitDefHandler::PushNewUnitDef(const std::string& unitName, const LuaTable& udTable, UnitDef&& unitDef)
 {
-	if (std::find_if(unitName.begin(), unitName.end(), isblank) != unitName.end())
-		LOG_L(L_WARNING, "[%s] UnitDef name \"%s\" contains white-spaces", __func__, unitName.c_str());
-
 	const int defID = unitDefsVector.size();
 
 	try {
-		unitDefsVector.emplace_back(udTable, unitName, defID);
+		unitDefsVector.emplace_back(std::move(unitDef));
 		UnitDef& newDef = unitDefsVector.back();
+		newDef.id = defID;
+		newDef.ResolveCategories();
 		UnitDefLoadSounds(&newDef, udTable);
 
 		// map unitName to newDef.decoyName
@@ -52,7 +52,8 @@ public:
 	// id=0 is not a valid UnitDef, hence the -1
 	unsigned int NumUnitDefs() const { return (unitDefsVector.size() - 1); }
 
-	int PushNewUnitDef(const std::string& unitName, const LuaTable& udTable);
+	/// registers a def constructed from udTable, assigning its ID
+	int PushNewUnitDef(const std::string& unitName, const LuaTable& udTable, UnitDef&& unitDef);
 
 	const std::vector<UnitDef>& GetUnitDefsVec() const { return unitDefsVector; }
 	const spring::unordered_map<std::string, int>& GetUnitDefIDs() const { return unitDefIDs; }
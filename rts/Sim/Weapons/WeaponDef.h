@@ -262,8 +262,10 @@ public:
 	};
 	Visuals visuals;
 
-private:
+	/// appends to the shared sound-set data, called by the handler in ID order after construction
 	void ParseWeaponSounds(const LuaTable& wdTable);
+
+private:
 	void LoadSound(const LuaTable& wdTable, const std::string& soundKey, GuiSoundSet& soundSet);
 };
 
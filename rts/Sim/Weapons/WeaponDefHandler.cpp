@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <exception>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 
 #include "WeaponDefHandler.h"
@@ -11,6 +13,7 @@
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "System/Exceptions.h"
 #include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static CWeaponDefHandler gWeaponDefHandler;
@@ -19,21 +22,41 @@ CWeaponDefHandler* weaponDefHandler = &gWeaponDefHandler;
 
 void CWeaponDefHandler::Init(LuaParser* defsParser)
 {
-	const LuaTable& rootTable = defsParser->GetRoot().SubTable("WeaponDefs");
+	// the snapshot holds no Lua state, so defs can be parsed from it on any thread
+	const LuaTable& rootTable = defsParser->GetRoot().SubTable("WeaponDefs").Snapshot();
 
 	if (!rootTable.IsValid())
 		throw content_error("Error loading WeaponDefs");
 
 	std::vector<std::string> weaponNames;
+	std::vector<std::optional<WeaponDef>> parsedDefs;
+	std::vector<std::exception_ptr> exceptions;
 	rootTable.GetKeys(weaponNames);
 
 	weaponDefsVector.reserve(weaponNames.size());
 	weaponDefIDs.reserve(weaponNames.size());
-
+	parsedDefs.resize(weaponNames.size());
+	exceptions.resize(weaponNames.size());
+
+	for_mt(0, weaponNames.size(), [&](const int wid) {
+		try {
+			parsedDefs[wid].emplace(rootTable.SubTable(weaponNames[wid]), weaponNames[wid], wid);
+		} catch (...) {
+			exceptions[wid] = std::current_exception();
+		}
+	});
+
+	// sound-sets are shared between defs and numbered in order of registration
 	for (int wid = 0; wid < weaponNames.size(); wid++) {
 		const std::string& name = weaponNames[wid];
-		const LuaTable wdTable = rootTable.SubTable(name);
-		weaponDefsVector.emplace_back(wdTable, name, wid);
+
+		if (exceptions[wid] != nullptr)
+			std::rethrow_exception(exceptions[wid]);
+
+		weaponDefsVector.emplace_back(std::move(*parsedDefs[wid]));
+		parsedDefs[wid].reset();
+
+		weaponDefsVector[wid].ParseWeaponSounds(rootTable.SubTable(name));
 		weaponDefIDs[name] = wid;
 	}
 }
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <exception>
 #include <memory>
 
 #include <sys/types.h>
@@ -20,10 +21,12 @@
 #include "FileQueryFlags.h"
 #include "Lua/LuaParser.h"
 #include "System/ContainerUtil.h"
+#include "System/CRC.h"
 #include "System/StringUtil.h"
 #include "System/Exceptions.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/FileSystem/RapidHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedMap.hpp"
@@ -53,6 +56,97 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_ARCHIVESCANNER)
 
 constexpr static int INTERNAL_VER = 16;
 
+CONFIG(int, ArchiveScanThreads).defaultValue(4).minimumValue(1).description("Number of uncached archives opened and scanned concurrently when the archive cache is (re)built.");
+CONFIG(bool, ArchiveCacheLuaExport).defaultValue(false).description("Also write the archive cache as ArchiveCache.lua next to the binary one, for external tools that parse it.");
+
+
+/*
+ * Binary ArchiveCache layout, in native byte-order (the cache never leaves
+ * the machine that wrote it):
+ *
+ *   BinCacheHeader
+ *   BinArchiveRecord[numArchives]
+ *   BinBrokenArchiveRecord[numBrokenArchives]
+ *   BinInfoItemRecord[numInfoItems]
+ *   uint32_t[numDependencies]            string offsets
+ *   char[stringsSize]                    deduplicated zero-terminated strings
+ *
+ * All strings are stored as offsets into the string-table; dataCRC covers
+ * everything following the header. Unlike the Lua cache this is read with
+ * a single fread, no interpreter is involved.
+ */
+constexpr static char BINARY_CACHE_MAGIC[8] = {'S', 'P', 'R', 'A', 'C', 'A', 'C', 'H'};
+constexpr static uint32_t BINARY_CACHE_VER = 1;
+
+struct BinCacheHeader {
+	char magic[8];
+	uint32_t formatVersion;
+	uint32_t internalVersion;
+
+	uint32_t numArchives;
+	uint32_t numBrokenArchives;
+	uint32_t numInfoItems;
+	uint32_t numDependencies;
+	uint32_t stringsSize;
+
+	uint32_t dataSize;
+	uint32_t dataCRC;
+};
+
+struct BinArchiveRecord {
+	uint32_t origName;
+	uint32_t path;
+	uint32_t archiveDataPath;
+	uint32_t modified;
+	uint32_t modifiedArchiveData;
+
+	uint32_t firstInfoItem;
+	uint32_t numInfoItems;
+	uint32_t firstDependency;
+	uint32_t numDependencies;
+
+	uint8_t checksum[sha512::SHA_LEN];
+};
+
+struct BinBrokenArchiveRecord {
+	uint32_t name;
+	uint32_t path;
+	uint32_t problem;
+	uint32_t modified;
+};
+
+struct BinInfoItemRecord {
+	uint32_t key;
+	uint32_t valueType;
+	// string offset, or the raw int/float/bool value
+	uint32_t value;
+};
+
+static_assert((sizeof(BinArchiveRecord) % sizeof(uint32_t)) == 0, "");
+
+
+class BinCacheStrings {
+public:
+	uint32_t Add(const std::string& str) {
+		const auto it = offsets.find(str);
+
+		if (it != offsets.end())
+			return it->second;
+
+		const uint32_t offset = data.size();
+
+		data.insert(data.end(), str.c_str(), str.c_str() + str.size() + 1);
+		offsets.insert(str, offset);
+		return offset;
+	}
+
+	const std::vector<char>& GetData() const { return data; }
+
+private:
+	spring::unordered_map<std::string, uint32_t> offsets;
+	std::vector<char> data;
+};
+
 
 /*
  * Engine known (and used?) tags in [map|mod]info.lua
@@ -387,8 +481,7 @@ static std::atomic<uint32_t> numScannedArchives{0};
 CArchiveScanner::CArchiveScanner()
 {
 	Clear();
-	// the "cache" dir is created in DataDirLocater
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData(cachefile = GetCacheFileName("bin"));
 	ScanAllDirs();
 }
 
@@ -401,6 +494,12 @@ CArchiveScanner::~CArchiveScanner()
 	WriteCacheData(GetFilepath());
 }
 
+std::string CArchiveScanner::GetCacheFileName(const char* ext)
+{
+	// the "cache" dir is created in DataDirLocater
+	return (FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.") + ext);
+}
+
 uint32_t CArchiveScanner::GetNumScannedArchives()
 {
 	// needs to be a static since archiveScanner remains null until ctor returns
@@ -432,7 +531,7 @@ void CArchiveScanner::Reload()
 
 	// ctor
 	Clear();
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData(cachefile = GetCacheFileName("bin"));
 	ScanAllDirs();
 }
 
@@ -466,6 +565,28 @@ void CArchiveScanner::ScanAllDirs()
 }
 
 
+struct ScanScope {
+	 ScanScope(bool* b) { p = b; *p =  true; }
+	~ScanScope(       ) {        *p = false; }
+
+	bool* p = nullptr;
+};
+
+static bool IgnoreDuplicateArchive(const std::string& lcName, const std::string& fullName, const std::string& prevFullName)
+{
+	LOG_L(L_ERROR, "[AS::%s] found a \"%s\" already in \"%s\", ignoring.", __func__, fullName.c_str(), prevFullName.c_str());
+
+	if (baseContentArchives.find(lcName) == baseContentArchives.end())
+		return true; // ignore
+
+	throw user_error(
+		std::string("duplicate base content detected:\n\t") + FileSystem::GetDirectory(prevFullName) +
+		std::string("\n\t") + FileSystem::GetDirectory(fullName) +
+		std::string("\nPlease fix your configuration/installation as this can cause desyncs!")
+	);
+}
+
+
 void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
@@ -498,12 +619,81 @@ void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs)
 		}
 	}*/
 
-	// Create archiveInfos etc. if not in cache already
+	// Create archiveInfos etc. if not in cache already; the cache is checked
+	// serially and archives which need to be (re)scanned are then opened and
+	// evaluated by a few threads, since that is dominated by I/O
+	std::vector<std::string> scanArchives;
+	std::vector<unsigned int> scanModifiedTimes;
+	spring::unordered_map<std::string, size_t> scanArchivesIndex;
+
 	for (const std::string& archive: foundArchives) {
-		ScanArchive(archive, false);
-	#if !defined(DEDICATED) && !defined(UNITSYNC)
-		Watchdog::ClearTimer(WDT_MAIN);
-	#endif
+		const std::string& lcName = StringToLower(FileSystem::GetFilename(archive));
+		const auto iter = scanArchivesIndex.find(lcName);
+
+		// already queued from another data-dir, nothing recorded for it yet
+		if (iter != scanArchivesIndex.end() && IgnoreDuplicateArchive(lcName, archive, scanArchives[iter->second]))
+			continue;
+
+		unsigned int modifiedTime = 0;
+
+		if (CheckCachedData(archive, modifiedTime, false))
+			continue;
+
+		scanArchivesIndex.insert(lcName, scanArchives.size());
+		scanArchives.push_back(archive);
+		scanModifiedTimes.push_back(modifiedTime);
+	}
+
+	if (!scanArchives.empty()) {
+		const ScanScope scanScope(&isInScan);
+
+		std::vector<ArchiveScanResult> scanResults(scanArchives.size());
+		std::vector<spring::thread> scanThreads;
+
+		std::atomic<size_t> nextArchive{0};
+		std::exception_ptr scanException;
+		spring::mutex scanExceptionMutex;
+
+		const auto ScanWorker = [&]() {
+			for (size_t i = 0; (i = nextArchive.fetch_add(1)) < scanArchives.size(); ) {
+				try {
+					ScanArchiveContents(scanArchives[i], scanModifiedTimes[i], false, scanResults[i]);
+				} catch (...) {
+					std::lock_guard<spring::mutex> lock(scanExceptionMutex);
+
+					if (scanException == nullptr)
+						scanException = std::current_exception();
+
+					nextArchive.store(scanArchives.size());
+				}
+
+			#if !defined(DEDICATED) && !defined(UNITSYNC)
+				Watchdog::ClearTimer(WDT_MAIN);
+			#endif
+			}
+		};
+
+		const size_t numThreads = std::min(size_t(std::max(configHandler->GetInt("ArchiveScanThreads"), 1)), scanArchives.size());
+
+		for (size_t n = 1; n < numThreads; n++) {
+			scanThreads.emplace_back(ScanWorker);
+		}
+
+		ScanWorker();
+
+		for (spring::thread& t: scanThreads) {
+			t.join();
+		}
+
+		if (scanException != nullptr)
+			std::rethrow_exception(scanException);
+
+		// results are added in discovery order, same as a serial scan
+		for (ArchiveScanResult& result: scanResults) {
+			AddScanResult(result);
+		}
+
+		LOG("[AS::%s] scanned %u uncached archives using %u threads", __func__, unsigned(scanArchives.size()), unsigned(numThreads));
 	}
 
 	// Now we'll have to parse the replaces-stuff found in the mods
@@ -648,17 +838,28 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		return;
 
 	isDirty = true;
-	isInScan = true;
 
-	struct ScanScope {
-		 ScanScope(bool* b) { p = b; *p =  true; }
-		~ScanScope(       ) {        *p = false; }
+	const ScanScope scanScope(&isInScan);
 
-		bool* p = nullptr;
-	};
+	ArchiveScanResult result;
+	ScanArchiveContents(fullName, modifiedTime, doChecksum, result);
+	AddScanResult(result);
+}
 
-	const ScanScope scanScope(&isInScan);
+void CArchiveScanner::AddScanResult(ArchiveScanResult& result)
+{
+	if (result.isBroken) {
+		BrokenArchive& ba = GetAddBrokenArchive(result.brokenArchive.name);
+		ba = std::move(result.brokenArchive);
+		return;
+	}
+
+	archiveInfosIndex.insert(StringToLower(result.archiveInfo.origName), archiveInfos.size());
+	archiveInfos.emplace_back(std::move(result.archiveInfo));
+}
 
+void CArchiveScanner::ScanArchiveContents(const std::string& fullName, unsigned int modifiedTime, bool doChecksum, ArchiveScanResult& result)
+{
 	const std::string& fname = FileSystem::GetFilename(fullName);
 	const std::string& fpath = FileSystem::GetDirectory(fullName);
 	const std::string& lcfn  = StringToLower(fname);
@@ -669,13 +870,15 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_L(L_WARNING, "[AS::%s] unable to open archive \"%s\"", __func__, fullName.c_str());
 
 		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = GetAddBrokenArchive(lcfn);
+		BrokenArchive& ba = result.brokenArchive;
 		ba.name = lcfn;
 		ba.path = fpath;
 		ba.modified = modifiedTime;
 		ba.updated = true;
 		ba.problem = "Unable to open archive";
 
+		result.isBroken = true;
+
 		// does not count as a scan
 		// numScannedArchives += 1;
 		return;
@@ -690,7 +893,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	const bool hasMapInfo = ar->FileExists("mapinfo.lua");
 
 
-	ArchiveInfo ai;
+	ArchiveInfo& ai = result.archiveInfo;
 	ArchiveData& ad = ai.archiveData;
 
 	// execute the respective .lua, otherwise assume this archive is a map
@@ -713,13 +916,15 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_L(L_WARNING, "[AS::%s] failed to scan \"%s\" (%s)", __func__, fullName.c_str(), error.c_str());
 
 		// mark archive as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = GetAddBrokenArchive(lcfn);
+		BrokenArchive& ba = result.brokenArchive;
 		ba.name = lcfn;
 		ba.path = fpath;
 		ba.modified = modifiedTime;
 		ba.updated = true;
 		ba.problem = error;
 
+		result.isBroken = true;
+
 		// does count as a scan
 		numScannedArchives += 1;
 		return;
@@ -765,9 +970,6 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	ai.updated = true;
 	ai.hashed = doChecksum && GetArchiveChecksum(fullName, ai);
 
-	archiveInfosIndex.insert(lcfn, archiveInfos.size());
-	archiveInfos.emplace_back(std::move(ai));
-
 	numScannedArchives += 1;
 }
 
@@ -832,18 +1034,8 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned& mod
 		return true;
 	}
 
-	if (ai.updated) {
-		LOG_L(L_ERROR, "[AS::%s] found a \"%s\" already in \"%s\", ignoring.", __func__, fullName.c_str(), (ai.path + ai.origName).c_str());
-
-		if (baseContentArchives.find(aiIter->first) == baseContentArchives.end())
-			return true; // ignore
-
-		throw user_error(
-			std::string("duplicate base content detected:\n\t") + ai.path +
-			std::string("\n\t") + filePath +
-			std::string("\nPlease fix your configuration/installation as this can cause desyncs!")
-		);
-	}
+	if (ai.updated)
+		return (IgnoreDuplicateArchive(aiIter->first, fullName, ai.path + ai.origName));
 
 	// if we are here, we could have invalid info in the cache
 	// force a reread if it is a directory archive (.sdd), as
@@ -947,15 +1139,32 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 	// sort by filename
 	std::stable_sort(fileNames.begin(), fileNames.end());
 
-	// compute hashes of the files
+	fileHashCache.Load(FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + "FileHashCache.bin");
+
+	const size_t numCacheHits = fileHashCache.GetNumHits();
+
+	// compute hashes of the files; files stored separately on disk (e.g. in
+	// the rapid pool) are usually shared with other archives or versions so
+	// their hashes are cached by path, size and modification time
 	for_mt(0, fileNames.size(), [&](const int i) {
-		ar->CalcHash(ar->FindFile(fileNames[i]), fileHashes[i].data(), fileBuffers[ ThreadPool::GetThreadNum() ]);
+		const unsigned int fid = ar->FindFile(fileNames[i]);
+		const std::string& rawPath = ar->GetFileRawPath(fid);
+
+		CFileHashCache::FileStat fileStat;
+
+		const bool cacheable = (!rawPath.empty() && CFileHashCache::GetFileStat(rawPath, fileStat));
+		const bool cached = (cacheable && fileHashCache.GetHash(rawPath, fileStat, fileHashes[i].data()));
+
+		if (!cached && ar->CalcHash(fid, fileHashes[i].data(), fileBuffers[ ThreadPool::GetThreadNum() ]) && cacheable)
+			fileHashCache.SetHash(rawPath, fileStat, fileHashes[i].data());
 
 		#if !defined(DEDICATED) && !defined(UNITSYNC)
 		Watchdog::ClearTimer(WDT_MAIN);
 		#endif
 	});
 
+	LOG_S(LOG_SECTION_ARCHIVESCANNER, "[AS::%s] \"%s\": %u of %u file-hashes were cached", __func__, archiveName.c_str(), unsigned(fileHashCache.GetNumHits() - numCacheHits), unsigned(fileNames.size()));
+
 	// combine individual hashes, initialize to hash(name)
 	for (size_t i = 0; i < fileNames.size(); i++) {
 		sha512::calc_digest(reinterpret_cast<const uint8_t*>(fileNames[i].c_str()), fileNames[i].size(), archiveInfo.checksum);
@@ -976,15 +1185,181 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 void CArchiveScanner::ReadCacheData(const std::string& filename)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	if (ReadCacheDataBin(filename))
+		return;
+
+	// fall back to a Lua cache written by an earlier build or exported
+	// alongside, and make sure the binary cache gets (re)written later
+	if (ReadCacheDataLua(GetCacheFileName("lua")))
+		isDirty = true;
+}
+
+bool CArchiveScanner::ReadCacheDataBin(const std::string& filename)
+{
+	std::vector<char> buffer;
+	{
+		FILE* in = fopen(filename.c_str(), "rb");
+
+		if (in == nullptr) {
+			LOG_L(L_INFO, "[AS::%s] ArchiveCache %s doesn't exist", __func__, filename.c_str());
+			return false;
+		}
+
+		fseek(in, 0, SEEK_END);
+		buffer.resize(std::max(0L, ftell(in)));
+		fseek(in, 0, SEEK_SET);
+
+		const size_t numRead = fread(buffer.data(), 1, buffer.size(), in);
+		fclose(in);
+
+		if (numRead != buffer.size() || buffer.size() < sizeof(BinCacheHeader)) {
+			LOG_L(L_ERROR, "[AS::%s] failed to read ArchiveCache %s", __func__, filename.c_str());
+			return false;
+		}
+	}
+
+	BinCacheHeader header;
+	std::memcpy(&header, buffer.data(), sizeof(header));
+
+	if (std::memcmp(header.magic, BINARY_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.formatVersion != BINARY_CACHE_VER || header.internalVersion != INTERNAL_VER)
+		return false;
+
+	const char* data = buffer.data() + sizeof(header);
+	const size_t dataSize =
+		header.numArchives       * sizeof(BinArchiveRecord      ) +
+		header.numBrokenArchives * sizeof(BinBrokenArchiveRecord) +
+		header.numInfoItems      * sizeof(BinInfoItemRecord     ) +
+		header.numDependencies   * sizeof(uint32_t              ) +
+		header.stringsSize;
+
+	if (dataSize != header.dataSize || dataSize != (buffer.size() - sizeof(header)) || CRC::CalcDigest(data, dataSize) != header.dataCRC) {
+		LOG_L(L_ERROR, "[AS::%s] ArchiveCache %s is corrupt, ignoring it", __func__, filename.c_str());
+		return false;
+	}
+
+	// records are 4-byte aligned and the buffer is suitably aligned for them
+	const BinArchiveRecord*       archiveRecs = reinterpret_cast<const BinArchiveRecord*>(data);
+	const BinBrokenArchiveRecord*  brokenRecs = reinterpret_cast<const BinBrokenArchiveRecord*>(archiveRecs + header.numArchives);
+	const BinInfoItemRecord*     infoItemRecs = reinterpret_cast<const BinInfoItemRecord*>(brokenRecs + header.numBrokenArchives);
+	const uint32_t*                 dependRecs = reinterpret_cast<const uint32_t*>(infoItemRecs + header.numInfoItems);
+	const char*                        strings = reinterpret_cast<const char*>(dependRecs + header.numDependencies);
+
+	if (header.stringsSize == 0 || strings[header.stringsSize - 1] != 0)
+		return false;
+
+	const auto IsValidString = [&](uint32_t offset) { return (offset < header.stringsSize); };
+	const auto IsValidRange = [](uint32_t first, uint32_t count, uint32_t size) { return (first <= size && count <= (size - first)); };
+
+	// validate everything up-front, archiveInfos must not be left half-filled
+	for (uint32_t i = 0; i < header.numArchives; i++) {
+		const BinArchiveRecord& rec = archiveRecs[i];
+
+		bool valid = true;
+		valid &= (IsValidString(rec.origName) && IsValidString(rec.path) && IsValidString(rec.archiveDataPath));
+		valid &= IsValidRange(rec.firstInfoItem, rec.numInfoItems, header.numInfoItems);
+		valid &= IsValidRange(rec.firstDependency, rec.numDependencies, header.numDependencies);
+
+		if (!valid)
+			return false;
+	}
+	for (uint32_t i = 0; i < header.numBrokenArchives; i++) {
+		const BinBrokenArchiveRecord& rec = brokenRecs[i];
+
+		if (!IsValidString(rec.name) || !IsValidString(rec.path) || !IsValidString(rec.problem))
+			return false;
+	}
+	for (uint32_t i = 0; i < header.numInfoItems; i++) {
+		const BinInfoItemRecord& rec = infoItemRecs[i];
+
+		if (!IsValidString(rec.key) || rec.valueType > INFO_VALUE_TYPE_BOOL)
+			return false;
+		if (rec.valueType == INFO_VALUE_TYPE_STRING && !IsValidString(rec.value))
+			return false;
+	}
+	for (uint32_t i = 0; i < header.numDependencies; i++) {
+		if (!IsValidString(dependRecs[i]))
+			return false;
+	}
+
+
+	archiveInfos.reserve(header.numArchives);
+	archiveInfosIndex.reserve(header.numArchives);
+
+	for (uint32_t i = 0; i < header.numArchives; i++) {
+		const BinArchiveRecord& rec = archiveRecs[i];
+		const std::string curArchiveName = strings + rec.origName;
+
+		ArchiveInfo& ai = GetAddArchiveInfo(StringToLower(curArchiveName));
+		ArchiveInfo tmp; // used to compare against all-zero hash
+
+		ai.origName        = curArchiveName;
+		ai.path            = strings + rec.path;
+		ai.archiveDataPath = strings + rec.archiveDataPath;
+
+		ai.modified = rec.modified;
+		ai.modifiedArchiveData = rec.modifiedArchiveData;
+
+		std::memcpy(ai.checksum, rec.checksum, sha512::SHA_LEN);
+
+		ai.updated = false;
+		ai.hashed = (memcmp(ai.checksum, tmp.checksum, sha512::SHA_LEN) != 0);
+
+		ai.archiveData = {};
+
+		for (uint32_t j = rec.firstInfoItem, n = rec.firstInfoItem + rec.numInfoItems; j < n; j++) {
+			const BinInfoItemRecord& itemRec = infoItemRecs[j];
+			const std::string key = strings + itemRec.key;
+
+			switch (itemRec.valueType) {
+				case INFO_VALUE_TYPE_STRING : { ai.archiveData.SetInfoItemValueString(key, strings + itemRec.value); } break;
+				case INFO_VALUE_TYPE_INTEGER: { ai.archiveData.SetInfoItemValueInteger(key, int(itemRec.value)); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { float f; std::memcpy(&f, &itemRec.value, sizeof(f)); ai.archiveData.SetInfoItemValueFloat(key, f); } break;
+				case INFO_VALUE_TYPE_BOOL   : { ai.archiveData.SetInfoItemValueBool(key, itemRec.value != 0); } break;
+				default: {} break;
+			}
+		}
+
+		std::vector<std::string>& deps = ai.archiveData.GetDependencies();
+
+		for (uint32_t j = rec.firstDependency, n = rec.firstDependency + rec.numDependencies; j < n; j++) {
+			deps.emplace_back(strings + dependRecs[j]);
+		}
+
+		if (ai.archiveData.IsMap()) {
+			AddDependency(deps, GetMapHelperContentName());
+		} else if (ai.archiveData.IsGame()) {
+			AddDependency(deps, GetSpringBaseContentName());
+		}
+	}
+
+	for (uint32_t i = 0; i < header.numBrokenArchives; i++) {
+		const BinBrokenArchiveRecord& rec = brokenRecs[i];
+		const std::string name = strings + rec.name;
+
+		BrokenArchive& ba = GetAddBrokenArchive(name);
+		ba.name = name;
+		ba.path = strings + rec.path;
+		ba.modified = rec.modified;
+		ba.updated = false;
+		ba.problem = strings + rec.problem;
+	}
+
+	isDirty = false;
+	return true;
+}
+
+bool CArchiveScanner::ReadCacheDataLua(const std::string& filename)
+{
 	if (!FileSystem::FileExists(filename)) {
 		LOG_L(L_INFO, "[AS::%s] ArchiveCache %s doesn't exist", __func__, filename.c_str());
-		return;
+		return false;
 	}
 
 	LuaParser p(filename, SPRING_VFS_RAW, SPRING_VFS_BASE);
 	if (!p.Execute()) {
 		LOG_L(L_ERROR, "[AS::%s] failed to parse ArchiveCache: %s", __func__, p.GetErrorLog().c_str());
-		return;
+		return false;
 	}
 
 	const LuaTable& archiveCacheTbl = p.GetRoot();
@@ -994,7 +1369,7 @@ void CArchiveScanner::ReadCacheData(const std::string& filename)
 	// Do not load old version caches
 	const int ver = archiveCacheTbl.GetInt("internalver", (INTERNAL_VER + 1));
 	if (ver != INTERNAL_VER)
-		return;
+		return false;
 
 	for (int i = 1; archivesTbl.KeyExists(i); ++i) {
 		const LuaTable& curArchiveTbl = archivesTbl.SubTable(i);
@@ -1051,6 +1426,7 @@ void CArchiveScanner::ReadCacheData(const std::string& filename)
 	}
 
 	isDirty = false;
+	return true;
 }
 
 static inline void SafeStr(FILE* out, const char* prefix, const std::string& str)
@@ -1074,14 +1450,12 @@ void FilterDep(std::vector<std::string>& deps, const std::string& exclude)
 void CArchiveScanner::WriteCacheData(const std::string& filename)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
-	if (!isDirty)
-		return;
 
-	FILE* out = fopen(filename.c_str(), "wt");
-	if (out == nullptr) {
-		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+	// no-op unless GetArchiveChecksum added hashes
+	fileHashCache.Save(FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + "FileHashCache.bin");
+
+	if (!isDirty)
 		return;
-	}
 
 	// First delete all outdated information
 	{
@@ -1106,6 +1480,148 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 		}
 	}
 
+	if (!WriteCacheDataBin(filename))
+		return;
+
+	if (configHandler->GetBool("ArchiveCacheLuaExport"))
+		WriteCacheDataLua(GetCacheFileName("lua"));
+
+	isDirty = false;
+}
+
+bool CArchiveScanner::WriteCacheDataBin(const std::string& filename)
+{
+	BinCacheStrings strings;
+
+	std::vector<BinArchiveRecord> archiveRecs;
+	std::vector<BinBrokenArchiveRecord> brokenRecs;
+	std::vector<BinInfoItemRecord> infoItemRecs;
+	std::vector<uint32_t> dependRecs;
+
+	archiveRecs.reserve(archiveInfos.size());
+	brokenRecs.reserve(brokenArchives.size());
+	infoItemRecs.reserve(archiveInfos.size() * 8);
+
+	// mirrors WriteCacheDataLua, i.e. whatever ArchiveData(LuaTable) would restore
+	for (const ArchiveInfo& arcInfo: archiveInfos) {
+		const ArchiveData& archData = arcInfo.archiveData;
+
+		BinArchiveRecord rec;
+		rec.origName = strings.Add(arcInfo.origName);
+		rec.path = strings.Add(arcInfo.path);
+		rec.archiveDataPath = strings.Add(arcInfo.archiveDataPath);
+		rec.modified = arcInfo.modified;
+		rec.modifiedArchiveData = arcInfo.modifiedArchiveData;
+		rec.firstInfoItem = infoItemRecs.size();
+		rec.numInfoItems = 0;
+		rec.firstDependency = dependRecs.size();
+		rec.numDependencies = 0;
+
+		std::memcpy(rec.checksum, arcInfo.checksum, sha512::SHA_LEN);
+
+		if (!archData.GetName().empty()) {
+			for (const auto& ii: archData.GetInfo()) {
+				BinInfoItemRecord itemRec;
+				itemRec.key = strings.Add(ii.first);
+				itemRec.valueType = ii.second.valueType;
+				itemRec.value = 0;
+
+				switch (ii.second.valueType) {
+					case INFO_VALUE_TYPE_STRING : { itemRec.value = strings.Add(ii.second.valueTypeString); } break;
+					case INFO_VALUE_TYPE_INTEGER: { itemRec.value = uint32_t(ii.second.value.typeInteger); } break;
+					case INFO_VALUE_TYPE_FLOAT  : { std::memcpy(&itemRec.value, &ii.second.value.typeFloat, sizeof(float)); } break;
+					case INFO_VALUE_TYPE_BOOL   : { itemRec.value = ii.second.value.typeBool; } break;
+					default: {} break;
+				}
+
+				infoItemRecs.push_back(itemRec);
+			}
+
+			std::vector<std::string> deps = archData.GetDependencies();
+			if (archData.IsMap()) {
+				FilterDep(deps, GetMapHelperContentName());
+			} else if (archData.IsGame()) {
+				FilterDep(deps, GetSpringBaseContentName());
+			}
+
+			for (const auto& dep: deps) {
+				dependRecs.push_back(strings.Add(dep));
+			}
+
+			rec.numInfoItems = infoItemRecs.size() - rec.firstInfoItem;
+			rec.numDependencies = dependRecs.size() - rec.firstDependency;
+		}
+
+		archiveRecs.push_back(rec);
+	}
+
+	for (const BrokenArchive& ba: brokenArchives) {
+		BinBrokenArchiveRecord rec;
+		rec.name = strings.Add(ba.name);
+		rec.path = strings.Add(ba.path);
+		rec.problem = strings.Add(ba.problem);
+		rec.modified = ba.modified;
+		brokenRecs.push_back(rec);
+	}
+
+	// never empty, readers rely on the table being zero-terminated
+	strings.Add("");
+
+	const std::vector<char>& stringData = strings.GetData();
+
+	std::vector<char> data;
+	data.reserve(
+		archiveRecs.size()  * sizeof(BinArchiveRecord      ) +
+		brokenRecs.size()   * sizeof(BinBrokenArchiveRecord) +
+		infoItemRecs.size() * sizeof(BinInfoItemRecord     ) +
+		dependRecs.size()   * sizeof(uint32_t              ) +
+		stringData.size()
+	);
+
+	const auto AppendData = [&](const void* p, size_t size) { data.insert(data.end(), reinterpret_cast<const char*>(p), reinterpret_cast<const char*>(p) + size); };
+
+	AppendData(archiveRecs.data(), archiveRecs.size() * sizeof(BinArchiveRecord));
+	AppendData(brokenRecs.data(), brokenRecs.size() * sizeof(BinBrokenArchiveRecord));
+	AppendData(infoItemRecs.data(), infoItemRecs.size() * sizeof(BinInfoItemRecord));
+	AppendData(dependRecs.data(), dependRecs.size() * sizeof(uint32_t));
+	AppendData(stringData.data(), stringData.size());
+
+	BinCacheHeader header;
+	std::memcpy(header.magic, BINARY_CACHE_MAGIC, sizeof(header.magic));
+	header.formatVersion = BINARY_CACHE_VER;
+	header.internalVersion = INTERNAL_VER;
+	header.numArchives = archiveRecs.size();
+	header.numBrokenArchives = brokenRecs.size();
+	header.numInfoItems = infoItemRecs.size();
+	header.numDependencies = dependRecs.size();
+	header.stringsSize = stringData.size();
+	header.dataSize = data.size();
+	header.dataCRC = CRC::CalcDigest(data.data(), data.size());
+
+	FILE* out = fopen(filename.c_str(), "wb");
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return false;
+	}
+
+	bool ok = true;
+	ok &= (fwrite(&header, sizeof(header), 1, out) == 1);
+	ok &= (fwrite(data.data(), 1, data.size(), out) == data.size());
+	ok &= (fclose(out) != EOF);
+
+	if (!ok)
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+
+	return ok;
+}
+
+bool CArchiveScanner::WriteCacheDataLua(const std::string& filename)
+{
+	FILE* out = fopen(filename.c_str(), "wt");
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return false;
+	}
 
 	fprintf(out, "local archiveCache = {\n\n");
 	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
@@ -1179,10 +1695,12 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	fprintf(out, "}\n\n"); // close 'archiveCache'
 	fprintf(out, "return archiveCache\n");
 
-	if (fclose(out) == EOF)
+	if (fclose(out) == EOF) {
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return false;
+	}
 
-	isDirty = false;
+	return true;
 }
 
 
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "System/Info.h"
+#include "System/FileSystem/FileHashCache.h"
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
@@ -184,6 +185,12 @@ private:
 		uint32_t modified = 0;
 		bool updated = false;
 	};
+	struct ArchiveScanResult {
+		ArchiveInfo archiveInfo;
+		BrokenArchive brokenArchive;
+
+		bool isBroken = false;
+	};
 
 private:
 	ArchiveInfo& GetAddArchiveInfo(const std::string& lcfn);
@@ -192,6 +199,14 @@ private:
 	void ScanDirs(const std::vector<std::string>& dirs);
 	void ScanDir(const std::string& curPath, std::deque<std::string>& foundArchives);
 
+	/**
+	 * open and inspect an archive that is not (validly) cached; touches no
+	 * scanner state other than the file-hash cache, so ScanDirs runs this
+	 * for multiple archives concurrently
+	 */
+	void ScanArchiveContents(const std::string& fullName, unsigned int modifiedTime, bool doChecksum, ArchiveScanResult& result);
+	void AddScanResult(ArchiveScanResult& result);
+
 	/// scan mapinfo / modinfo lua files
 	bool ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err);
 
@@ -202,9 +217,18 @@ private:
 	std::string SearchMapFile(const IArchive* ar, std::string& error);
 
 
+	/// reads the binary cache, or the Lua one if <filename> is missing or invalid
 	void ReadCacheData(const std::string& filename);
+	/// writes the binary cache (and the Lua one if ArchiveCacheLuaExport is set)
 	void WriteCacheData(const std::string& filename);
 
+	bool ReadCacheDataBin(const std::string& filename);
+	bool ReadCacheDataLua(const std::string& filename);
+	bool WriteCacheDataBin(const std::string& filename);
+	bool WriteCacheDataLua(const std::string& filename);
+
+	static std::string GetCacheFileName(const char* ext);
+
 	IFileFilter* CreateIgnoreFilter(IArchive* ar);
 
 	/**
@@ -245,6 +269,8 @@ private:
 
 	std::string cachefile;
 
+	CFileHashCache fileHashCache;
+
 	bool isDirty = false;
 	bool isInScan = false;
 };
@@ -41,6 +41,46 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 		return (ret == 1);
 	}
 
+	const FileBuffer& fb = GetCachedFile(fid, ret);
+
+	if (!fb.exists) {
+		LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][!fb.exists] name=%s ret=%d size=" _STPF_, __func__, fid, archiveFile.c_str(), ret, fb.data->size());
+		return false;
+	}
+
+	buffer.assign(fb.data->begin(), fb.data->end());
+	return true;
+}
+
+bool CBufferedArchive::GetFileView(unsigned int fid, CFileView& view)
+{
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	if (!UseCache())
+		return false;
+
+	int ret = 0;
+
+	const FileBuffer& fb = GetCachedFile(fid, ret);
+
+	// let GetFile handle (and report) missing files
+	if (!fb.exists || fb.data->empty())
+		return false;
+
+	view = CFileView(fb.data->data(), fb.data->size(), fb.data);
+	return true;
+}
+
+
+bool CBufferedArchive::UseCache() const
+{
+	// engine-only
+	return (!noCache && globalConfig.vfsCacheArchiveFiles);
+}
+
+const CBufferedArchive::FileBuffer& CBufferedArchive::GetCachedFile(unsigned int fid, int& ret)
+{
 	// NumFiles is virtual, can't do this in ctor
 	if (fileCache.empty())
 		fileCache.resize(NumFiles());
@@ -48,22 +88,13 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 	FileBuffer& fb = fileCache.at(fid);
 
 	if (!fb.populated) {
-		fb.exists = ((ret = GetFileImpl(fid, fb.data)) == 1);
+		fb.data = std::make_shared< std::vector<std::uint8_t> >();
+		fb.exists = ((ret = GetFileImpl(fid, *fb.data)) == 1);
 		fb.populated = true;
 
-		cacheSize += fb.data.size();
+		cacheSize += fb.data->size();
 		fileCount += fb.exists;
 	}
 
-	if (!fb.exists) {
-		LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][!fb.exists] name=%s ret=%d size=" _STPF_, __func__, fid, archiveFile.c_str(), ret, fb.data.size());
-		return false;
-	}
-
-	if (buffer.size() != fb.data.size())
-		buffer.resize(fb.data.size());
-
-	// TODO: zero-copy access
-	std::copy(fb.data.begin(), fb.data.end(), buffer.begin());
-	return true;
+	return fb;
 }
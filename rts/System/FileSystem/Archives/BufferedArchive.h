@@ -22,6 +22,8 @@ public:
 	virtual int GetType() const override { return ARCHIVE_TYPE_BUF; }
 
 	bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
+	/// views reference the cached copy, only available if caching is enabled
+	bool GetFileView(unsigned int fid, CFileView& view) override;
 
 protected:
 	virtual int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) = 0;
@@ -37,9 +39,14 @@ protected:
 		bool populated = false; // files may be empty (0 bytes)
 		bool exists = false;
 
-		std::vector<std::uint8_t> data;
+		// shared with all views of this file
+		std::shared_ptr< std::vector<std::uint8_t> > data;
 	};
 
+	bool UseCache() const;
+	/// must be called with archiveLock held
+	const FileBuffer& GetCachedFile(unsigned int fid, int& ret);
+
 	// indexed by file-id
 	std::vector<FileBuffer> fileCache;
 	// neither 7zip (.sd7) nor minizip (.sdz) are thread-safe
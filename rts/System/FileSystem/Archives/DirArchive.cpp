@@ -42,11 +42,17 @@ CDirArchive::CDirArchive(const std::string& archiveName)
 }
 
 
+std::string CDirArchive::GetFileRawPath(unsigned int fid) const
+{
+	assert(IsFileId(fid));
+	return (dataDirsAccess.LocateFile(dirName + searchFiles[fid]));
+}
+
 bool CDirArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 {
 	assert(IsFileId(fid));
 
-	const std::string rawpath = dataDirsAccess.LocateFile(dirName + searchFiles[fid]);
+	const std::string rawpath = GetFileRawPath(fid);
 	std::ifstream ifs(rawpath.c_str(), std::ios::in | std::ios::binary);
 
 	if (ifs.bad() || !ifs.is_open())
@@ -63,6 +69,24 @@ bool CDirArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	return true;
 }
 
+bool CDirArchive::GetFileView(unsigned int fid, CFileView& view)
+{
+	assert(IsFileId(fid));
+
+	const std::string rawPath = GetFileRawPath(fid);
+
+	if (FileSystem::GetFileSize(rawPath) < CMappedFile::MIN_MAPPED_SIZE)
+		return false;
+
+	const std::shared_ptr<const CMappedFile> mappedFile = CMappedFile::Open(rawPath);
+
+	if (mappedFile == nullptr)
+		return false;
+
+	view = CMappedFile::GetView(mappedFile, 0, mappedFile->GetSize());
+	return true;
+}
+
 void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
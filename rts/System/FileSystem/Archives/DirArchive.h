@@ -37,7 +37,10 @@ public:
 
 	unsigned int NumFiles() const override { return (searchFiles.size()); }
 	bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
+	/// maps files of at least CMappedFile::MIN_MAPPED_SIZE bytes
+	bool GetFileView(unsigned int fid, CFileView& view) override;
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
+	std::string GetFileRawPath(unsigned int fid) const override;
 	const std::string& GetOrigFileName(unsigned int fid) const { return searchFiles[fid]; }
 
 private:
@@ -0,0 +1,90 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FileView.h"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <windows.h>
+#endif
+
+
+std::shared_ptr<const CMappedFile> CMappedFile::Open(const std::string& fileName)
+{
+	std::shared_ptr<CMappedFile> file(new CMappedFile());
+
+	#ifndef _WIN32
+	const int fd = open(fileName.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return nullptr;
+
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || info.st_size <= 0 || uint64_t(info.st_size) > uint64_t(SIZE_MAX)) {
+		close(fd);
+		return nullptr;
+	}
+
+	void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// the mapping holds its own reference to the file
+	close(fd);
+
+	if (addr == MAP_FAILED)
+		return nullptr;
+
+	file->data = reinterpret_cast<const std::uint8_t*>(addr);
+	file->size = info.st_size;
+
+	#else
+	HANDLE fileHandle = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0 || uint64_t(fileSize.QuadPart) > uint64_t(SIZE_MAX)) {
+		CloseHandle(fileHandle);
+		return nullptr;
+	}
+
+	HANDLE mapHandle = CreateFileMapping(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	// the mapping holds its own reference to the file
+	CloseHandle(fileHandle);
+
+	if (mapHandle == nullptr)
+		return nullptr;
+
+	const void* addr = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (addr == nullptr) {
+		CloseHandle(mapHandle);
+		return nullptr;
+	}
+
+	file->data = reinterpret_cast<const std::uint8_t*>(addr);
+	file->size = fileSize.QuadPart;
+	file->mapHandle = mapHandle;
+	#endif
+
+	return file;
+}
+
+CMappedFile::~CMappedFile()
+{
+	if (data == nullptr)
+		return;
+
+	#ifndef _WIN32
+	munmap(const_cast<std::uint8_t*>(data), size);
+	#else
+	UnmapViewOfFile(data);
+	CloseHandle(mapHandle);
+	#endif
+}
@@ -0,0 +1,83 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FILE_VIEW_H
+#define _FILE_VIEW_H
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+
+/**
+ * Read-only view of the contents of a file which keeps its backing storage
+ * (a memory-mapped file or a buffer owned by an archive) alive for as long
+ * as any copy of the view exists. A default-constructed view is invalid;
+ * views are never created for empty files.
+ */
+class CFileView
+{
+public:
+	CFileView() = default;
+	CFileView(const std::uint8_t* data, size_t size, std::shared_ptr<const void> owner = nullptr)
+		: owner(std::move(owner))
+		, data(data)
+		, size(size)
+	{}
+
+	bool IsValid() const { return (data != nullptr); }
+
+	const std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+	const std::uint8_t* begin() const { return data; }
+	const std::uint8_t* end() const { return (data + size); }
+
+	void Reset() { *this = {}; }
+
+private:
+	std::shared_ptr<const void> owner;
+
+	const std::uint8_t* data = nullptr;
+	size_t size = 0;
+};
+
+
+/**
+ * A whole file mapped read-only into memory.
+ */
+class CMappedFile
+{
+public:
+	// small files are cheaper to read than to map (and unmap)
+	static constexpr size_t MIN_MAPPED_SIZE = 64 * 1024;
+
+	/// @return nullptr if <fileName> can not be mapped or is empty
+	static std::shared_ptr<const CMappedFile> Open(const std::string& fileName);
+
+	CMappedFile(const CMappedFile&) = delete;
+	~CMappedFile();
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+
+	const std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+	/// view of [offset, offset + length) which keeps this mapping alive
+	static CFileView GetView(const std::shared_ptr<const CMappedFile>& file, size_t offset, size_t length) {
+		if (file == nullptr || length == 0 || (offset + length) > file->size)
+			return {};
+
+		return {file->data + offset, length, file};
+	}
+
+private:
+	CMappedFile() = default;
+
+	const std::uint8_t* data = nullptr;
+	size_t size = 0;
+
+	#ifdef _WIN32
+	void* mapHandle = nullptr;
+	#endif
+};
+
+#endif // _FILE_VIEW_H
@@ -17,7 +17,13 @@ unsigned int IArchive::FindFile(const std::string& filePath) const
 
 bool IArchive::CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb)
 {
-	// NOTE: should be possible to avoid a re-read for buffered archives
+	CFileView view;
+
+	if (GetFileView(fid, view)) {
+		sha512::calc_digest(view.GetData(), view.GetSize(), hash);
+		return true;
+	}
+
 	if (!GetFile(fid, fb))
 		return false;
 
@@ -39,3 +45,13 @@ bool IArchive::GetFile(const std::string& name, std::vector<std::uint8_t>& buffe
 	return true;
 }
 
+
+bool IArchive::GetFileView(const std::string& name, CFileView& view)
+{
+	const unsigned int fid = FindFile(name);
+
+	if (!IsFileId(fid))
+		return false;
+
+	return (GetFileView(fid, view));
+}
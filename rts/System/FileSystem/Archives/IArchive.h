@@ -8,6 +8,7 @@
 #include <cinttypes>
 
 #include "ArchiveTypes.h"
+#include "FileView.h"
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
@@ -81,6 +82,20 @@ public:
 	 * @see GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	 */
 	bool GetFile(const std::string& name, std::vector<std::uint8_t>& buffer);
+	/**
+	 * Fetches the content of a file by its ID without copying it, if the
+	 * archive can serve it from memory (a mapped file or its own cache).
+	 * @param fid file ID in [0, NumFiles())
+	 * @param view on success, this will reference the contents of the file
+	 * @return false if no view is available (which includes empty files),
+	 *   GetFile has to be used then
+	 */
+	virtual bool GetFileView(unsigned int fid, CFileView& view) { return false; }
+	/**
+	 * Fetches the content of a file by its name without copying it.
+	 * @see GetFileView(unsigned int fid, CFileView& view)
+	 */
+	bool GetFileView(const std::string& name, CFileView& view);
 
 	std::pair<std::string, int> FileInfo(unsigned int fid) const {
 		std::pair<std::string, int> info;
@@ -121,10 +136,31 @@ public:
 	 * @return true if archive type can be packed solid (which is VERY slow when reading)
 	 */
 	virtual bool CheckForSolid() const { return false; }
+
+	/**
+	 * For archives storing files in solid blocks: appends the index and
+	 * unpacked size of each block that is not yet decompressed and cached.
+	 */
+	virtual void GetUncachedBlocks(std::vector< std::pair<unsigned int, size_t> >& blocks) {}
+	/**
+	 * Decompresses a solid block into the shared block cache ahead of use.
+	 * Thread-safe, different blocks may be prefetched concurrently.
+	 */
+	virtual bool PrefetchBlock(unsigned int blockIndex) { return false; }
+	/**
+	 * Releases all cached blocks (views referencing them remain valid).
+	 */
+	virtual void ClearBlockCache() {}
 	/**
 	 * Fetches the (SHA512) hash of a file by its ID.
 	 */
 	virtual bool CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb);
+	/**
+	 * Returns the path of the file on disk holding the contents of a file,
+	 * for archive types which store each file separately (pool, directory);
+	 * empty for all others. Used to cache hashes across archives.
+	 */
+	virtual std::string GetFileRawPath(unsigned int fid) const { return ""; }
 
 
 protected:
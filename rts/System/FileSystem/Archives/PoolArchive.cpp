@@ -123,12 +123,11 @@ CPoolArchive::~CPoolArchive()
 	}
 }
 
-int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer)
+std::string CPoolArchive::GetFileRawPath(unsigned int fid) const
 {
 	assert(IsFileId(fid));
 
-	FileData* f = &files[fid];
-	FileStat* s = &stats[fid];
+	const FileData* f = &files[fid];
 
 	constexpr const char table[] = "0123456789abcdef";
 	char c_hex[32];
@@ -141,9 +140,18 @@ int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffe
 	const std::string prefix(c_hex,      2);
 	const std::string pstfix(c_hex + 2, 30);
 
-	      std::string rpath = poolRootDir + "/pool/" + prefix + "/" + pstfix + ".gz";
-	const std::string  path = FileSystem::FixSlashes(rpath);
+	std::string rpath = poolRootDir + "/pool/" + prefix + "/" + pstfix + ".gz";
+	return (FileSystem::FixSlashes(rpath));
+}
+
+int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer)
+{
+	assert(IsFileId(fid));
+
+	FileData* f = &files[fid];
+	FileStat* s = &stats[fid];
 
+	const std::string path = GetFileRawPath(fid);
 	const spring_time startTime = spring_now();
 
 
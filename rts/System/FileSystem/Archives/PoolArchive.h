@@ -101,6 +101,9 @@ public:
 		return (memcmp(fd.shasum.data(), dummyFileHash.data(), sizeof(fd.shasum)) != 0);
 	}
 
+	/// pool/xx/yyyy.gz, shared between all archives referencing the same contents
+	std::string GetFileRawPath(unsigned int fid) const override;
+
 protected:
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 
@@ -13,6 +13,7 @@ extern "C" {
 }
 
 #include "System/CRC.h"
+#include "System/GlobalConfig.h"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 
@@ -181,9 +182,18 @@ CSevenZipArchive::CSevenZipArchive(const std::string& name): CBufferedArchive(na
 
 	fileEntries.reserve(db.db.NumFiles);
 
+	// unpacked bytes preceding the next file of each block
+	std::vector<size_t> blockOffsets(db.db.NumFolders, 0);
+
 	// Get contents of archive and store name->int mapping
 	for (unsigned int i = 0; i < db.db.NumFiles; ++i) {
 		const CSzFileItem* f = db.db.Files + i;
+		const UInt32 folderIndex = db.FileIndexToFolderIndexMap[i];
+		const size_t blockOffset = (folderIndex != NO_BLOCK)? blockOffsets[folderIndex]: 0;
+
+		if (folderIndex != NO_BLOCK)
+			blockOffsets[folderIndex] += f->Size;
+
 		if (f->IsDir)
 			continue;
 
@@ -204,10 +214,10 @@ CSevenZipArchive::CSevenZipArchive(const std::string& name): CBufferedArchive(na
 		fd.fp = i;
 		fd.size = f->Size;
 		fd.crc = (f->Size > 0) ? f->Crc: 0;
+		fd.blockIndex = folderIndex;
+		fd.blockOffset = blockOffset;
 
-		const UInt32 folderIndex = db.FileIndexToFolderIndexMap[i];
-
-		if (folderIndex == ((UInt32)-1)) {
+		if (folderIndex == NO_BLOCK) {
 			// file has no folder assigned
 			fd.unpackedSize = f->Size;
 			fd.packedSize   = f->Size;
@@ -226,8 +236,7 @@ CSevenZipArchive::~CSevenZipArchive()
 {
 	std::lock_guard<spring::mutex> lck(archiveLock);
 
-	if (outBuffer != nullptr)
-		IAlloc_Free(&allocImp, outBuffer);
+	solidBlockCache.Clear(this);
 
 	if (isOpen)
 		File_Close(&archiveStream.file);
@@ -241,17 +250,161 @@ int CSevenZipArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& b
 	// assert(archiveLock.locked());
 	assert(IsFileId(fid));
 
-	size_t offset = 0;
-	size_t outSizeProcessed = 0;
+	const FileEntry& fe = fileEntries[fid];
+
+	// empty file
+	if (fe.blockIndex == NO_BLOCK) {
+		buffer.clear();
+		return 1;
+	}
 
-	if (SzArEx_Extract(&db, &lookStream.s, fileEntries[fid].fp, &blockIndex, &outBuffer, &outBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp) != SZ_OK)
+	const BlockData block = GetBlock(fe.blockIndex);
+
+	if (block == nullptr || !CheckFileCRC(fid, *block))
 		return 0;
 
-	buffer.resize(outSizeProcessed);
-	memcpy(buffer.data(), reinterpret_cast<char*>(outBuffer) + offset, outSizeProcessed);
+	buffer.assign(block->begin() + fe.blockOffset, block->begin() + fe.blockOffset + fe.size);
 	return 1;
 }
 
+bool CSevenZipArchive::GetFileView(unsigned int fid, CFileView& view)
+{
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	const FileEntry& fe = fileEntries[fid];
+
+	if (fe.blockIndex == NO_BLOCK || fe.size <= 0)
+		return false;
+
+	const BlockData block = GetBlock(fe.blockIndex);
+
+	if (block == nullptr || !CheckFileCRC(fid, *block))
+		return false;
+
+	view = CFileView(block->data() + fe.blockOffset, fe.size, block);
+	return true;
+}
+
+
+bool CSevenZipArchive::CheckFileCRC(unsigned int fid, const std::vector<std::uint8_t>& block) const
+{
+	const FileEntry& fe = fileEntries[fid];
+	const CSzFileItem* f = db.db.Files + fe.fp;
+
+	if ((fe.blockOffset + fe.size) > block.size())
+		return false;
+
+	return (!f->CrcDefined || CrcCalc(block.data() + fe.blockOffset, fe.size) == f->Crc);
+}
+
+bool CSevenZipArchive::DecodeBlock(UInt32 blockIndex, ILookInStream* stream, std::vector<std::uint8_t>& data)
+{
+	// only reads from db, so this is safe to call concurrently given distinct streams
+	CSzFolder* folder = db.db.Folders + blockIndex;
+
+	const UInt64 unpackSize = SzFolder_GetUnpackSize(folder);
+	const UInt64 startOffset = SzArEx_GetFolderStreamPos(&db, blockIndex, 0);
+
+	if (unpackSize != UInt64(size_t(unpackSize)))
+		return false;
+
+	data.resize(unpackSize);
+
+	if (LookInStream_SeekTo(stream, startOffset) != SZ_OK)
+		return false;
+
+	const UInt64* packSizes = db.db.PackSizes + db.FolderStartPackStreamIndex[blockIndex];
+
+	if (SzFolder_Decode(folder, packSizes, stream, startOffset, data.data(), data.size(), &allocTempImp) != SZ_OK)
+		return false;
+
+	return (!folder->UnpackCRCDefined || CrcCalc(data.data(), data.size()) == folder->UnpackCRC);
+}
+
+
+CSevenZipArchive::BlockData CSevenZipArchive::GetBlock(UInt32 blockIndex)
+{
+	BlockData block = solidBlockCache.Find(this, blockIndex);
+
+	if (block != nullptr)
+		return block;
+
+	block = std::make_shared< std::vector<std::uint8_t> >();
+
+	if (!DecodeBlock(blockIndex, &lookStream.s, *block)) {
+		LOG_L(L_WARNING, "[7zArchive::%s] failed to decompress block %u of \"%s\"", __func__, blockIndex, archiveFile.c_str());
+		return nullptr;
+	}
+
+	return (InsertCachedBlock(blockIndex, block));
+}
+
+CSevenZipArchive::BlockData CSevenZipArchive::InsertCachedBlock(UInt32 blockIndex, const BlockData& data)
+{
+	const size_t maxCacheSize = std::max(globalConfig.vfsSolidBlockCacheSize, 0) * size_t(1024 * 1024);
+
+	return (solidBlockCache.Insert(this, blockIndex, data, maxCacheSize));
+}
+
+
+void CSevenZipArchive::GetUncachedBlocks(std::vector< std::pair<unsigned int, size_t> >& blocks)
+{
+	if (!isOpen)
+		return;
+
+	for (unsigned int i = 0; i < db.db.NumFolders; i++) {
+		if (solidBlockCache.Contains(this, i))
+			continue;
+
+		const UInt64 unpackSize = SzFolder_GetUnpackSize(db.db.Folders + i);
+
+		if (unpackSize == 0)
+			continue;
+
+		blocks.emplace_back(i, unpackSize);
+	}
+}
+
+bool CSevenZipArchive::PrefetchBlock(unsigned int blockIndex)
+{
+	if (!isOpen || blockIndex >= db.db.NumFolders)
+		return false;
+
+	if (solidBlockCache.Contains(this, blockIndex))
+		return true;
+
+	// lookStream belongs to GetFileImpl, use a private one
+	CFileInStream fileStream;
+	CLookToRead fileLookStream;
+
+	if (InFile_Open(&fileStream.file, archiveFile.c_str()) != 0)
+		return false;
+
+	FileInStream_CreateVTable(&fileStream);
+	LookToRead_CreateVTable(&fileLookStream, False);
+
+	fileLookStream.realStream = &fileStream.s;
+	LookToRead_Init(&fileLookStream);
+
+	BlockData block = std::make_shared< std::vector<std::uint8_t> >();
+
+	const bool ret = DecodeBlock(blockIndex, &fileLookStream.s, *block);
+
+	File_Close(&fileStream.file);
+
+	if (ret)
+		InsertCachedBlock(blockIndex, block);
+
+	return ret;
+}
+
+void CSevenZipArchive::ClearBlockCache()
+{
+	solidBlockCache.Clear(this);
+}
+
+
 void CSevenZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
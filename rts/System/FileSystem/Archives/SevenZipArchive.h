@@ -10,9 +10,11 @@ extern "C" {
 
 #include "IArchiveFactory.h"
 #include "BufferedArchive.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include "IArchive.h"
+#include "SolidBlockCache.h"
 
 /**
  * Creates LZMA/7zip compressed, single-file archives.
@@ -44,6 +46,12 @@ public:
 	unsigned int NumFiles() const override { return (fileEntries.size()); }
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
+	/// views reference the cached solid block containing the file
+	bool GetFileView(unsigned int fid, CFileView& view) override;
+
+	void GetUncachedBlocks(std::vector< std::pair<unsigned int, size_t> >& blocks) override;
+	bool PrefetchBlock(unsigned int blockIndex) override;
+	void ClearBlockCache() override;
 
 	#if 0
 	unsigned GetCrc32(unsigned int fid) {
@@ -53,8 +61,19 @@ public:
 	#endif
 
 private:
+	typedef CSolidBlockCache::BlockData BlockData;
+
 	int GetFileName(const CSzArEx* db, int i);
 
+	/// decompresses (and checks) a whole solid block, reading from <stream>
+	bool DecodeBlock(UInt32 blockIndex, ILookInStream* stream, std::vector<std::uint8_t>& data);
+	/// returns the cached block or decodes it through lookStream (caller has archiveLock)
+	BlockData GetBlock(UInt32 blockIndex);
+	/// adds a decoded block to solidBlockCache, returns the cached copy
+	BlockData InsertCachedBlock(UInt32 blockIndex, const BlockData& data);
+	/// checks the CRC of file <fid> within its block
+	bool CheckFileCRC(unsigned int fid, const std::vector<std::uint8_t>& block) const;
+
 private:
 	/**
 	 * How much more unpacked data may be allowed in a solid block,
@@ -100,14 +119,20 @@ private:
 		 * @see #unpackedSize
 		 */
 		int packedSize;
+
+		/// solid block ("folder") holding the file, NO_BLOCK if empty
+		UInt32 blockIndex;
+		/// position of the file's data within the unpacked block
+		size_t blockOffset;
 	};
 
-	std::vector<FileEntry> fileEntries;
+	static constexpr UInt32 NO_BLOCK = UInt32(-1);
 
-	UInt32 blockIndex = 0xFFFFFFFF;
-	size_t outBufferSize = 0;
+	// decompressed solid blocks are kept in solidBlockCache, the least
+	// recently used ones of all archives are released once more than
+	// VFSSolidBlockCacheSize MB are held
+	std::vector<FileEntry> fileEntries;
 
-	Byte* outBuffer = nullptr;
 	// used for file names
 	UInt16 tempBuffer[2048];
 
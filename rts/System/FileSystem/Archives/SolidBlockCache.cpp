@@ -0,0 +1,98 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SolidBlockCache.h"
+
+CSolidBlockCache solidBlockCache;
+
+
+CSolidBlockCache::BlockData CSolidBlockCache::Find(const void* archive, unsigned int blockIndex)
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+
+	const auto it = blocks.find({archive, blockIndex});
+
+	if (it == blocks.end())
+		return nullptr;
+
+	it->second.lastUse = ++tick;
+	return it->second.data;
+}
+
+bool CSolidBlockCache::Contains(const void* archive, unsigned int blockIndex) const
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+	return (blocks.find({archive, blockIndex}) != blocks.end());
+}
+
+
+CSolidBlockCache::BlockData CSolidBlockCache::Insert(const void* archive, unsigned int blockIndex, const BlockData& data, size_t maxSize)
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+
+	const auto ret = blocks.emplace(BlockKey{archive, blockIndex}, CachedBlock{});
+	CachedBlock& cb = ret.first->second;
+
+	cb.lastUse = ++tick;
+
+	// decoded concurrently by a prefetch
+	if (!ret.second)
+		return cb.data;
+
+	cb.data = data;
+	size += data->size();
+
+	while (size > maxSize) {
+		auto lruBlock = blocks.end();
+
+		for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+			if (it == ret.first)
+				continue;
+			if (lruBlock == blocks.end() || it->second.lastUse < lruBlock->second.lastUse)
+				lruBlock = it;
+		}
+
+		if (lruBlock == blocks.end())
+			break;
+
+		size -= lruBlock->second.data->size();
+		blocks.erase(lruBlock);
+	}
+
+	return data;
+}
+
+
+void CSolidBlockCache::Clear(const void* archive)
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+
+	const auto beg = blocks.lower_bound({archive, 0u});
+	      auto end = beg;
+
+	for (; end != blocks.end() && end->first.first == archive; ++end) {
+		size -= end->second.data->size();
+	}
+
+	blocks.erase(beg, end);
+}
+
+void CSolidBlockCache::Clear()
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+
+	blocks.clear();
+	size = 0;
+}
+
+
+size_t CSolidBlockCache::GetSize() const
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+	return size;
+}
+
+size_t CSolidBlockCache::GetNumBlocks() const
+{
+	std::lock_guard<spring::mutex> lck(mutex);
+	return blocks.size();
+}
@@ -0,0 +1,63 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SOLID_BLOCK_CACHE_H
+#define _SOLID_BLOCK_CACHE_H
+
+#include <cinttypes>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "System/Threading/SpringThreading.h"
+
+/**
+ * Decompressed solid blocks of all open archives, shared so that a single
+ * size budget applies to all of them. Blocks are keyed by their archive
+ * and index; once the budget is exceeded the least recently used blocks
+ * of any archive are released. Blocks still referenced elsewhere (e.g.
+ * by file-views) stay alive until those references are gone.
+ */
+class CSolidBlockCache
+{
+public:
+	typedef std::shared_ptr< std::vector<std::uint8_t> > BlockData;
+
+	/// returns nullptr if the block is not cached, marks it as used otherwise
+	BlockData Find(const void* archive, unsigned int blockIndex);
+	bool Contains(const void* archive, unsigned int blockIndex) const;
+
+	/**
+	 * Adds a block and then releases least recently used blocks until no
+	 * more than maxSize bytes are held; the new block itself is always kept
+	 * (like the single one the 7z API would keep). If the block was cached
+	 * concurrently in the meantime, the existing copy is kept and returned.
+	 */
+	BlockData Insert(const void* archive, unsigned int blockIndex, const BlockData& data, size_t maxSize);
+
+	/// releases all blocks of one archive
+	void Clear(const void* archive);
+	/// releases all blocks
+	void Clear();
+
+	size_t GetSize() const;
+	size_t GetNumBlocks() const;
+
+private:
+	typedef std::pair<const void*, unsigned int> BlockKey;
+
+	struct CachedBlock {
+		BlockData data;
+		std::uint64_t lastUse = 0;
+	};
+
+	std::map<BlockKey, CachedBlock> blocks;
+	mutable spring::mutex mutex;
+
+	size_t size = 0;
+	std::uint64_t tick = 0;
+};
+
+extern CSolidBlockCache solidBlockCache;
+
+#endif // _SOLID_BLOCK_CACHE_H
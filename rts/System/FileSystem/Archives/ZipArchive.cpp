@@ -81,6 +81,64 @@ void CZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 }
 
 
+bool CZipArchive::GetFileView(unsigned int fid, CFileView& view)
+{
+	{
+		std::lock_guard<spring::mutex> lck(archiveLock);
+
+		if (GetStoredFileView(fid, view))
+			return true;
+	}
+
+	return (CBufferedArchive::GetFileView(fid, view));
+}
+
+bool CZipArchive::GetStoredFileView(unsigned int fid, CFileView& view)
+{
+	if (zip == nullptr || mappingFailed)
+		return false;
+
+	assert(IsFileId(fid));
+
+	if (fileEntries[fid].size < int(CMappedFile::MIN_MAPPED_SIZE))
+		return false;
+
+	unzGoToFilePos(zip, &fileEntries[fid].fp);
+
+	unz_file_info fi;
+	unzGetCurrentFileInfo(zip, &fi, nullptr, 0, nullptr, 0, nullptr, 0);
+
+	// only entries that are neither compressed nor encrypted are stored verbatim
+	if (fi.compression_method != 0 || (fi.flag & 1) != 0)
+		return false;
+
+	// opening the entry skips its local header, the data follows directly
+	if (unzOpenCurrentFile(zip) != UNZ_OK)
+		return false;
+
+	const ZPOS64_T dataPos = unzGetCurrentFileZStreamPos64(zip);
+
+	unzCloseCurrentFile(zip);
+
+	if (mappedFile == nullptr)
+		mappingFailed = ((mappedFile = CMappedFile::Open(archiveFile)) == nullptr);
+
+	CFileView storedView = CMappedFile::GetView(mappedFile, dataPos, fi.uncompressed_size);
+
+	if (!storedView.IsValid())
+		return false;
+
+	// unzReadCurrentFile would have verified this as well
+	if (crc32(0, storedView.GetData(), storedView.GetSize()) != fi.crc) {
+		LOG_L(L_WARNING, "[%s] CRC mismatch for stored file \"%s\" in \"%s\"", __func__, fileEntries[fid].origName.c_str(), archiveFile.c_str());
+		return false;
+	}
+
+	view = std::move(storedView);
+	return true;
+}
+
+
 // To simplify things, files are always read completely into memory from
 // the zip-file, since zlib does not provide any way of reading more
 // than one file at a time
@@ -39,6 +39,8 @@ public:
 
 	unsigned int NumFiles() const override { return (fileEntries.size()); }
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
+	/// entries stored without compression are mapped, all others are cached
+	bool GetFileView(unsigned int fid, CFileView& view) override;
 
 	#if 0
 	unsigned int GetCrc32(unsigned int fid) {
@@ -60,6 +62,11 @@ protected:
 
 	std::vector<FileEntry> fileEntries;
 
+	// the archive itself, mapped on the first request for a stored entry
+	std::shared_ptr<const CMappedFile> mappedFile;
+	bool mappingFailed = false;
+
+	bool GetStoredFileView(unsigned int fid, CFileView& view);
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 };
 
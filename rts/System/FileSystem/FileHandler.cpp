@@ -92,6 +92,16 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 	if (vfsHandler == nullptr)
 		return (loadCode = -2, false);
 
+	// prefer referencing the archive's data over copying it
+	fileView.Reset();
+
+	if ((loadCode = vfsHandler->LoadFileView(StringToLower(fileName), fileView, (CVFSHandler::Section) section)) == 1) {
+		fileSize = fileView.GetSize();
+		return true;
+	}
+	if (loadCode < 0)
+		return false;
+
 	if ((loadCode = vfsHandler->LoadFile(StringToLower(fileName), fileBuffer, (CVFSHandler::Section) section)) == 1) {
 		// capacity can exceed size if FH was used to open more than one file
 		// assert(fileBuffer.size() == fileBuffer.capacity());
@@ -130,6 +140,7 @@ void CFileHandler::Close()
 
 	ifs.close();
 	fileBuffer.clear();
+	fileView.Reset();
 }
 
 
@@ -173,15 +184,15 @@ int CFileHandler::Read(void* buf, int length)
 		return ifs.gcount();
 	}
 
-	if (fileBuffer.empty())
+	if (!IsBuffered())
 		return 0;
 
 	if ((length + filePos) > fileSize)
 		length = fileSize - filePos;
 
 	if (length > 0) {
-		assert(fileBuffer.size() >= (filePos + length));
-		memcpy(buf, &fileBuffer[filePos], length);
+		assert(fileSize >= (filePos + length));
+		memcpy(buf, GetBufferData() + filePos, length);
 		filePos += length;
 	}
 
@@ -218,7 +229,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.seekg(length, where);
 		return;
 	}
-	if (fileBuffer.empty())
+	if (!IsBuffered())
 		return;
 
 	switch (where) {
@@ -234,7 +245,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open())
 		return ifs.eof();
 
-	if (!fileBuffer.empty())
+	if (IsBuffered())
 		return (filePos >= fileSize);
 
 	return true;
@@ -264,6 +275,29 @@ bool CFileHandler::LoadStringData(string& data)
 	return true;
 }
 
+std::vector<std::uint8_t>& CFileHandler::GetBuffer()
+{
+	if (fileView.IsValid()) {
+		fileBuffer.assign(fileView.begin(), fileView.end());
+		fileView.Reset();
+	}
+
+	return fileBuffer;
+}
+
+CFileView CFileHandler::GetBufferView() const
+{
+	if (fileView.IsValid())
+		return fileView;
+
+	if (fileBuffer.empty())
+		return {};
+
+	// not owning, only valid as long as fileBuffer is not modified
+	return {fileBuffer.data(), fileBuffer.size()};
+}
+
+
 std::string CFileHandler::GetFileExt() const
 {
 	return FileSystem::GetExtension(fileName);
@@ -9,6 +9,7 @@
 #include <cinttypes>
 
 #include "VFSModes.h"
+#include "Archives/FileView.h"
 
 /**
  * This is for direct VFS file content access.
@@ -37,7 +38,7 @@ public:
 	// true if any of TryReadFrom{RawFS,PWD,VFS} succeed
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
-	bool IsBuffered() const { return (!fileBuffer.empty()); }
+	bool IsBuffered() const { return (!fileBuffer.empty() || fileView.IsValid()); }
 
 	bool Eof() const;
 	int GetPos();
@@ -49,7 +50,10 @@ public:
 	static std::string GetFileAbsolutePath(const std::string& filePath, const std::string& modes);
 	static std::string GetArchiveContainingFile(const std::string& filePath, const std::string& modes);
 
-	std::vector<std::uint8_t>& GetBuffer() { return fileBuffer; }
+	/// copies the file contents if they are only referenced (see GetBufferView)
+	std::vector<std::uint8_t>& GetBuffer();
+	/// contents of a buffered file without copying them; invalid if !IsBuffered()
+	CFileView GetBufferView() const;
 
 	static bool InReadDir(const std::string& path);
 	static bool InWriteDir(const std::string& path);
@@ -72,12 +76,16 @@ protected:
 	static bool InsertRawFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern);
 	static bool InsertVFSFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern, int section);
 
+	const std::uint8_t* GetBufferData() const { return (fileView.IsValid()? fileView.GetData(): fileBuffer.data()); }
+
 	static bool InsertRawDirs(std::vector<std::string>& dirSet, const std::string& path, const std::string& pattern);
 	static bool InsertVFSDirs(std::vector<std::string>& dirSet, const std::string& path, const std::string& pattern, int section);
 
 	std::string fileName;
 	std::ifstream ifs;
 	std::vector<std::uint8_t> fileBuffer;
+	// set instead of fileBuffer if the archive could provide a view
+	CFileView fileView;
 
 	int filePos = 0;
 	int fileSize = -1;
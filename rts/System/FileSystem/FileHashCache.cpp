@@ -0,0 +1,202 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "FileHashCache.h"
+#include "FileSystemAbstraction.h"
+#include "System/CRC.h"
+#include "System/Log/ILog.h"
+
+/*
+ * File layout (native byte-order, like the binary ArchiveCache):
+ *   CacheHeader
+ *   per entry: uint64 size, uint32 modified, uint16 pathLength, uint8[SHA_LEN] hash, char[pathLength] path
+ * dataCRC covers everything following the header.
+ */
+constexpr static char FILEHASH_CACHE_MAGIC[8] = {'S', 'P', 'R', 'F', 'H', 'A', 'S', 'H'};
+constexpr static uint32_t FILEHASH_CACHE_VER = 1;
+
+struct CacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t dataSize;
+	uint32_t dataCRC;
+};
+
+constexpr static size_t ENTRY_FIXED_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint16_t) + sha512::SHA_LEN;
+
+
+bool CFileHashCache::GetFileStat(const std::string& path, FileStat& stat)
+{
+	const size_t size = FileSystemAbstraction::GetFileSize(path);
+
+	if (size == size_t(-1))
+		return false;
+
+	stat.size = size;
+	stat.modified = FileSystemAbstraction::GetFileModificationTime(path);
+	return (stat.modified != 0);
+}
+
+
+bool CFileHashCache::GetHash(const std::string& path, const FileStat& stat, uint8_t hash[sha512::SHA_LEN])
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	const auto it = entries.find(path);
+
+	if (it == entries.end() || !(it->second.stat == stat)) {
+		numMisses += 1;
+		return false;
+	}
+
+	std::memcpy(hash, it->second.hash.data(), sha512::SHA_LEN);
+
+	numHits += 1;
+	return true;
+}
+
+void CFileHashCache::SetHash(const std::string& path, const FileStat& stat, const uint8_t hash[sha512::SHA_LEN])
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	Entry& e = entries[path];
+	e.stat = stat;
+	std::memcpy(e.hash.data(), hash, sha512::SHA_LEN);
+
+	isDirty = true;
+}
+
+
+void CFileHashCache::Load(const std::string& fileName)
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	if (isLoaded)
+		return;
+
+	isLoaded = true;
+
+	FILE* in = fopen(fileName.c_str(), "rb");
+
+	if (in == nullptr)
+		return;
+
+	CacheHeader header;
+	std::vector<uint8_t> data;
+
+	// sizes in the header are only trusted as far as the file can back them
+	const size_t fileSize = FileSystemAbstraction::GetFileSize(fileName);
+
+	bool valid = (fread(&header, sizeof(header), 1, in) == 1);
+	valid = valid && (std::memcmp(header.magic, FILEHASH_CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == FILEHASH_CACHE_VER);
+	valid = valid && (fileSize != size_t(-1) && header.dataSize <= (fileSize - sizeof(header)));
+	valid = valid && (header.numEntries <= (header.dataSize / ENTRY_FIXED_SIZE));
+
+	if (valid) {
+		data.resize(header.dataSize);
+		valid = (fread(data.data(), 1, data.size(), in) == data.size());
+		valid = valid && (CRC::CalcDigest(data.data(), data.size()) == header.dataCRC);
+	}
+
+	fclose(in);
+
+	if (!valid) {
+		LOG_L(L_WARNING, "[FileHashCache::%s] ignoring invalid cache-file \"%s\"", __func__, fileName.c_str());
+		return;
+	}
+
+	entries.reserve(header.numEntries);
+
+	for (size_t i = 0, pos = 0; i < header.numEntries; i++) {
+		if ((pos + ENTRY_FIXED_SIZE) > data.size())
+			break;
+
+		Entry e;
+		uint16_t pathLength = 0;
+
+		std::memcpy(&e.stat.size    , &data[pos], sizeof(uint64_t)); pos += sizeof(uint64_t);
+		std::memcpy(&e.stat.modified, &data[pos], sizeof(uint32_t)); pos += sizeof(uint32_t);
+		std::memcpy(&pathLength     , &data[pos], sizeof(uint16_t)); pos += sizeof(uint16_t);
+		std::memcpy(e.hash.data()   , &data[pos], sha512::SHA_LEN ); pos += sha512::SHA_LEN;
+
+		if ((pos + pathLength) > data.size())
+			break;
+
+		entries[std::string(reinterpret_cast<const char*>(&data[pos]), pathLength)] = e;
+		pos += pathLength;
+	}
+
+	LOG("[FileHashCache::%s] loaded %u cached file-hashes", __func__, unsigned(entries.size()));
+}
+
+void CFileHashCache::Save(const std::string& fileName)
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	if (!isDirty)
+		return;
+
+	std::vector<uint8_t> data;
+	data.reserve(entries.size() * (ENTRY_FIXED_SIZE + 64));
+
+	const auto AppendData = [&](const void* p, size_t size) { data.insert(data.end(), reinterpret_cast<const uint8_t*>(p), reinterpret_cast<const uint8_t*>(p) + size); };
+
+	CacheHeader header;
+	std::memcpy(header.magic, FILEHASH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = FILEHASH_CACHE_VER;
+	header.numEntries = 0;
+
+	for (const auto& p: entries) {
+		if (p.first.size() > 0xFFFF)
+			continue;
+
+		const uint16_t pathLength = p.first.size();
+
+		AppendData(&p.second.stat.size, sizeof(uint64_t));
+		AppendData(&p.second.stat.modified, sizeof(uint32_t));
+		AppendData(&pathLength, sizeof(uint16_t));
+		AppendData(p.second.hash.data(), sha512::SHA_LEN);
+		AppendData(p.first.data(), pathLength);
+
+		header.numEntries += 1;
+	}
+
+	header.dataSize = data.size();
+	header.dataCRC = CRC::CalcDigest(data.data(), data.size());
+
+	FILE* out = fopen(fileName.c_str(), "wb");
+
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[FileHashCache::%s] failed to write to \"%s\"", __func__, fileName.c_str());
+		return;
+	}
+
+	bool ok = true;
+	ok &= (fwrite(&header, sizeof(header), 1, out) == 1);
+	ok &= (fwrite(data.data(), 1, data.size(), out) == data.size());
+	ok &= (fclose(out) != EOF);
+
+	if (!ok) {
+		LOG_L(L_ERROR, "[FileHashCache::%s] failed to write to \"%s\"", __func__, fileName.c_str());
+		return;
+	}
+
+	isDirty = false;
+}
+
+void CFileHashCache::Clear()
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	entries.clear();
+
+	numHits = 0;
+	numMisses = 0;
+
+	isLoaded = false;
+	isDirty = false;
+}
@@ -0,0 +1,67 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FILE_HASH_CACHE_H
+#define _FILE_HASH_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/SpringThreading.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * Persistent cache of SHA512 content-hashes for files that archives keep
+ * separately on disk (pool and directory archive members), keyed by path
+ * and validated against size and modification time. Different versions of
+ * a rapid game share most of their pool files, so checksumming a new one
+ * only has to read the files that actually changed.
+ *
+ * All methods are thread-safe.
+ */
+class CFileHashCache
+{
+public:
+	struct FileStat {
+		uint64_t size = 0;
+		uint32_t modified = 0;
+
+		bool operator == (const FileStat& s) const { return (size == s.size && modified == s.modified); }
+	};
+
+	/// @return false if <path> does not exist (nothing should be cached for it then)
+	static bool GetFileStat(const std::string& path, FileStat& stat);
+
+	bool GetHash(const std::string& path, const FileStat& stat, uint8_t hash[sha512::SHA_LEN]);
+	void SetHash(const std::string& path, const FileStat& stat, const uint8_t hash[sha512::SHA_LEN]);
+
+	/// loads <fileName> once, later calls are no-ops
+	void Load(const std::string& fileName);
+	/// writes the cache back if any hash was added since it was loaded
+	void Save(const std::string& fileName);
+
+	void Clear();
+
+	size_t GetNumHits() const { return numHits; }
+	size_t GetNumMisses() const { return numMisses; }
+
+private:
+	struct Entry {
+		FileStat stat;
+		std::array<uint8_t, sha512::SHA_LEN> hash;
+	};
+
+	spring::mutex mutex;
+	spring::unordered_map<std::string, Entry> entries;
+
+	// read without holding the mutex
+	std::atomic<size_t> numHits = {0};
+	std::atomic<size_t> numMisses = {0};
+
+	bool isLoaded = false;
+	bool isDirty = false;
+};
+
+#endif // _FILE_HASH_CACHE_H
@@ -67,6 +67,13 @@ bool CGZFileHandler::UncompressBuffer()
 	std::vector<std::uint8_t> compressed;
 	std::swap(compressed, fileBuffer);
 
+	// the compressed data may only be referenced
+	CFileView compressedView;
+	std::swap(compressedView, fileView);
+
+	if (!compressedView.IsValid())
+		compressedView = CFileView(compressed.data(), compressed.size());
+
 
 	z_stream zstream;
 	zstream.opaque = Z_NULL;
@@ -77,8 +84,8 @@ bool CGZFileHandler::UncompressBuffer()
 	//+16 marks it's a gzip header
 	inflateInit2(&zstream, 15 + 16);
 
-	zstream.next_in   = &compressed[0];
-	zstream.avail_in  = compressed.size();
+	zstream.next_in   = const_cast<Bytef*>(compressedView.GetData());
+	zstream.avail_in  = compressedView.GetSize();
 
 	std::uint8_t unzipBuffer[BUFFER_SIZE];
 
@@ -12,8 +12,12 @@
 #include "System/FileSystem/Archives/IArchive.h"
 #include "System/FileSystem/Archives/DirArchive.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Exceptions.h"
+#include "System/GlobalConfig.h"
 #include "System/Log/ILog.h"
+#include "System/MainDefines.h"
+#include "System/Misc/SpringTime.h"
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 
@@ -32,6 +36,9 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_VFS)
 // FileHandler::Open, while {Add,Remove}Archive are reached from multiple
 // places including LuaVFS
 static spring::recursive_mutex vfsMutex;
+// held while PrefetchArchives decompresses blocks without vfsMutex, archives
+// are only deleted with both held (always locked after vfsMutex)
+static spring::mutex prefetchMutex;
 
 
 static CVFSHandler* vfs = nullptr;
@@ -274,7 +281,11 @@ bool CVFSHandler::RemoveArchive(const std::string& archiveName)
 	}
 
 
-	delete ar;
+	{
+		std::lock_guard<decltype(prefetchMutex)> prefetchLock(prefetchMutex);
+		delete ar;
+	}
+
 	archives[section].erase(archivePath);
 	return true;
 }
@@ -301,6 +312,7 @@ void CVFSHandler::DeleteArchives(Section section)
 	LOG_L(L_INFO, "[%s::%s<this=%p>(section=%d)] #archives[section]=" _STPF_ " #files[section]=" _STPF_ "", vfsName, __func__, this, section, archives[section].size(), files[section].size());
 
 	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+	std::lock_guard<decltype(prefetchMutex)> prefetchLock(prefetchMutex);
 
 	for (const auto& p: archives[section]) {
 		LOG_L(L_INFO, "\tarchive=%s (%p)", (p.first).c_str(), p.second);
@@ -403,6 +415,77 @@ void CVFSHandler::SwapArchiveSections(Section src, Section dst)
 
 
 
+void CVFSHandler::PrefetchArchives(const std::vector<Section>& sections)
+{
+	std::unique_lock<decltype(vfsMutex)> lck(vfsMutex);
+
+	std::vector< std::pair<IArchive*, unsigned int> > prefetchBlocks;
+	std::vector< std::pair<unsigned int, size_t> > archiveBlocks;
+	std::vector<size_t> prefetchSizes;
+
+	// the block-cache is shared by all archives, so is its budget
+	const size_t maxCacheSize = std::max(globalConfig.vfsSolidBlockCacheSize, 0) * size_t(1024 * 1024);
+	size_t totalSize = 0;
+
+	for (const Section section: sections) {
+		for (const auto& p: archives[section]) {
+			archiveBlocks.clear();
+			p.second->GetUncachedBlocks(archiveBlocks);
+
+			// blocks beyond the cache budget would only evict earlier ones
+			for (const auto& block: archiveBlocks) {
+				if ((totalSize + block.second) > maxCacheSize)
+					break;
+
+				prefetchBlocks.emplace_back(p.second, block.first);
+				prefetchSizes.push_back(block.second);
+
+				totalSize += block.second;
+			}
+		}
+	}
+
+	if (prefetchBlocks.empty())
+		return;
+
+	// decompress without blocking other VFS users; archives can not be
+	// deleted in the meantime since that requires prefetchMutex as well
+	std::lock_guard<decltype(prefetchMutex)> prefetchLock(prefetchMutex);
+	lck.unlock();
+
+	// largest blocks first, they dominate the total time
+	std::vector<size_t> order(prefetchBlocks.size());
+
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return (prefetchSizes[a] > prefetchSizes[b]); });
+
+	const spring_time t0 = spring_gettime();
+
+	for_mt(0, order.size(), [&](const int i) {
+		const auto& block = prefetchBlocks[ order[i] ];
+
+		if (!block.first->PrefetchBlock(block.second))
+			LOG_L(L_WARNING, "[%s::%s] failed to prefetch block %u of \"%s\"", vfsName, __func__, block.second, block.first->GetArchiveFile().c_str());
+	});
+
+	LOG("[%s::%s] decompressed " _STPF_ " blocks (" _STPF_ " MB) in %ums", vfsName, __func__, prefetchBlocks.size(), totalSize >> 20, unsigned((spring_gettime() - t0).toMilliSecsi()));
+}
+
+void CVFSHandler::ClearArchiveBlockCaches()
+{
+	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+
+	for (const auto& sectionArchives: archives) {
+		for (const auto& p: sectionArchives) {
+			p.second->ClearBlockCache();
+		}
+	}
+}
+
+
 std::string CVFSHandler::GetNormalizedPath(const std::string& rawPath)
 {
 	std::string lcPath = std::move(StringToLower(rawPath));
@@ -458,6 +541,20 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	return (fileData.ar->GetFile(normalizedPath, buffer));
 }
 
+int CVFSHandler::LoadFileView(const std::string& filePath, CFileView& view, Section section)
+{
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+	const FileData& fileData = GetFileData(normalizedPath, section);
+
+	if (fileData.ar == nullptr)
+		return -1;
+
+	// 0 or 1
+	return (fileData.ar->GetFileView(normalizedPath, view));
+}
+
 int CVFSHandler::FileExists(const std::string& filePath, Section section)
 {
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
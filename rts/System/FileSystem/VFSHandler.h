@@ -11,6 +11,7 @@
 #include "System/UnorderedMap.hpp"
 
 class IArchive;
+class CFileView;
 
 /**
  * Main API for accessing the Virtual File System (VFS).
@@ -103,6 +104,15 @@ public:
 	 * @return 1 if the file exists in the VFS and was successfully read
 	 */
 	int LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
+	/**
+	 * References the contents of a file from within the VFS without copying
+	 * them, if the archive containing it supports this.
+	 * @param filePath raw file path, for example "maps/myMap.smf",
+	 *   case-insensitive
+	 * @return 1 if the file exists in the VFS and a view was obtained, 0 if
+	 *   it exists but LoadFile must be used instead, -1 otherwise
+	 */
+	int LoadFileView(const std::string& filePath, CFileView& view, Section section);
 
 
 	/**
@@ -154,6 +164,18 @@ public:
 	void DeleteArchives(Section section);
 	void ReserveArchives();
 
+	/**
+	 * Decompresses the solid blocks of all archives in the given sections
+	 * in parallel, as far as the shared block-cache can hold them; speeds
+	 * up loading many files from .sd7 archives afterwards. The VFS lock is
+	 * not held while decompressing.
+	 */
+	void PrefetchArchives(const std::vector<Section>& sections);
+	/**
+	 * Releases all prefetched or otherwise cached solid blocks.
+	 */
+	void ClearArchiveBlockCaches();
+
 	void UnMapArchives(bool reload = false);
 	void ReMapArchives(bool reload = false);
 	void SwapArchiveSections(Section src, Section dst);
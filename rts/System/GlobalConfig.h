@@ -106,6 +106,13 @@ public:
 	 */
 	bool vfsCacheArchiveFiles = true;
 
+	/**
+	 * @brief vfsSolidBlockCacheSize
+	 *
+	 * Maximum size in MB of decompressed solid blocks kept for all (7zip) archives
+	 */
+	int vfsSolidBlockCacheSize = 256;
+
 
 	/**
 	 * @brief teamHighlight
@@ -0,0 +1,712 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <zlib.h>
+
+#include "ChunkedStream.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
+
+// gzip member header with one extra subfield ("SC") holding the member size
+static constexpr size_t MEMBER_HEADER_SIZE = 10 + 2 + 4 + 4;
+// CRC32 and ISIZE
+static constexpr size_t MEMBER_TRAILER_SIZE = 4 + 4;
+
+
+static void WriteLE32(char* p, uint32_t v)
+{
+	p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t ReadLE32(const std::uint8_t* p)
+{
+	return (p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24));
+}
+
+
+
+void CChunkedStreamBuf::Pin(size_t offset, size_t size)
+{
+	SyncSize();
+
+	pinBeg = offset;
+	pinEnd = offset + size;
+}
+
+void CChunkedStreamBuf::Unpin()
+{
+	SyncSize();
+
+	pinBeg = 0;
+	pinEnd = 0;
+
+	ReleaseChunks(putChunk);
+}
+
+void CChunkedStreamBuf::Flush()
+{
+	SyncSize();
+
+	pinBeg = 0;
+	pinEnd = 0;
+
+	// drop chunks allocated past the end, e.g. by an overflow at a chunk boundary
+	chunks.resize((dataSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	released.resize(chunks.size());
+
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (released[i])
+			continue;
+
+		chunks[i].resize(std::min(CHUNK_SIZE, dataSize - i * CHUNK_SIZE));
+	}
+
+	setp(nullptr, nullptr);
+	setg(nullptr, nullptr, nullptr);
+
+	getBase = 0;
+	putChunk = chunks.size();
+
+	ReleaseChunks(chunks.size());
+}
+
+void CChunkedStreamBuf::SetChunks(std::vector<Chunk>&& newChunks)
+{
+	chunks = std::move(newChunks);
+	released.clear();
+	released.resize(chunks.size(), false);
+
+	dataSize = 0;
+	putChunk = 0;
+	getBase = 0;
+	releaseBeg = 0;
+
+	pinBeg = 0;
+	pinEnd = 0;
+
+	for (const Chunk& c: chunks) {
+		assert(&c == &chunks.back() || c.size() == CHUNK_SIZE);
+		dataSize += c.size();
+	}
+
+	numChunks = chunks.size();
+	peakChunks = std::max(peakChunks, numChunks);
+
+	setp(nullptr, nullptr);
+	setg(nullptr, nullptr, nullptr);
+}
+
+
+void CChunkedStreamBuf::SyncSize()
+{
+	if (pbase() == nullptr)
+		return;
+
+	dataSize = std::max(dataSize, putChunk * CHUNK_SIZE + (pptr() - pbase()));
+}
+
+void CChunkedStreamBuf::ReleaseChunks(size_t endChunk)
+{
+	if (chunkSink == nullptr)
+		return;
+
+	for (size_t i = releaseBeg, n = std::min(endChunk, chunks.size()); i < n; i++) {
+		if (released[i] || IsPinned(i))
+			continue;
+
+		chunkSink(i, std::move(chunks[i]));
+		chunks[i] = Chunk();
+		released[i] = true;
+		numChunks -= 1;
+	}
+
+	while (releaseBeg < released.size() && released[releaseBeg]) {
+		releaseBeg++;
+	}
+}
+
+
+bool CChunkedStreamBuf::SetPutPos(size_t pos)
+{
+	const size_t c = pos / CHUNK_SIZE;
+
+	while (chunks.size() <= c) {
+		chunks.emplace_back(CHUNK_SIZE);
+		released.push_back(false);
+
+		peakChunks = std::max(peakChunks, ++numChunks);
+	}
+
+	// can not rewrite data that was already handed to the sink
+	if (released[c])
+		return false;
+
+	chunks[c].resize(CHUNK_SIZE);
+
+	setp(chunks[c].data(), chunks[c].data() + CHUNK_SIZE);
+	pbump(pos - c * CHUNK_SIZE);
+
+	putChunk = c;
+	return true;
+}
+
+bool CChunkedStreamBuf::SetGetPos(size_t pos)
+{
+	if (pos > dataSize)
+		return false;
+
+	if (pos == dataSize) {
+		setg(nullptr, nullptr, nullptr);
+		getBase = pos;
+		return true;
+	}
+
+	const size_t c = pos / CHUNK_SIZE;
+
+	if (released[c])
+		return false;
+
+	char* base = chunks[c].data();
+
+	getBase = c * CHUNK_SIZE;
+	setg(base, base + (pos - getBase), base + std::min(CHUNK_SIZE, dataSize - getBase));
+	return true;
+}
+
+
+CChunkedStreamBuf::int_type CChunkedStreamBuf::overflow(int_type c)
+{
+	SyncSize();
+
+	const size_t pos = (pbase() == nullptr)? 0: (putChunk * CHUNK_SIZE + (pptr() - pbase()));
+
+	if (!SetPutPos(pos))
+		return traits_type::eof();
+
+	// put position has moved on to a new chunk, preceding ones are complete
+	ReleaseChunks(putChunk);
+
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+CChunkedStreamBuf::int_type CChunkedStreamBuf::underflow()
+{
+	SyncSize();
+
+	if (gptr() != nullptr && gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	if (!SetGetPos(getBase + (gptr() - eback())))
+		return traits_type::eof();
+	if (gptr() == egptr())
+		return traits_type::eof();
+
+	return traits_type::to_int_type(*gptr());
+}
+
+
+CChunkedStreamBuf::pos_type CChunkedStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	SyncSize();
+
+	off_type base = 0;
+
+	switch (dir) {
+		case std::ios_base::cur: {
+			if ((which & std::ios_base::out) != 0) {
+				base = (pbase() == nullptr)? 0: (putChunk * CHUNK_SIZE + (pptr() - pbase()));
+			} else {
+				base = getBase + (gptr() - eback());
+			}
+		} break;
+		case std::ios_base::end: {
+			base = dataSize;
+		} break;
+		default: {
+		} break;
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+CChunkedStreamBuf::pos_type CChunkedStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const off_type off = off_type(pos);
+
+	if (off < 0)
+		return pos_type(off_type(-1));
+
+	// tellp/tellg; avoid allocating a chunk just to report the position
+	if ((which & std::ios_base::out) != 0 && (pbase() == nullptr || size_t(off) != (putChunk * CHUNK_SIZE + (pptr() - pbase())))) {
+		if (!SetPutPos(off))
+			return pos_type(off_type(-1));
+	}
+	if ((which & std::ios_base::in) != 0) {
+		if (!SetGetPos(off))
+			return pos_type(off_type(-1));
+	}
+
+	return pos;
+}
+
+
+
+CParallelGZWriter::CParallelGZWriter(const std::string& fileName, int level, unsigned int numThreads, unsigned int maxQueuedChunks)
+	: file(fopen(fileName.c_str(), "wb"))
+	, maxQueued(maxQueuedChunks)
+	, level(level)
+{
+	if (file == nullptr)
+		return;
+
+	for (unsigned int i = 0, n = std::max(numThreads, 1u); i < n; i++) {
+		workers.emplace_back(&CParallelGZWriter::WorkerLoop, this);
+	}
+}
+
+
+void CParallelGZWriter::Push(size_t chunkIndex, CChunkedStreamBuf::Chunk&& chunk)
+{
+	if (file == nullptr)
+		return;
+
+	std::unique_lock<spring::mutex> lock(mutex);
+
+	spaceCond.wait(lock, [&]() { return (maxQueued == 0 || queue.size() < maxQueued); });
+	queue.emplace_back(chunkIndex, std::move(chunk));
+
+	numPushed += 1;
+	queueCond.notify_one();
+}
+
+bool CParallelGZWriter::Finish()
+{
+	if (file == nullptr)
+		return false;
+
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		finished = true;
+	}
+
+	queueCond.notify_all();
+
+	for (spring::thread& t: workers) {
+		t.join();
+	}
+
+	workers.clear();
+
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		WriteMembers();
+
+		failed |= (nextMemberIndex != numPushed);
+		failed |= (fclose(file) != 0);
+		file = nullptr;
+	}
+
+	return !failed;
+}
+
+
+void CParallelGZWriter::WorkerLoop()
+{
+	Threading::SetThreadName("gzwriter");
+
+	std::vector<char> member;
+
+	while (true) {
+		std::pair<size_t, CChunkedStreamBuf::Chunk> item;
+
+		{
+			std::unique_lock<spring::mutex> lock(mutex);
+			queueCond.wait(lock, [&]() { return (!queue.empty() || finished); });
+
+			if (queue.empty())
+				return;
+
+			item = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		spaceCond.notify_one();
+
+		const bool deflated = DeflateChunk(item.second, member, level);
+
+		// release the uncompressed data before waiting for the lock
+		item.second = CChunkedStreamBuf::Chunk();
+
+		std::lock_guard<spring::mutex> lock(mutex);
+
+		failed |= !deflated;
+		members.emplace(item.first, std::move(member));
+		member = std::vector<char>();
+
+		WriteMembers();
+	}
+}
+
+void CParallelGZWriter::WriteMembers()
+{
+	while (!members.empty() && members.begin()->first == nextMemberIndex) {
+		const std::vector<char>& m = members.begin()->second;
+
+		failed |= (fwrite(m.data(), 1, m.size(), file) != m.size());
+		compressedSize += m.size();
+
+		members.erase(members.begin());
+		nextMemberIndex += 1;
+	}
+}
+
+
+bool CParallelGZWriter::DeflateChunk(const CChunkedStreamBuf::Chunk& chunk, std::vector<char>& member, int level)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+
+	// raw deflate; the gzip framing is written by hand to include the member size
+	if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	member.resize(MEMBER_HEADER_SIZE + deflateBound(&zs, chunk.size()) + MEMBER_TRAILER_SIZE);
+
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+	zs.avail_in = chunk.size();
+	zs.next_out = reinterpret_cast<Bytef*>(member.data() + MEMBER_HEADER_SIZE);
+	zs.avail_out = member.size() - MEMBER_HEADER_SIZE - MEMBER_TRAILER_SIZE;
+
+	const int ret = deflate(&zs, Z_FINISH);
+	const size_t memberSize = MEMBER_HEADER_SIZE + zs.total_out + MEMBER_TRAILER_SIZE;
+
+	deflateEnd(&zs);
+
+	if (ret != Z_STREAM_END)
+		return false;
+
+	member.resize(memberSize);
+
+	char* header = member.data();
+	char* trailer = member.data() + memberSize - MEMBER_TRAILER_SIZE;
+
+	// ID1, ID2, CM=deflate, FLG=FEXTRA, MTIME, XFL, OS=unknown
+	const char fixedHeader[] = {'\x1f', '\x8b', '\x08', '\x04', 0, 0, 0, 0, 0, '\xff'};
+
+	memcpy(header, fixedHeader, sizeof(fixedHeader));
+	// XLEN, SI1, SI2, LEN, member size
+	header[10] = 8; header[11] = 0;
+	header[12] = 'S'; header[13] = 'C';
+	header[14] = 4; header[15] = 0;
+	WriteLE32(header + 16, memberSize);
+
+	WriteLE32(trailer + 0, crc32(0, reinterpret_cast<const Bytef*>(chunk.data()), chunk.size()));
+	WriteLE32(trailer + 4, chunk.size());
+	return true;
+}
+
+
+static bool InflateChunksSerial(const std::vector<std::uint8_t>& data, std::vector<CChunkedStreamBuf::Chunk>& chunks)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+
+	// accept any gzip file, including ones with multiple members
+	if (inflateInit2(&zs, MAX_WBITS + 16) != Z_OK)
+		return false;
+
+	zs.next_in = const_cast<Bytef*>(data.data());
+	zs.avail_in = data.size();
+
+	int ret = Z_OK;
+
+	while (ret == Z_OK) {
+		if (chunks.empty() || chunks.back().size() == CChunkedStreamBuf::CHUNK_SIZE)
+			chunks.emplace_back();
+
+		CChunkedStreamBuf::Chunk& chunk = chunks.back();
+		const size_t used = chunk.size();
+
+		chunk.resize(CChunkedStreamBuf::CHUNK_SIZE);
+
+		zs.next_out = reinterpret_cast<Bytef*>(chunk.data() + used);
+		zs.avail_out = CChunkedStreamBuf::CHUNK_SIZE - used;
+
+		ret = inflate(&zs, Z_NO_FLUSH);
+		chunk.resize(CChunkedStreamBuf::CHUNK_SIZE - zs.avail_out);
+
+		if (ret == Z_STREAM_END && zs.avail_in > 0)
+			ret = inflateReset(&zs);
+		// out of input without reaching the end of the stream
+		if (ret == Z_BUF_ERROR && zs.avail_out != 0)
+			break;
+		if (ret == Z_BUF_ERROR)
+			ret = Z_OK;
+	}
+
+	inflateEnd(&zs);
+
+	if (!chunks.empty() && chunks.back().empty())
+		chunks.pop_back();
+
+	return (ret == Z_STREAM_END);
+}
+
+// locates all members of a file written by CParallelGZWriter and checks
+// that all but the last inflate to exactly CHUNK_SIZE bytes
+static bool LocateMembers(const std::vector<std::uint8_t>& data, std::vector< std::pair<size_t, size_t> >& spans)
+{
+	spans.clear();
+
+	for (size_t pos = 0; pos < data.size(); ) {
+		const std::uint8_t* h = &data[pos];
+
+		if ((data.size() - pos) < (MEMBER_HEADER_SIZE + MEMBER_TRAILER_SIZE))
+			return false;
+		if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8 || h[3] != 4 || h[10] != 8 || h[11] != 0 || h[12] != 'S' || h[13] != 'C')
+			return false;
+
+		const size_t memberSize = ReadLE32(h + 16);
+
+		if (memberSize < (MEMBER_HEADER_SIZE + MEMBER_TRAILER_SIZE) || memberSize > (data.size() - pos))
+			return false;
+
+		spans.emplace_back(pos, memberSize);
+		pos += memberSize;
+	}
+
+	for (size_t i = 0; i < spans.size(); i++) {
+		const size_t inflatedSize = ReadLE32(&data[spans[i].first + spans[i].second - 4]);
+
+		if (inflatedSize > CChunkedStreamBuf::CHUNK_SIZE || (inflatedSize != CChunkedStreamBuf::CHUNK_SIZE && (i + 1) != spans.size()))
+			return false;
+	}
+
+	return true;
+}
+
+static size_t GetInflatedSize(const std::vector<std::uint8_t>& data, const std::pair<size_t, size_t>& span)
+{
+	return ReadLE32(&data[span.first + span.second - 4]);
+}
+
+static bool InflateMember(const std::vector<std::uint8_t>& data, const std::pair<size_t, size_t>& span, CChunkedStreamBuf::Chunk& chunk)
+{
+	const std::uint8_t* m = &data[span.first];
+	const size_t memberSize = span.second;
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+
+	chunk.resize(GetInflatedSize(data, span));
+
+	if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+		return false;
+
+	zs.next_in = const_cast<Bytef*>(m + MEMBER_HEADER_SIZE);
+	zs.avail_in = memberSize - MEMBER_HEADER_SIZE - MEMBER_TRAILER_SIZE;
+	zs.next_out = reinterpret_cast<Bytef*>(chunk.data());
+	zs.avail_out = chunk.size();
+
+	const int ret = inflate(&zs, Z_FINISH);
+	const uLong crc = crc32(0, reinterpret_cast<const Bytef*>(chunk.data()), chunk.size());
+
+	inflateEnd(&zs);
+
+	return (ret == Z_STREAM_END && zs.total_out == chunk.size() && crc == ReadLE32(m + memberSize - MEMBER_TRAILER_SIZE));
+}
+
+bool CParallelGZWriter::InflateChunks(const std::vector<std::uint8_t>& data, std::vector<CChunkedStreamBuf::Chunk>& chunks)
+{
+	std::vector< std::pair<size_t, size_t> > spans;
+
+	chunks.clear();
+
+	// fall back to a serial inflate for files not written by us
+	if (!LocateMembers(data, spans))
+		return InflateChunksSerial(data, chunks);
+
+	chunks.resize(spans.size());
+
+	std::atomic<bool> inflated = {true};
+
+	for_mt(0, spans.size(), [&](const int i) {
+		if (!InflateMember(data, spans[i], chunks[i]))
+			inflated = false;
+	});
+
+	if (!inflated)
+		chunks.clear();
+
+	return inflated;
+}
+
+
+
+bool CGZChunkStreamBuf::Open(std::vector<std::uint8_t>&& newData)
+{
+	Clear();
+
+	if (!LocateMembers(newData, spans))
+		return false;
+
+	data = std::move(newData);
+
+	chunks.resize(spans.size());
+	chunkUseTicks.resize(spans.size(), 0);
+
+	for (const auto& span: spans) {
+		dataSize += GetInflatedSize(data, span);
+	}
+
+	return true;
+}
+
+void CGZChunkStreamBuf::Clear()
+{
+	data.clear();
+	spans.clear();
+	chunks.clear();
+	chunkUseTicks.clear();
+
+	dataSize = 0;
+	getBase = 0;
+	numChunks = 0;
+
+	setg(nullptr, nullptr, nullptr);
+}
+
+
+bool CGZChunkStreamBuf::LoadChunk(size_t chunkIndex)
+{
+	if (chunkUseTicks[chunkIndex] != 0) {
+		chunkUseTicks[chunkIndex] = ++useTick;
+		return true;
+	}
+
+	// reading is mostly sequential, inflate the next few members along with this one
+	std::vector<size_t> loadIndices;
+
+	for (size_t i = chunkIndex, n = std::min(chunkIndex + READ_AHEAD_CHUNKS, chunks.size()); i < n; i++) {
+		if (chunkUseTicks[i] == 0)
+			loadIndices.push_back(i);
+	}
+
+	// make room by dropping the least recently used chunks; the caller resets
+	// the get area, so the current one can go as well
+	while ((numChunks + loadIndices.size()) > MAX_CACHED_CHUNKS) {
+		size_t lruIndex = 0;
+
+		for (size_t i = 0; i < chunks.size(); i++) {
+			if (chunkUseTicks[i] != 0 && (chunkUseTicks[lruIndex] == 0 || chunkUseTicks[i] < chunkUseTicks[lruIndex]))
+				lruIndex = i;
+		}
+
+		chunks[lruIndex] = CChunkedStreamBuf::Chunk();
+		chunkUseTicks[lruIndex] = 0;
+		numChunks -= 1;
+	}
+
+	std::atomic<bool> inflated = {true};
+
+	for_mt(0, loadIndices.size(), [&](const int i) {
+		if (!InflateMember(data, spans[loadIndices[i]], chunks[loadIndices[i]]))
+			inflated = false;
+	});
+
+	for (const size_t i: loadIndices) {
+		chunkUseTicks[i] = ++useTick;
+	}
+
+	// requested chunk counts as most recently used
+	chunkUseTicks[chunkIndex] = ++useTick;
+
+	numChunks += loadIndices.size();
+	peakChunks = std::max(peakChunks, numChunks);
+
+	failed |= !inflated;
+	return inflated;
+}
+
+bool CGZChunkStreamBuf::SetGetPos(size_t pos)
+{
+	if (pos > dataSize)
+		return false;
+
+	if (pos == dataSize) {
+		setg(nullptr, nullptr, nullptr);
+		getBase = pos;
+		return true;
+	}
+
+	const size_t c = pos / CChunkedStreamBuf::CHUNK_SIZE;
+
+	setg(nullptr, nullptr, nullptr);
+
+	if (!LoadChunk(c))
+		return false;
+
+	char* base = chunks[c].data();
+
+	getBase = c * CChunkedStreamBuf::CHUNK_SIZE;
+	setg(base, base + (pos - getBase), base + chunks[c].size());
+	return true;
+}
+
+
+CGZChunkStreamBuf::int_type CGZChunkStreamBuf::underflow()
+{
+	if (gptr() != nullptr && gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	if (!SetGetPos(getBase + (gptr() - eback())))
+		return traits_type::eof();
+	if (gptr() == egptr())
+		return traits_type::eof();
+
+	return traits_type::to_int_type(*gptr());
+}
+
+
+CGZChunkStreamBuf::pos_type CGZChunkStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	off_type base = 0;
+
+	switch (dir) {
+		case std::ios_base::cur: {
+			base = getBase + (gptr() - eback());
+		} break;
+		case std::ios_base::end: {
+			base = dataSize;
+		} break;
+		default: {
+		} break;
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+CGZChunkStreamBuf::pos_type CGZChunkStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const off_type off = off_type(pos);
+
+	if (off < 0 || (which & std::ios_base::in) == 0)
+		return pos_type(off_type(-1));
+
+	// tellg; avoid inflating a chunk just to report the position
+	if (gptr() != nullptr && size_t(off) == (getBase + (gptr() - eback())))
+		return pos;
+
+	if (!SetGetPos(off))
+		return pos_type(off_type(-1));
+
+	return pos;
+}
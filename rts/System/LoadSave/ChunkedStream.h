@@ -0,0 +1,200 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef CHUNKED_STREAM_H
+#define CHUNKED_STREAM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "System/Threading/SpringThreading.h"
+
+/**
+ * Seekable std::streambuf storing its data in fixed-size chunks; growing it
+ * never copies what was already written (unlike std::stringbuf) and when a
+ * sink is given, chunks the put position has moved past are handed over and
+ * released while writing continues. Ranges that will still be rewritten via
+ * seekp (e.g. creg package headers) must be pinned for as long as needed.
+ */
+class CChunkedStreamBuf: public std::streambuf
+{
+public:
+	typedef std::vector<char> Chunk;
+	typedef std::function<void(size_t chunkIndex, Chunk&& chunk)> ChunkSink;
+
+	static constexpr size_t CHUNK_SIZE = 1 << 22;
+
+	CChunkedStreamBuf(ChunkSink&& sink = nullptr): chunkSink(std::move(sink)) {}
+	CChunkedStreamBuf(const CChunkedStreamBuf&) = delete;
+
+	/// keep the chunks overlapping [offset, offset + size) until Unpin
+	void Pin(size_t offset, size_t size);
+	void Unpin();
+
+	/// hand all remaining chunks to the sink (if any); no writes may follow
+	void Flush();
+	/// replace the contents by <chunks>, all but the last must be CHUNK_SIZE bytes
+	void SetChunks(std::vector<Chunk>&& newChunks);
+	void Clear() { SetChunks({}); }
+
+	size_t GetSize() { SyncSize(); return dataSize; }
+	/// peak number of chunks held in memory at once
+	size_t GetPeakChunks() const { return peakChunks; }
+
+protected:
+	int_type overflow(int_type c) override;
+	int_type underflow() override;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+	void SyncSize();
+	void ReleaseChunks(size_t endChunk);
+
+	bool SetPutPos(size_t pos);
+	bool SetGetPos(size_t pos);
+
+	bool IsPinned(size_t chunkIndex) const {
+		return (pinEnd > pinBeg && chunkIndex >= (pinBeg / CHUNK_SIZE) && chunkIndex <= ((pinEnd - 1) / CHUNK_SIZE));
+	}
+
+private:
+	ChunkSink chunkSink;
+
+	std::vector<Chunk> chunks;
+	// chunks handed to the sink are left empty
+	std::vector<bool> released;
+
+	size_t dataSize = 0;
+	size_t putChunk = 0;
+	// first chunk not yet handed to the sink
+	size_t releaseBeg = 0;
+	size_t getBase = 0;
+
+	size_t pinBeg = 0;
+	size_t pinEnd = 0;
+
+	size_t numChunks = 0;
+	size_t peakChunks = 0;
+};
+
+
+
+/**
+ * Deflates chunks on a small pool of threads and writes them in order as
+ * independent gzip members (a multi-member file that gzread, gunzip etc.
+ * read transparently). Each member carries its own compressed size in an
+ * extra header field ("SC"), so readers can locate and inflate all members
+ * in parallel. Push blocks while maxQueuedChunks chunks are waiting to be
+ * deflated (unless it is 0, which trades memory for never blocking).
+ */
+class CParallelGZWriter
+{
+public:
+	CParallelGZWriter(const std::string& fileName, int level, unsigned int numThreads, unsigned int maxQueuedChunks);
+	CParallelGZWriter(const CParallelGZWriter&) = delete;
+	~CParallelGZWriter() { Finish(); }
+
+	bool IsOpen() const { return (file != nullptr); }
+
+	void Push(size_t chunkIndex, CChunkedStreamBuf::Chunk&& chunk);
+	/// waits until every pushed chunk is written and closes the file
+	bool Finish();
+
+	size_t GetCompressedSize() const { return compressedSize; }
+
+	static bool DeflateChunk(const CChunkedStreamBuf::Chunk& chunk, std::vector<char>& member, int level);
+	/// inflates a file written by this class in parallel, or any other gzip file serially
+	static bool InflateChunks(const std::vector<std::uint8_t>& data, std::vector<CChunkedStreamBuf::Chunk>& chunks);
+
+private:
+	void WorkerLoop();
+	void WriteMembers();
+
+private:
+	FILE* file = nullptr;
+
+	std::vector<spring::thread> workers;
+
+	std::deque< std::pair<size_t, CChunkedStreamBuf::Chunk> > queue;
+	// deflated members waiting for all preceding ones
+	std::map<size_t, std::vector<char> > members;
+
+	spring::mutex mutex;
+	spring::condition_variable_any queueCond;
+	spring::condition_variable_any spaceCond;
+
+	size_t nextMemberIndex = 0;
+	size_t numPushed = 0;
+	size_t compressedSize = 0;
+
+	unsigned int maxQueued = 0;
+	int level = 0;
+
+	bool finished = false;
+	bool failed = false;
+};
+
+
+
+/**
+ * Read-only seekable std::streambuf over a file written by CParallelGZWriter.
+ * Only the compressed data is held in full; members are inflated once the get
+ * position reaches them (together with a few following ones, in parallel) and
+ * at most MAX_CACHED_CHUNKS inflated chunks are kept around at any time.
+ */
+class CGZChunkStreamBuf: public std::streambuf
+{
+public:
+	static constexpr size_t MAX_CACHED_CHUNKS = 8;
+	static constexpr size_t READ_AHEAD_CHUNKS = 4;
+
+	CGZChunkStreamBuf() = default;
+	CGZChunkStreamBuf(const CGZChunkStreamBuf&) = delete;
+
+	/// takes <newData> if it was written by CParallelGZWriter, otherwise leaves it untouched and returns false
+	bool Open(std::vector<std::uint8_t>&& newData);
+	void Clear();
+
+	size_t GetSize() const { return dataSize; }
+	/// peak number of inflated chunks held in memory at once
+	size_t GetPeakChunks() const { return peakChunks; }
+	/// true if any member was found to be corrupt while reading
+	bool HasFailed() const { return failed; }
+
+protected:
+	int_type underflow() override;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+	bool SetGetPos(size_t pos);
+	bool LoadChunk(size_t chunkIndex);
+
+private:
+	std::vector<std::uint8_t> data;
+	// offset and size of each member in data
+	std::vector< std::pair<size_t, size_t> > spans;
+
+	std::vector<CChunkedStreamBuf::Chunk> chunks;
+	// 0 for chunks that are not inflated
+	std::vector<size_t> chunkUseTicks;
+
+	size_t dataSize = 0;
+	size_t getBase = 0;
+
+	size_t useTick = 0;
+	size_t numChunks = 0;
+	size_t peakChunks = 0;
+
+	bool failed = false;
+};
+
+#endif // CHUNKED_STREAM_H
@@ -1,7 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cstdio>
 #include <sstream>
-#include <zlib.h>
 
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
@@ -35,17 +35,23 @@
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "System/SafeUtil.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileQueryFlags.h"
-#include "System/FileSystem/GZFileHandler.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/creg/Serializer.h"
 #include "System/Exceptions.h"
+#include "System/SpringMath.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
 
 #define MAX_STRING_SIZE (1 << 19) // 512kB excluding null-term
 
+CONFIG(bool, SaveGameSnapshot).defaultValue(false).description("Pause the simulation only for as long as the game state takes to serialize into memory; compression and writing the save-file happen in the background. Holds up to SaveGameSnapshotMemory MB of uncompressed data. If disabled, saving waits for compression to keep up and uses less memory.");
+CONFIG(int, SaveGameSnapshotMemory).defaultValue(256).minimumValue(32).description("Maximum amount of uncompressed save-game data in MB that snapshot saves hold while waiting for compression; beyond it serialization waits as well.");
+
 
 CCregLoadSaveHandler::CCregLoadSaveHandler()
 {}
@@ -160,7 +166,16 @@ static void ReadString(std::istream& s, std::string& str)
 }
 
 
-static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::stringstream& oss)
+#ifdef USING_CREG
+static void SavePackage(creg::COutputStreamSerializer& os, std::ostream& oss, CChunkedStreamBuf& osb, void* rootObj, creg::Class* rootCls)
+{
+	// the package header is rewritten last, keep its chunk from being compressed
+	osb.Pin(oss.tellp(), creg::COutputStreamSerializer::GetPackageHeaderSize());
+	os.SavePackage(&oss, rootObj, rootCls);
+	osb.Unpin();
+}
+
+static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::ostream& oss, CChunkedStreamBuf& osb)
 {
 	CLuaStateCollector lsc;
 	lsc.valid = (handle != nullptr) && handle->syncedLuaHandle.IsValid();
@@ -169,11 +184,21 @@ static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer&
 		lsc.L_GC = handle->syncedLuaHandle.GetLuaGCState();
 		lua_gc(lsc.L_GC, LUA_GCCOLLECT, 0);
 	}
-	os.SavePackage(&oss, &lsc, lsc.GetClass());
+	SavePackage(os, oss, osb, &lsc, lsc.GetClass());
+}
+
+static bool ReplaceFile(const std::string& srcPath, const std::string& dstPath)
+{
+	if (std::rename(srcPath.c_str(), dstPath.c_str()) == 0)
+		return true;
+
+	// rename does not replace existing files everywhere (Windows)
+	std::remove(dstPath.c_str());
+	return (std::rename(srcPath.c_str(), dstPath.c_str()) == 0);
 }
 
 
-static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer& is, std::stringstream& iss)
+static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer& is, std::istream& iss)
 {
 	void* plsc;
 	creg::Class* plsccls = nullptr;
@@ -192,6 +217,7 @@ static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer&
 	return;
 
 }
+#endif //USING_CREG
 
 
 void CCregLoadSaveHandler::SaveGame(const std::string& path)
@@ -199,8 +225,35 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #ifdef USING_CREG
 	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
 
+	// the save is written to a temporary file which only replaces any
+	// previous save of the same name once it has been completed
+	const std::string filePath = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+	const std::string tempPath = filePath + ".tmp";
+
+	bool handedOff = false;
+
 	try {
-		std::stringstream oss;
+		const spring_time saveStartTime = spring_gettime();
+
+		// serialized data is cut into chunks which are deflated by a few threads
+		// while serialization continues, then written in order as gzip members;
+		// only the chunks waiting for compression and those holding a package
+		// header (rewritten once the package is complete) stay in memory
+		// in snapshot mode the queue may grow up to a fixed memory budget, so
+		// the sim rarely waits on compression and mostly pays for serialization
+		const unsigned int numThreads = Clamp(ThreadPool::GetNumThreads() - 1, 1, 4);
+		const unsigned int maxSnapshot = (configHandler->GetInt("SaveGameSnapshotMemory") * size_t(1 << 20)) / CChunkedStreamBuf::CHUNK_SIZE;
+		const unsigned int maxQueued = configHandler->GetBool("SaveGameSnapshot")? std::max(maxSnapshot, numThreads * 2): numThreads * 2;
+
+		std::shared_ptr<CParallelGZWriter> writer(new CParallelGZWriter(tempPath, 5, numThreads, maxQueued));
+
+		if (!writer->IsOpen()) {
+			LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
+			return;
+		}
+
+		CChunkedStreamBuf osb([&](size_t chunkIndex, CChunkedStreamBuf::Chunk&& chunk) { writer->Push(chunkIndex, std::move(chunk)); });
+		std::ostream oss(&osb);
 
 		// write our own header. SavePackage() will add its own
 		WriteString(oss, SpringVersion::GetSync());
@@ -214,14 +267,14 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 
 			// save lua state first as lua unit scripts depend on it
 			const int luaStart = oss.tellp();
-			SaveLuaState(luaGaia, os, oss);
-			SaveLuaState(luaRules, os, oss);
+			SaveLuaState(luaGaia, os, oss, osb);
+			SaveLuaState(luaRules, os, oss, osb);
 			PrintSize("Lua", ((int)oss.tellp()) - luaStart);
 
 			// save creg state
 			const int gameStart = oss.tellp();
 			CGameStateCollector gsc;
-			os.SavePackage(&oss, &gsc, gsc.GetClass());
+			SavePackage(os, oss, osb, &gsc, gsc.GetClass());
 			PrintSize("Game", ((int)oss.tellp()) - gameStart);
 
 
@@ -241,23 +294,25 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 		}
 
 		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
-
-			if (file == nullptr) {
-				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
-				return;
-			}
+			osb.Flush();
 
-			std::string data = std::move(oss.str());
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
-			};
+			LOG("[LSH::%s] serialized %.1f MB in %ims (peak %u chunks of %u KB held, sim resumes)", __func__,
+				osb.GetSize() / (1024.0f * 1024.0f), int((spring_gettime() - saveStartTime).toMilliSecsi()),
+				unsigned(osb.GetPeakChunks()), unsigned(CChunkedStreamBuf::CHUNK_SIZE >> 10));
 
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
+			// compression of the last chunks and the final write continue in the background
 			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
+			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, [writer, saveStartTime, filePath, tempPath]() {
+				if (!writer->Finish() || !ReplaceFile(tempPath, filePath)) {
+					LOG_L(L_ERROR, "[LSH::%s] error writing save-file", "SaveGame");
+					std::remove(tempPath.c_str());
+					return;
+				}
+
+				LOG("[LSH::%s] wrote %.1f MB compressed after %ims", "SaveGame", writer->GetCompressedSize() / (1024.0f * 1024.0f), int((spring_gettime() - saveStartTime).toMilliSecsi()));
+			})));
+
+			handedOff = true;
 		}
 
 		//FIXME add lua state
@@ -272,6 +327,10 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 	} catch (...) {
 		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
 	}
+
+	// an incomplete save never replaces the previous one
+	if (!handedOff)
+		std::remove(tempPath.c_str());
 #else //USING_CREG
 	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
 #endif //USING_CREG
@@ -280,16 +339,33 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 /// loads the data (map&mod-name,setup-script) needed by PreGame
 bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
-	CGZFileHandler saveFile(dataDirsAccess.LocateFile(FindSaveFile(path)), SPRING_VFS_RAW_FIRST);
+	CFileHandler saveFile(dataDirsAccess.LocateFile(FindSaveFile(path)), SPRING_VFS_RAW_FIRST);
 
-	std::stringbuf* sbuf = iss.rdbuf();
 	std::string saveVersion;
 	std::string syncVersion = SpringVersion::GetSync();
 
-	char buf[4096];
-	int len;
-	while ((len = saveFile.Read(buf, sizeof(buf))) > 0)
-		sbuf->sputn(buf, len);
+	{
+		// saves written as chunked gzip members stay compressed in memory and
+		// are inflated a few chunks at a time while loading; other gzip files
+		// (e.g. older saves) are inflated as a whole
+		std::vector<std::uint8_t> data(std::max(saveFile.FileSize(), 0));
+		std::vector<CChunkedStreamBuf::Chunk> chunks;
+
+		if (!data.empty() && saveFile.Read(data.data(), data.size()) != int(data.size()))
+			data.clear();
+
+		if (issGZBuf.Open(std::move(data))) {
+			iss.rdbuf(&issGZBuf);
+		} else {
+			if (!CParallelGZWriter::InflateChunks(data, chunks))
+				LOG_L(L_ERROR, "[LSH::%s] could not decompress file \"%s\"", __func__, path.c_str());
+
+			issBuf.SetChunks(std::move(chunks));
+			iss.rdbuf(&issBuf);
+		}
+
+		iss.clear();
+	}
 
 	ReadString(iss, saveVersion);
 
@@ -345,8 +421,12 @@ void CCregLoadSaveHandler::LoadGame()
 		}
 	}
 
+	if (issGZBuf.HasFailed())
+		LOG_L(L_ERROR, "[LSH::%s] save-file is corrupt, could not decompress all of it", __func__);
+
 	// cleanup
-	iss.str("");
+	issGZBuf.Clear();
+	issBuf.Clear();
 
 	gs->paused = false;
 	if (gameServer != nullptr) {
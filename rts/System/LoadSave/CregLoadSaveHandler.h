@@ -3,8 +3,9 @@
 #ifndef CREG_LOAD_SAVE_HANDLER_H
 #define CREG_LOAD_SAVE_HANDLER_H
 
+#include <istream>
 #include <string>
-#include <sstream>
+#include "ChunkedStream.h"
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -18,7 +19,11 @@ public:
 	void SaveGame(const std::string& path) override;
 
 protected:
-	std::stringstream iss;
+	// saves written as gzip members are inflated on demand (issGZBuf),
+	// anything else is inflated up front (issBuf)
+	CGZChunkStreamBuf issGZBuf;
+	CChunkedStreamBuf issBuf;
+	std::istream iss{&issBuf};
 };
 
 #endif // CREG_LOAD_SAVE_HANDLER_H
@@ -15,6 +15,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <stdexcept>
@@ -200,3 +201,77 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+void CDemoReader::LoadFrameIndex()
+{
+	frameIndex.clear();
+
+	// the index is only written when a demo is closed properly
+	if (fileHeader.demoStreamSize == 0)
+		return;
+
+	const int curPos = playbackDemo->GetPos();
+	const int idxPos =
+		fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize +
+		fileHeader.winningAllyTeamsSize + fileHeader.playerStatSize + fileHeader.teamStatSize;
+
+	DemoIndexHeader indexHeader;
+
+	const int indexHeaderSize = sizeof(indexHeader);
+
+	playbackDemo->Seek(idxPos);
+
+	if (playbackDemo->Read((char*) &indexHeader, indexHeaderSize) == indexHeaderSize) {
+		indexHeader.swab();
+
+		// the entry count comes from the file, never allocate more than the file could hold
+		// (idxPos is summed from header fields as well and can overflow)
+		const long maxEntries = (idxPos >= 0)? (playbackDemoSize - idxPos - long(sizeof(indexHeader))) / long(sizeof(DemoIndexEntry)): 0;
+
+		const bool validMagic = (memcmp(indexHeader.magic, DEMOINDEX_MAGIC, sizeof(indexHeader.magic)) == 0);
+		const bool validSize = (indexHeader.entrySize == sizeof(DemoIndexEntry) && indexHeader.numEntries >= 0 && indexHeader.numEntries <= maxEntries);
+
+		if (validMagic && validSize) {
+			const int indexSize = indexHeader.numEntries * sizeof(DemoIndexEntry);
+
+			frameIndex.resize(indexHeader.numEntries);
+
+			if (playbackDemo->Read(reinterpret_cast<char*>(frameIndex.data()), indexSize) != indexSize) {
+				frameIndex.clear();
+			}
+
+			for (DemoIndexEntry& entry: frameIndex) {
+				entry.swab();
+			}
+		}
+	}
+
+	playbackDemo->Seek(curPos);
+}
+
+int CDemoReader::SeekToFrame(int frameNum)
+{
+	const auto pred = [](int frame, const DemoIndexEntry& e) { return (frame < e.frameNum); };
+	const auto iter = std::upper_bound(frameIndex.begin(), frameIndex.end(), frameNum, pred);
+
+	if (iter == frameIndex.begin())
+		return -1;
+
+	const DemoIndexEntry& entry = *(iter - 1);
+
+	playbackDemo->Seek(fileHeader.headerSize + fileHeader.scriptSize + entry.streamOffset);
+
+	const int headerSize = sizeof(chunkHeader);
+
+	if (playbackDemo->Read((char*)&chunkHeader, headerSize) != headerSize) {
+		bytesRemaining = 0;
+		return -1;
+	}
+
+	chunkHeader.swab();
+
+	bytesRemaining = fileHeader.demoStreamSize - entry.streamOffset - sizeof(chunkHeader);
+	nextDemoReadTime = chunkHeader.modGameTime + demoTimeOffset;
+	return entry.frameNum;
+}
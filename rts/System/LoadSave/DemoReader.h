@@ -54,6 +54,16 @@ public:
 
 	/// Not needed for normal demo watching
 	void LoadStats();
+	/// Not needed for normal demo watching; leaves the index empty for older demos
+	void LoadFrameIndex();
+
+	const std::vector<DemoIndexEntry>& GetFrameIndex() const { return frameIndex; }
+
+	/**
+	@brief position the stream at the last indexed chunk starting a frame <= frameNum
+	@return the frame started by the next chunk read, or -1 if there is no such index entry
+	*/
+	int SeekToFrame(int frameNum);
 
 private:
 	CFileHandler* playbackDemo;
@@ -70,6 +80,7 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+	std::vector<DemoIndexEntry> frameIndex;
 };
 
 #endif
@@ -7,6 +7,8 @@
 
 #include "DemoRecorder.h"
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
@@ -51,6 +53,7 @@ CDemoRecorder::~CDemoRecorder()
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteFrameIndex();
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
@@ -118,6 +121,12 @@ void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length,
 {
 	DemoStreamChunkHeader chunkHeader;
 
+	if (length > 0 && (buf[0] == NETMSG_NEWFRAME || buf[0] == NETMSG_KEYFRAME)) {
+		// index one chunk per second of game-time
+		if (((numDemoFrames += 1) % GAME_SPEED) == 0)
+			frameIndex.push_back({numDemoFrames, modGameTime, fileHeader.demoStreamSize});
+	}
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
@@ -298,3 +307,24 @@ void CDemoRecorder::WriteTeamStats()
 
 	teamStats.clear();
 }
+
+/** @brief Write the frame index at the current position in the file (must come last). */
+void CDemoRecorder::WriteFrameIndex()
+{
+	DemoIndexHeader indexHeader;
+
+	memset(&indexHeader, 0, sizeof(indexHeader));
+	strcpy(indexHeader.magic, DEMOINDEX_MAGIC);
+	indexHeader.numEntries = frameIndex.size();
+	indexHeader.entrySize = sizeof(DemoIndexEntry);
+	indexHeader.swab();
+
+	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+
+	for (DemoIndexEntry& entry: frameIndex) {
+		entry.swab();
+		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&entry), sizeof(DemoIndexEntry));
+	}
+
+	frameIndex.clear();
+}
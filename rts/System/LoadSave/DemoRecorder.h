@@ -38,6 +38,8 @@ public:
 		std::swap(playerStats, r.playerStats);
 		std::swap(teamStats, r.teamStats);
 		std::swap(winningAllyTeams, r.winningAllyTeams);
+		std::swap(frameIndex, r.frameIndex);
+		std::swap(numDemoFrames, r.numDemoFrames);
 
 		std::swap(isServerDemo, r.isServerDemo);
 		return *this;
@@ -68,6 +70,7 @@ private:
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
+	void WriteFrameIndex();
 	void WriteDemoFile();
 
 private:
@@ -76,6 +79,9 @@ private:
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
+	std::vector<DemoIndexEntry> frameIndex;
+
+	int numDemoFrames = -1;
 
 	bool isServerDemo = false;
 };
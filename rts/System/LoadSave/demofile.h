@@ -40,6 +40,7 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Frame index (optional, see DemoIndexHeader)
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -115,6 +116,47 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/** The first 8 bytes of the (optional) frame index. */
+#define DEMOINDEX_MAGIC "sdfzidx"
+
+/**
+ * @brief Spring demo stream frame index
+ *
+ * Appended after the team statistics by demos that were closed properly; it
+ * lets readers jump to the stream chunk at which a sim frame starts without
+ * parsing everything before it. Older demos do not have it, readers detect
+ * its presence by the magic.
+ *
+ * - DemoIndexHeader
+ * - numEntries DemoIndexEntry's, ascending by frameNum
+ */
+struct DemoIndexHeader
+{
+	char magic[8];                ///< DEMOINDEX_MAGIC
+	int numEntries;               ///< Number of DemoIndexEntry's following this header.
+	int entrySize;                ///< sizeof(DemoIndexEntry)
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(numEntries);
+		swabDWordInPlace(entrySize);
+	}
+};
+
+struct DemoIndexEntry
+{
+	int frameNum;                 ///< Sim frame started by the NETMSG_{NEW,KEY}FRAME in the indexed chunk.
+	float modGameTime;            ///< Gametime of the indexed chunk.
+	int streamOffset;             ///< Offset of the chunk's DemoStreamChunkHeader relative to the start of the demo stream.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabFloatInPlace(modGameTime);
+		swabDWordInPlace(streamOffset);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
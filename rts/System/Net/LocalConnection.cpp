@@ -14,6 +14,7 @@ unsigned int CLocalConnection::numInstances = 0;
 
 std::deque< std::shared_ptr<const RawPacket> > CLocalConnection::pktQueues[CLocalConnection::MAX_INSTANCES];
 spring::mutex CLocalConnection::mutexes[CLocalConnection::MAX_INSTANCES];
+spring::condition_variable_any CLocalConnection::dataConds[CLocalConnection::MAX_INSTANCES];
 CLocalConnection* CLocalConnection::instancePtrs[MAX_INSTANCES] = {nullptr, nullptr};
 
 CLocalConnection::CLocalConnection()
@@ -67,6 +68,9 @@ void CLocalConnection::SendData(std::shared_ptr<const RawPacket> pkt)
 
 		pktQueues[RemoteInstanceIdx()].push_back(pkt);
 	}
+
+	// wake up B if it is waiting for data
+	dataConds[RemoteInstanceIdx()].notify_one();
 }
 
 std::shared_ptr<const RawPacket> CLocalConnection::GetData()
@@ -85,6 +89,14 @@ std::shared_ptr<const RawPacket> CLocalConnection::GetData()
 	return pkt;
 }
 
+bool CLocalConnection::WaitForData(int msecs) const
+{
+	std::unique_lock<spring::mutex> lock(mutexes[instanceIdx]);
+	const std::deque<std::shared_ptr<const RawPacket>>& pktQueue = pktQueues[instanceIdx];
+
+	return (dataConds[instanceIdx].wait_for(lock, std::chrono::milliseconds(msecs), [&]() { return (!pktQueue.empty()); }));
+}
+
 std::shared_ptr<const RawPacket> CLocalConnection::Peek(unsigned ahead) const
 {
 	std::lock_guard<spring::mutex> scoped_lock(mutexes[instanceIdx]);
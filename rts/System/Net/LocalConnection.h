@@ -52,11 +52,18 @@ public:
 
 	// END overriding CConnection
 
+	/**
+	 * @brief Block until a packet is queued for this end or msecs have passed
+	 * @return true if there is incoming data
+	 */
+	bool WaitForData(int msecs) const;
+
 private:
 	static constexpr unsigned int MAX_INSTANCES = 2;
 
 	static std::deque< std::shared_ptr<const RawPacket> > pktQueues[MAX_INSTANCES];
 	static spring::mutex mutexes[MAX_INSTANCES];
+	static spring::condition_variable_any dataConds[MAX_INSTANCES];
 	static CLocalConnection* instancePtrs[MAX_INSTANCES];
 
 	unsigned int RemoteInstanceIdx() const { return ((instanceIdx + 1) % MAX_INSTANCES); }
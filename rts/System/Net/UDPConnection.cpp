@@ -129,6 +129,10 @@ public:
 		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
 	}
 
+	void Pack(const std::uint8_t* _data, unsigned length) {
+		data.insert(data.end(), _data, _data + length);
+	}
+
 private:
 	std::vector<std::uint8_t>& data;
 };
@@ -140,8 +144,8 @@ void Chunk::UpdateChecksum(CRC& crc) const {
 	crc << chunkNumber;
 	crc << (unsigned int)chunkSize;
 
-	if (!data.empty()) {
-		crc.Update(&data[0], data.size());
+	if (chunkSize > 0) {
+		crc.Update(GetData(), chunkSize);
 	}
 }
 
@@ -224,10 +228,54 @@ void Packet::Serialize(std::vector<std::uint8_t>& data)
 	for (auto ci = chunks.begin(); ci != chunks.end(); ++ci) {
 		buf.Pack((*ci)->chunkNumber);
 		buf.Pack((*ci)->chunkSize);
-		buf.Pack((*ci)->data);
+		buf.Pack((*ci)->GetData(), (*ci)->chunkSize);
 	}
 }
 
+unsigned Packet::Serialize(std::vector<std::uint8_t>& data, std::vector<asio::const_buffer>& buffers)
+{
+	// asio passes at most this many buffers to sendmsg and silently drops the rest;
+	// many tiny chunks are also cheaper to copy than to gather
+	constexpr size_t maxBuffers = 64;
+
+	const size_t numHeaderBytes = headerSize + naks.size();
+
+	buffers.clear();
+
+	if ((1 + chunks.size() * 2) > maxBuffers) {
+		Serialize(data);
+		buffers.emplace_back(data.data(), data.size());
+		return data.size();
+	}
+
+	data.clear();
+	data.reserve(numHeaderBytes + chunks.size() * Chunk::headerSize);
+
+	Packer buf(data);
+	buf.Pack(lastContinuous);
+	buf.Pack(nakType);
+	buf.Pack(checksum);
+	buf.Pack(naks);
+
+	for (const ChunkPtr& chunk: chunks) {
+		buf.Pack(chunk->chunkNumber);
+		buf.Pack(chunk->chunkSize);
+	}
+
+	unsigned size = numHeaderBytes;
+
+	buffers.emplace_back(data.data(), numHeaderBytes);
+
+	for (size_t i = 0; i < chunks.size(); i++) {
+		buffers.emplace_back(data.data() + numHeaderBytes + i * Chunk::headerSize, Chunk::headerSize);
+		buffers.emplace_back(chunks[i]->GetData(), chunks[i]->chunkSize);
+
+		size += chunks[i]->GetSize();
+	}
+
+	return size;
+}
+
 
 
 
@@ -600,7 +648,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 			continue;
 		}
 
-		waitingPackets.emplace_back(c->chunkNumber, std::move(RawPacket(&c->data[0], c->data.size())));
+		waitingPackets.emplace_back(c->chunkNumber, std::move(RawPacket(c->GetData(), c->chunkSize)));
 		incomingChunkNums.insert(c->chunkNumber);
 	}
 
@@ -711,6 +759,8 @@ void UDPConnection::Flush(const bool forced)
 		for (auto pi = outgoingData.begin(); (pi != outgoingData.end()) && (outgoingLength <= requiredLength); ++pi) {
 			outgoingLength += (*pi)->length;
 		}
+
+		outgoingLength -= outgoingOffset;
 	}
 
 	if (forced || (!waitMore && outgoingLength > requiredLength)) {
@@ -737,21 +787,30 @@ void UDPConnection::Flush(const bool forced)
 					);
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned remBytes = packet->length - outgoingOffset;
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, remBytes);
 
 					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
 
-					pos += numBytes;
+					if (pos == 0 && numBytes == maxChunkSize) {
+						// full chunk from a single packet; reference its data instead of
+						// copying it, a broadcast packet is then shared by all connections
+						CreateChunk(packet, outgoingOffset, numBytes, currentPacketChunkNum++);
+					} else {
+						memcpy(buffer + pos, packet->data + outgoingOffset, numBytes);
+						pos += numBytes;
+					}
+
 					sentOverhead += Packet::headerSize;
 
 					outgoing.DataSent(numBytes, true);
 
-					if ((partialPacket = (numBytes != packet->length))) {
+					if ((partialPacket = (numBytes != remBytes))) {
 						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
+						outgoingOffset += numBytes;
 					} else {
-						// full packet copied
+						// full packet consumed
+						outgoingOffset = 0;
 						outgoingData.pop_front();
 					}
 				}
@@ -843,6 +902,19 @@ void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length
 	lastChunkCreatedTime = spring_gettime();
 }
 
+void UDPConnection::CreateChunk(const std::shared_ptr<const RawPacket>& packet, const unsigned offset, const unsigned length, const int packetNum)
+{
+	assert((length > 0) && (length < 255));
+	assert((offset + length) <= packet->length);
+	ChunkPtr buf(new Chunk);
+	buf->chunkNumber = packetNum;
+	buf->chunkSize = length;
+	buf->dataPacket = packet;
+	buf->dataOffset = offset;
+	newChunks.push_back(buf);
+	lastChunkCreatedTime = spring_gettime();
+}
+
 void UDPConnection::SendIfNecessary(bool flushed)
 {
 	const spring_time curTime = spring_gettime();
@@ -1048,22 +1120,31 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 void UDPConnection::SendPacket(Packet& pkt)
 {
+	#if NETWORK_TEST
 	pkt.Serialize(sendBuffer);
+	sendBuffers.assign(1, buffer(sendBuffer));
+
+	const std::vector<std::uint8_t>& data = sendBuffer;
+	const unsigned pktSize = sendBuffer.size();
+	#else
+	// scatter/gather; chunk payloads are sent straight from their buffers
+	const unsigned pktSize = pkt.Serialize(sendBuffer, sendBuffers);
+	#endif
 
-	outgoing.DataSent(sendBuffer.size());
+	outgoing.DataSent(pktSize);
 	lastPacketSendTime = spring_gettime();
 
 	ip::udp::socket::message_flags flags = 0;
 	asio::error_code err;
 
 	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+		mySocket->send_to(sendBuffers, addr, flags, err);
 	}
 
 	if (CheckErrorCode(err))
 		return;
 
-	dataSent += sendBuffer.size();
+	dataSent += pktSize;
 	sentPackets += 1;
 }
 
@@ -8,6 +8,7 @@
 #include <deque>
 
 #include "Connection.h"
+#include "RawPacket.h"
 #include "System/Misc/SpringTime.h"
 #include "System/UnorderedSet.hpp"
 
@@ -29,13 +30,20 @@ namespace netcode {
 class Chunk
 {
 public:
-	unsigned GetSize() const { return (data.size() + headerSize); }
+	unsigned GetSize() const { return (chunkSize + headerSize); }
 	void UpdateChecksum(CRC& crc) const;
+
+	/// payload; either owned or a view into a (broadcast) packet shared by all connections
+	const std::uint8_t* GetData() const { return ((dataPacket != nullptr)? (dataPacket->data + dataOffset): data.data()); }
+
 	static constexpr unsigned maxSize = 254;
 	static constexpr unsigned headerSize = 5;
 	std::int32_t chunkNumber;
 	std::uint8_t chunkSize;
 	std::vector<std::uint8_t> data;
+
+	std::shared_ptr<const RawPacket> dataPacket;
+	std::uint32_t dataOffset = 0;
 };
 typedef std::shared_ptr<Chunk> ChunkPtr;
 
@@ -55,6 +63,11 @@ public:
 	std::uint8_t GetChecksum() const;
 
 	void Serialize(std::vector<std::uint8_t>& data);
+	/**
+	 * @brief serialize headers into data, referencing chunk payloads in place
+	 * @return total size of the buffer sequence
+	 */
+	unsigned Serialize(std::vector<std::uint8_t>& data, std::vector<asio::const_buffer>& buffers);
 
 	std::int32_t lastContinuous;
 	/// if < 0, we lost -x packets since lastContinuous
@@ -146,6 +159,7 @@ private:
 
 	/// add header to data and send it
 	void CreateChunk(const unsigned char* data, const unsigned length, const int packetNum);
+	void CreateChunk(const std::shared_ptr<const RawPacket>& packet, const unsigned offset, const unsigned length, const int packetNum);
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
@@ -185,6 +199,8 @@ private:
 
 	/// outgoing stuff (pure data without header) waiting to be sent
 	std::deque< std::shared_ptr<const RawPacket> > outgoingData;
+	/// number of bytes of outgoingData.front() already cut into chunks
+	unsigned int outgoingOffset = 0;
 	/// packets we have received but not yet read
 	std::vector< std::pair<int, RawPacket> > waitingPackets;
 	spring::unordered_set<int> incomingChunkNums;
@@ -203,6 +219,7 @@ private:
 	std::deque< std::shared_ptr<const RawPacket> > msgQueue;
 
 	std::vector<std::uint8_t> sendBuffer;
+	std::vector<asio::const_buffer> sendBuffers;
 	std::vector<std::uint8_t> recvBuffer;
 	std::vector<std::uint8_t> waitBuffer;
 
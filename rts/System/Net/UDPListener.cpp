@@ -17,7 +17,9 @@
 #include "UDPConnection.h"
 #include "Socket.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Platform/Threading.h"
 #include "System/StringUtil.h" // for IntToString (header only)
 
 
@@ -25,7 +27,11 @@ namespace netcode
 {
 using namespace asio;
 
-UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(false)
+// below this many connections, handing them to the IO threads costs more than it saves
+static constexpr size_t MIN_MT_CONNECTIONS = 4;
+
+
+UDPListener::UDPListener(int port, const std::string& ip, unsigned int numIOThreads): acceptNewConnections(false)
 {
 	// resets socket on any exception
 	const std::string err = TryBindSocket(port, socket, ip);
@@ -36,10 +42,27 @@ UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(
 	socket->non_blocking(true);
 	SetAcceptingConnections(true);
 
-	LOG("[%s] successfully bound socket on port %i", __func__, socket->local_endpoint().port());
+	LOG("[%s] successfully bound socket on port %i (%u IO threads)", __func__, socket->local_endpoint().port(), numIOThreads);
+
+	ioThreads.reserve(numIOThreads);
+
+	for (unsigned int i = 0; i < numIOThreads; i++) {
+		ioThreads.emplace_back(&UDPListener::IOThreadFunc, this, i);
+	}
 }
 
 UDPListener::~UDPListener() {
+	{
+		std::lock_guard<spring::mutex> lock(ioMutex);
+		ioQuit = true;
+	}
+
+	ioWorkCond.notify_all();
+
+	for (spring::thread& t: ioThreads) {
+		t.join();
+	}
+
 	for (const auto& p: dropMap) {
 		LOG("[%s] dropped %lu packets from unknown IP %s", __func__, (unsigned long) p.second, (p.first).c_str());
 	}
@@ -174,15 +197,127 @@ void UDPListener::Update() {
 	#endif
 	}
 
+	ioConns.clear();
+	ioConns.reserve(connMap.size());
+
 	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
 		if (i->second.expired()) {
 			LOG_L(L_DEBUG, "[UDPListener::%s] connection closed: [%s]:%i", __func__, i->first.address().to_string().c_str(), i->first.port());
 			i = connMap.erase(i);
 			continue;
 		}
-		i->second.lock()->Update();
+		ioConns.push_back(i->second.lock());
 		++i;
 	}
+
+	if (ioThreads.empty() || ioConns.size() < MIN_MT_CONNECTIONS) {
+		for (const auto& conn: ioConns) {
+			conn->Update();
+		}
+	} else {
+		UpdateConnectionsMT();
+	}
+
+	ioConns.clear();
+}
+
+
+bool UDPListener::WaitForData(int msecs)
+{
+	asio::error_code err;
+
+	if (socket->available(err) > 0)
+		return true;
+
+	// all other IO on netservice sockets is synchronous, so the only handler
+	// that can be dispatched here is this wait's own
+	bool waitDone = false;
+	bool readable = false;
+
+	socket->async_wait(asio::socket_base::wait_read, [&](const asio::error_code& ec) {
+		waitDone = true;
+		readable = !ec;
+	});
+
+	netservice.restart();
+	netservice.run_one_for(std::chrono::milliseconds(msecs));
+
+	if (!waitDone) {
+		// timed out; the cancelled handler still has to run before its captures go out of scope
+		socket->cancel(err);
+		netservice.restart();
+
+		while (!waitDone && netservice.run_one() > 0);
+		return false;
+	}
+
+	// a failing wait returns immediately, sleep instead of letting the caller spin
+	if (!readable)
+		spring_msecs(msecs).sleep(true);
+
+	return readable;
+}
+
+
+void UDPListener::UpdateConnectionsMT()
+{
+	// each connection owns all of its state except the shared socket, whose
+	// synchronous send_to is safe to call concurrently (it maps directly to
+	// the OS call); so a connection only needs to be updated by one thread
+	{
+		std::lock_guard<spring::mutex> lock(ioMutex);
+
+		ioConnIndex.store(0);
+		ioGeneration += 1;
+		ioDoneThreads = 0;
+	}
+
+	ioWorkCond.notify_all();
+
+	// caller helps out; received packets become visible to the game logic
+	// once every worker has checked in for this round, so no connection is
+	// touched by more than one thread and ioConns can be safely rebuilt
+	UpdateQueuedConnections();
+
+	std::unique_lock<spring::mutex> lock(ioMutex);
+	ioDoneCond.wait(lock, [&]() { return (ioDoneThreads == ioThreads.size()); });
+}
+
+void UDPListener::UpdateQueuedConnections()
+{
+	size_t idx = 0;
+
+	while ((idx = ioConnIndex.fetch_add(1)) < ioConns.size()) {
+		ioConns[idx]->Update();
+	}
+}
+
+void UDPListener::IOThreadFunc(unsigned int threadNum)
+{
+	Threading::SetThreadName(IntToString(threadNum, "netio%d"));
+
+	unsigned int curGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<spring::mutex> lock(ioMutex);
+			ioWorkCond.wait(lock, [&]() { return (ioQuit || ioGeneration != curGeneration); });
+
+			if (ioQuit)
+				return;
+
+			curGeneration = ioGeneration;
+		}
+
+		UpdateQueuedConnections();
+
+		{
+			std::lock_guard<spring::mutex> lock(ioMutex);
+			ioDoneThreads += 1;
+		}
+
+		ioDoneCond.notify_all();
+	}
 }
 
 
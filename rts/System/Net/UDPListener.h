@@ -4,11 +4,14 @@
 #define _UDP_LISTENER_H
 
 #include "System/Misc/NonCopyable.h"
+#include "System/Threading/SpringThreading.h"
+#include <atomic>
 #include <memory>
 #include <asio/ip/udp.hpp>
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
 
 namespace netcode
 {
@@ -28,8 +31,12 @@ public:
 	 * @brief Open a socket and make it ready for listening
 	 * @param  port the port to bind the socket to
 	 * @param  ip local IP to bind to, or "" for any
+	 * @param  numIOThreads number of extra threads that share the
+	 *         per-connection send work (chunking, resends, send_to)
+	 *         in Update; 0 updates all connections on the caller's
+	 *         thread
 	 */
-	UDPListener(int port, const std::string& ip = "");
+	UDPListener(int port, const std::string& ip = "", unsigned int numIOThreads = 0);
 
 	/**
 	 * @brief close the socket and DELETE all connections
@@ -55,6 +62,14 @@ public:
 	 */
 	void Update();
 
+	/**
+	 * @brief Block until data arrives on the socket or msecs have passed
+	 * Lets the caller sleep while idle without adding up to a full tick of
+	 * latency to every incoming packet.
+	 * @return true if the socket became readable
+	 */
+	bool WaitForData(int msecs);
+
 	/**
 	 * Set if we are accepting new connections
 	 * or drop all data from unconnected addresses.
@@ -75,6 +90,11 @@ public:
 	void RejectConnection() { waiting.pop(); }
 	void UpdateConnections(); // Updates connections when the endpoint has been reconnected
 
+private:
+	void UpdateConnectionsMT();
+	void UpdateQueuedConnections();
+	void IOThreadFunc(unsigned int threadNum);
+
 private:
 	/**
 	 * @brief Do we accept packets from unknown sources?
@@ -92,6 +112,21 @@ private:
 	std::map< std::string, size_t> dropMap;
 
 	std::queue< std::shared_ptr<UDPConnection> > waiting;
+
+	/// connections to be updated in the current round, shared with ioThreads
+	std::vector< std::shared_ptr<UDPConnection> > ioConns;
+	std::vector<spring::thread> ioThreads;
+
+	std::atomic<size_t> ioConnIndex = {0};
+
+	spring::mutex ioMutex;
+	spring::condition_variable_any ioWorkCond;
+	spring::condition_variable_any ioDoneCond;
+
+	unsigned int ioGeneration = 0;
+	unsigned int ioDoneThreads = 0;
+
+	bool ioQuit = false;
 };
 
 }
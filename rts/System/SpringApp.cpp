@@ -33,6 +33,7 @@
 #include "Game/GameSetup.h"
 #include "Game/GameVersion.h"
 #include "Game/GameController.h"
+#include "Game/ReplayReport.h"
 #include "Game/Game.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/PreGame.h"
@@ -134,6 +135,7 @@ DEFINE_string   (game,                                     "",    "Specify the g
 DEFINE_string   (map,                                      "",    "Specify the map that will be instantly loaded");
 DEFINE_string   (menu,                                     "",    "Specify a lua menu archive to be used by spring");
 DEFINE_string   (name,                                     "",    "Set your player name");
+DEFINE_string_EX(replay_report,      "replay-report",      "",    "Play back the given demo as fast as possible, then write timing, sync checksums and team statistics (JSON) to this file and quit");
 DEFINE_bool     (oldmenu,                                  false, "Start the old menu");
 
 
@@ -493,6 +495,11 @@ CGameController* SpringApp::LoadDemoFile(const std::string& demoFile)
 	clientSetup->isHost = true;
 	clientSetup->myPlayerName += " (spec)";
 
+	if (!FLAGS_replay_report.empty()) {
+		clientSetup->batchReplay = true;
+		replayReport.Init(FLAGS_replay_report, demoFile);
+	}
+
 	pregame = new CPreGame(clientSetup);
 	pregame->LoadDemoFile(demoFile);
 	return pregame;
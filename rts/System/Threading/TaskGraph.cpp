@@ -0,0 +1,233 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "System/Log/ILog.h"
+
+
+unsigned int CTaskGraph::AddTask(const std::string& name, const std::vector<unsigned int>& deps, TaskFunc func, bool workerSafe)
+{
+	tasks.emplace_back();
+
+	Task& task = tasks.back();
+	task.name = name;
+	task.deps = deps;
+	task.func = std::move(func);
+	task.workerSafe = workerSafe;
+
+	// no forward references, so the graph can not contain cycles
+	for (const unsigned int dep: deps) {
+		assert(dep < (tasks.size() - 1));
+	}
+
+	return (tasks.size() - 1);
+}
+
+
+void CTaskGraph::ExecuteTask(Task& task)
+{
+	task.threadNum = ThreadPool::GetThreadNum();
+	task.startTime = spring_gettime();
+
+	try {
+		task.func();
+	} catch (...) {
+		task.exception = std::current_exception();
+	}
+
+	task.endTime = spring_gettime();
+}
+
+
+void CTaskGraph::Run()
+{
+	enum {
+		TASK_STATE_WAITING = 0,
+		TASK_STATE_RUNNING = 1,
+		TASK_STATE_DONE    = 2,
+	};
+
+	#ifdef THREADPOOL
+	typedef std::shared_ptr<std::future<void>> TaskFuture;
+	#else
+	typedef std::shared_ptr<void> TaskFuture;
+	#endif
+
+	std::vector<unsigned char> states(tasks.size(), TASK_STATE_WAITING);
+	std::vector<std::pair<unsigned int, TaskFuture>> running;
+	std::exception_ptr exception;
+
+	unsigned int nextCallerTask = 0;
+
+	const auto IsReady = [&](unsigned int taskID) {
+		if (states[taskID] != TASK_STATE_WAITING)
+			return false;
+
+		for (const unsigned int dep: tasks[taskID].deps) {
+			if (states[dep] != TASK_STATE_DONE)
+				return false;
+		}
+
+		return true;
+	};
+	const auto FinishTask = [&](unsigned int taskID) {
+		states[taskID] = TASK_STATE_DONE;
+
+		if (tasks[taskID].exception != nullptr && exception == nullptr)
+			exception = tasks[taskID].exception;
+	};
+
+	for (Task& task: tasks) {
+		task.exception = nullptr;
+		task.threadNum = -1;
+		task.startTime = spring_notime;
+		task.endTime = spring_notime;
+	}
+
+	runStartTime = spring_gettime();
+
+	while (true) {
+		bool executed = false;
+
+		if (exception == nullptr) {
+			// hand every worker-safe task that became ready to the pool first
+			for (unsigned int i = 0; i < tasks.size(); i++) {
+				if (!tasks[i].workerSafe || !IsReady(i))
+					continue;
+
+				Task* task = &tasks[i];
+				states[i] = TASK_STATE_RUNNING;
+
+				#ifdef THREADPOOL
+				running.emplace_back(i, ThreadPool::Enqueue([task]() { ExecuteTask(*task); }));
+				#else
+				ExecuteTask(*task);
+				running.emplace_back(i, nullptr);
+				#endif
+			}
+
+			// then run the next task bound to this thread, strictly in insertion order
+			while (nextCallerTask < tasks.size() && tasks[nextCallerTask].workerSafe)
+				nextCallerTask++;
+
+			if (nextCallerTask < tasks.size() && IsReady(nextCallerTask)) {
+				states[nextCallerTask] = TASK_STATE_RUNNING;
+				ExecuteTask(tasks[nextCallerTask]);
+				FinishTask(nextCallerTask++);
+
+				executed = true;
+			}
+		}
+
+		if (executed)
+			continue;
+
+		if (running.empty())
+			break;
+
+		// nothing left to do on this thread, collect the pool's results
+		// (blocking on the oldest task only if none has finished yet)
+		size_t idx = 0;
+
+		#ifdef THREADPOOL
+		for (size_t i = 0; i < running.size(); i++) {
+			if (running[i].second->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				continue;
+
+			idx = i;
+			break;
+		}
+
+		running[idx].second->get();
+		#endif
+
+		FinishTask(running[idx].first);
+		running.erase(running.begin() + idx);
+	}
+
+	runEndTime = spring_gettime();
+
+	if (exception != nullptr)
+		std::rethrow_exception(exception);
+
+	for (unsigned char state: states) {
+		assert(state == TASK_STATE_DONE);
+	}
+}
+
+
+spring_time CTaskGraph::GetTaskDuration() const
+{
+	spring_time duration = spring_notime;
+
+	for (const Task& task: tasks) {
+		duration += (task.endTime - task.startTime);
+	}
+
+	return duration;
+}
+
+
+bool CTaskGraph::WriteTrace(const std::string& fileName) const
+{
+	FILE* out = fopen(fileName.c_str(), "w");
+
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[TaskGraph::%s] failed to open \"%s\"", __func__, fileName.c_str());
+		return false;
+	}
+
+	const auto WriteString = [out](const std::string& s) {
+		fputc('"', out);
+
+		for (const char c: s) {
+			if (c == '"' || c == '\\')
+				fputc('\\', out);
+			if (static_cast<unsigned char>(c) >= 0x20)
+				fputc(c, out);
+		}
+
+		fputc('"', out);
+	};
+
+	int maxThreadNum = 0;
+
+	fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	for (const Task& task: tasks) {
+		// never started (because an earlier task failed)
+		if (task.threadNum < 0)
+			continue;
+
+		const long long ts = (task.startTime - runStartTime).toMicroSecsi();
+		const long long dur = (task.endTime - task.startTime).toMicroSecsi();
+
+		fprintf(out, "\t{\"name\": ");
+		WriteString(task.name);
+		fprintf(out, ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %lld, \"dur\": %lld},\n", (task.workerSafe? "worker": "caller"), task.threadNum, ts, dur);
+
+		maxThreadNum = std::max(maxThreadNum, task.threadNum);
+	}
+
+	for (int i = 0; i <= maxThreadNum; i++) {
+		fprintf(out, "\t{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, \"args\": {\"name\": \"%s %d\"}},\n", i, ((i == 0)? "caller": "worker"), i);
+	}
+
+	// the format tolerates neither trailing commas nor an empty list, close with the total
+	fprintf(out, "\t{\"name\": \"total\", \"cat\": \"graph\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": 0, \"dur\": %lld}\n", (long long) GetDuration().toMicroSecsi());
+	fprintf(out, "]}\n");
+
+	if (fclose(out) != 0) {
+		LOG_L(L_ERROR, "[TaskGraph::%s] failed to write \"%s\"", __func__, fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _TASK_GRAPH_H
+#define _TASK_GRAPH_H
+
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+/**
+ * A set of named tasks with explicit dependencies, run once.
+ *
+ * Tasks added with workerSafe=false (anything touching GL, Lua or the
+ * loadscreen) are executed by the thread calling Run, strictly in the
+ * order they were added; worker-safe tasks are handed to the ThreadPool
+ * as soon as all of their dependencies have finished. The start and end
+ * of every task are recorded and can be written out as a Chrome trace.
+ */
+class CTaskGraph
+{
+public:
+	typedef std::function<void()> TaskFunc;
+
+	/// @param deps ids of previously added tasks that have to finish before this one starts
+	/// @return the id of the new task
+	unsigned int AddTask(const std::string& name, const std::vector<unsigned int>& deps, TaskFunc func, bool workerSafe = false);
+
+	/**
+	 * Returns when all tasks have finished. If a task throws, no further
+	 * tasks are started and the first exception is rethrown as soon as the
+	 * ones already running on other threads have finished.
+	 */
+	void Run();
+
+	/// writes the timeline of the last Run in the trace-event format (chrome://tracing, ui.perfetto.dev)
+	bool WriteTrace(const std::string& fileName) const;
+
+	size_t GetNumTasks() const { return tasks.size(); }
+
+	/// wall-clock time spent in the last Run
+	spring_time GetDuration() const { return (runEndTime - runStartTime); }
+	/// sum of the durations of all tasks in the last Run
+	spring_time GetTaskDuration() const;
+
+private:
+	struct Task {
+		std::string name;
+		std::vector<unsigned int> deps;
+
+		TaskFunc func;
+		std::exception_ptr exception;
+
+		spring_time startTime = spring_notime;
+		spring_time endTime = spring_notime;
+
+		int threadNum = -1;
+		bool workerSafe = false;
+	};
+
+	static void ExecuteTask(Task& task);
+
+private:
+	std::vector<Task> tasks;
+
+	spring_time runStartTime = spring_notime;
+	spring_time runEndTime = spring_notime;
+};
+
+#endif // _TASK_GRAPH_H
@@ -137,16 +137,12 @@ COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void*
 	return nullptr;
 }
 
-void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
+void COutputStreamSerializer::SerializeObject(Class* c, void* ptr)
 {
-	const unsigned objstart = stream->tellp();
+	const unsigned objstart = collectClassStats? unsigned(stream->tellp()): 0u;
 
 	if (c->base())
-		SerializeObject(c->base(), ptr, objr);
-
-	ObjectMemberGroup omg;
-	omg.membersClass = c;
-	omg.size = 0;
+		SerializeObject(c->base(), ptr);
 
 	for (uint a = 0; a < c->members.size(); a++)
 	{
@@ -154,34 +150,16 @@ void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* ob
 		if (m->flags & CM_NoSerialize)
 			continue;
 
-		ObjectMember om;
-		om.member = m;
-		om.memberId = a;
 		void* memberAddr = ((char*)ptr) + m->offset;
-		unsigned mstart = stream->tellp();
 		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
 		m->type->Serialize(this, memberAddr);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s size:%d", c->name, m->name, m->type->GetName().c_str(), om.size);
 	}
 
-
-	if (c->HasSerialize()) {
-		ObjectMember om;
-		om.member = nullptr;
-		om.memberId = -1;
-		unsigned mstart = stream->tellp();
+	if (c->HasSerialize())
 		c->CallSerializeProc(ptr, this);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-	}
 
-	objr->memberGroups.push_back(omg);
+	if (!collectClassStats)
+		return;
 
 	const unsigned objend = stream->tellp();
 	const int sz = objend - objstart;
@@ -199,13 +177,11 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 		ptrToId[inst].push_back(obj);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
+	} else if (!obj->isPending) {
+		throw std::string("Object pointer was serialized (") + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+		// still in pendingObjects, skipped there from now on
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -214,7 +190,7 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	WriteVarSizeUInt(stream, obj->id);
 
 	// write the object
-	SerializeObject(objClass, inst, obj);
+	SerializeObject(objClass, inst);
 }
 
 void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objClass)
@@ -228,6 +204,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 			obj = &objects.back();
 			ptrToId[*ptr].push_back(obj);
 			pendingObjects.push_back(obj);
+			obj->isPending = true;
 		}
 		id = obj->id;
 
@@ -268,11 +245,17 @@ struct COutputStreamSerializer::ClassRef
 	creg::Class* class_;
 };
 
+size_t COutputStreamSerializer::GetPackageHeaderSize()
+{
+	return sizeof(PackageHeader);
+}
+
 void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class* rootObjClass)
 {
 	PackageHeader ph;
 
 	stream = s;
+	collectClassStats = LOG_IS_ENABLED(L_DEBUG);
 	unsigned startOffset = stream->tellp();
 	stream->write((char*)&ph, sizeof(PackageHeader));
 	stream->seekp(startOffset + sizeof(PackageHeader));
@@ -288,6 +271,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	obj = &objects.back();
 	ptrToId[rootObj].push_back(obj);
 	pendingObjects.push_back(obj);
+	obj->isPending = true;
 
 	// Save until all the referenced objects have been stored
 	while (!pendingObjects.empty())
@@ -296,7 +280,11 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 		pendingObjects.clear();
 
 		for (ObjectRef* obj: po) {
-			SerializeObject(obj->class_, obj->ptr, obj);
+			if (!obj->isPending)
+				continue;
+
+			obj->isPending = false;
+			SerializeObject(obj->class_, obj->ptr);
 			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
 		}
 	}
@@ -325,7 +313,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	}
 
 
-	if (LOG_IS_ENABLED(L_DEBUG)) {
+	if (collectClassStats) {
 		for (auto &it: classSizes) {
 			LOG_L(L_DEBUG, "%30s %10u %10u",
 					it.first->name,
@@ -13,6 +13,8 @@
 #include <deque>
 #include <istream>
 
+#include "System/UnorderedMap.hpp"
+
 namespace creg {
 
 	/**
@@ -23,43 +25,23 @@ namespace creg {
 	class COutputStreamSerializer : public ISerializer
 	{
 	protected:
-		struct ObjectMember {
-			Class::Member* member;
-			int memberId;
-			int size;
-		};
-		struct ObjectMemberGroup {
-			Class* membersClass;
-			std::vector<COutputStreamSerializer::ObjectMember> members;
-			int size;
-		};
 		struct ObjectRef {
-			ObjectRef() {
-				ptr = 0;
-				id=0;
-				classIndex=0;
-				isEmbedded=false;
-				class_=0;
-			}
-			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
-				this->ptr = ptr;
-				this->id=id;
-				classIndex=0;
-				this->isEmbedded=isEmbedded;
-				this->class_=class_;
-			}
-			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
-				ptr=src.ptr;
-				id=src.id;
-				classIndex=src.classIndex;
-				isEmbedded=src.isEmbedded;
-				class_=src.class_;
-			}
-			void* ptr;
-			int id, classIndex;
-			bool isEmbedded;
-			Class* class_;
-			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
+			ObjectRef() = default;
+			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_)
+				: ptr(ptr)
+				, id(id)
+				, isEmbedded(isEmbedded)
+				, class_(class_)
+			{}
+
+			void* ptr = nullptr;
+			int id = 0;
+			int classIndex = 0;
+			bool isEmbedded = false;
+			// referenced by pointer but not yet written (or embedded after all)
+			bool isPending = false;
+			Class* class_ = nullptr;
+
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
 				if (ptr != objPtr) return false;
@@ -81,11 +63,13 @@ namespace creg {
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		spring::unsynced_map<void*, std::vector<ObjectRef*> > ptrToId;
 		std::deque<ObjectRef> objects;
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
+		// per-class statistics, only gathered when debug-logging
 		std::map<Class*, int> classSizes;
 		std::map<Class*, int> classCounts;
+		bool collectClassStats = false;
 
 		// Serialize all class names
 		void WriteObjectInfo();
@@ -94,7 +78,7 @@ namespace creg {
 
 		ObjectRef* FindObjectRef(void* inst, Class* objClass, bool isEmbedded);
 
-		void SerializeObject(Class* c, void* ptr, ObjectRef* objr);
+		void SerializeObject(Class* c, void* ptr);
 
 	public:
 		COutputStreamSerializer();
@@ -107,6 +91,11 @@ namespace creg {
 		 */
 		void SavePackage(std::ostream* s, void* rootObj, Class* cls);
 
+		/** Number of bytes at the start of a package that SavePackage rewrites
+		 * (seeking back) after all objects were written
+		 */
+		static size_t GetPackageHeaderSize();
+
 		/** @see ISerializer::IsWriting */
 		bool IsWriting();
 
@@ -0,0 +1,256 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Lua/LuaMemPool.h"
+#include "System/MemPoolTypes.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+
+struct TraceOp {
+	uint32_t slot; // index into the live-pointer table
+	uint32_t size; // 0 means free
+};
+
+// trace files (LMP_TRACE env-var) contain one "<slot> <size>" pair per line
+// where a size of 0 frees the slot; otherwise a synthetic trace resembling a
+// typical widget workload (many small short-lived allocs) is generated
+static std::vector<TraceOp> LoadTrace(uint32_t& numSlots)
+{
+	std::vector<TraceOp> trace;
+
+	if (const char* path = std::getenv("LMP_TRACE")) {
+		FILE* f = std::fopen(path, "r");
+		TraceOp op;
+
+		numSlots = 0;
+
+		while (f != nullptr && std::fscanf(f, "%u %u", &op.slot, &op.size) == 2) {
+			trace.push_back(op);
+			numSlots = std::max(numSlots, op.slot + 1);
+		}
+
+		if (f != nullptr)
+			std::fclose(f);
+		if (!trace.empty())
+			return trace;
+	}
+
+	std::vector<uint32_t> sizes(numSlots = 1 << 14, 0);
+
+	srand(0);
+	trace.reserve(1 << 22);
+
+	for (uint32_t i = 0; i < (1 << 22); i++) {
+		const uint32_t slot = rand() % numSlots;
+
+		if (sizes[slot] != 0) {
+			trace.push_back({slot, sizes[slot] = 0});
+			continue;
+		}
+
+		// mostly strings, tables and closures; occasional large arrays
+		switch (rand() % 16) {
+			case 15: { sizes[slot] = 1024 + rand() % 16384; } break;
+			case 14: { sizes[slot] =  256 + rand() %  1024; } break;
+			default: { sizes[slot] =   16 + rand() %   128; } break;
+		}
+
+		trace.push_back({slot, sizes[slot]});
+	}
+
+	// release everything still alive at the end
+	for (uint32_t slot = 0; slot < numSlots; slot++) {
+		if (sizes[slot] != 0) {
+			trace.push_back({slot, 0});
+		}
+	}
+
+	return trace;
+}
+
+
+// replica of the pool as it was before the recycle cache and the peak stats
+// were added (LuaMemPool::{Alloc,Free} -> PoolImpl::{Alloc,Free}), to have a
+// baseline for the current implementation; the switch over size-classes is a
+// table of function pointers here, both compile to an indirect jump
+struct LegacyLuaMemPool {
+public:
+	static constexpr uint32_t NUM_POOLS = 27;
+
+	static constexpr std::array<uint32_t, NUM_POOLS> NUM_CHUNKS = {{
+		1 << 12,  1 << 12,  1 << 12,  1 << 12,  1 << 12,  1 << 12,  1 << 12,  1 << 12,
+		1 << 13,  1 << 13,  1 << 13,  1 << 13,  1 << 13,  1 << 13,  1 << 13,  1 << 13,
+		1 << 14,  1 << 14,  1 << 14,  1 << 14,  1 << 14,  1 << 14,  1 << 14,  1 << 14,
+		1 << 15,  1 << 15,  1 << 15,
+	}};
+	static constexpr std::array<uint32_t, NUM_POOLS> NUM_PAGES = {{
+		1 << 15,  1 << 15,  1 << 14,  1 << 14,  1 << 13,  1 << 13,  1 << 12,  1 << 12,
+		1 << 11,  1 << 11,  1 << 10,  1 << 10,  1 <<  9,  1 <<  9,  1 <<  8,  1 <<  8,
+		1 <<  7,  1 <<  7,  1 <<  6,  1 <<  6,  1 <<  5,  1 <<  5,  1 <<  4,  1 <<  4,
+		1 <<  3,  1 <<  3,  1 <<  2,
+	}};
+
+	template<size_t i> using PoolType = FixedDynMemPool<1 << i, NUM_CHUNKS[i], NUM_PAGES[i]>;
+
+	LegacyLuaMemPool() { Init(std::make_index_sequence<NUM_POOLS>()); }
+	~LegacyLuaMemPool() { Kill(std::make_index_sequence<NUM_POOLS>()); }
+
+	void* Alloc(size_t size) {
+		if (size > LuaMemPool::MAX_ALLOC_SIZE)
+			return ::operator new(size);
+
+		allocStats[STAT_NIA] += 1;
+		allocStats[STAT_NCB] += (size = std::max(size, size_t(LuaMemPool::MIN_ALLOC_SIZE)));
+
+		const uint32_t subPoolIndex = CalcPoolIndex(size);
+
+		numAllocs[subPoolIndex] += 1;
+		allocSums[subPoolIndex] += size;
+		numAllocs[   NUM_POOLS] += 1;
+		allocSums[   NUM_POOLS] += size;
+
+		return (allocFuncs[subPoolIndex](poolPtrs[subPoolIndex], size));
+	}
+
+	void Free(void* ptr, size_t size) {
+		if (ptr == nullptr)
+			return;
+
+		if (size > LuaMemPool::MAX_ALLOC_SIZE) {
+			::operator delete(ptr);
+			return;
+		}
+
+		allocStats[STAT_NCB] -= (size = std::max(size, size_t(LuaMemPool::MIN_ALLOC_SIZE)));
+
+		const uint32_t subPoolIndex = CalcPoolIndex(size);
+
+		numAllocs[subPoolIndex] -= 1;
+		allocSums[subPoolIndex] -= size;
+		numAllocs[   NUM_POOLS] -= 1;
+		allocSums[   NUM_POOLS] -= size;
+
+		freeFuncs[subPoolIndex](poolPtrs[subPoolIndex], ptr);
+	}
+
+private:
+	static uint32_t CalcPoolIndex(uint32_t alloc) {
+		return (std::max(2u + (LuaMemPool::MIN_ALLOC_SIZE == 8), log_base_2(alloc)));
+	}
+
+	template<size_t i> static void* AllocMem(void* pool, size_t size) { return (static_cast<PoolType<i>*>(pool)->allocMem(size)); }
+	template<size_t i> static void FreeMem(void* pool, void* ptr) { static_cast<PoolType<i>*>(pool)->freeMem(ptr); }
+
+	template<size_t... i> void Init(std::index_sequence<i...>) {
+		((poolPtrs[i] = new PoolType<i>()), ...);
+		((allocFuncs[i] = &AllocMem<i>), ...);
+		((freeFuncs[i] = &FreeMem<i>), ...);
+	}
+	template<size_t... i> void Kill(std::index_sequence<i...>) {
+		(delete static_cast<PoolType<i>*>(poolPtrs[i]), ...);
+	}
+
+private:
+	enum {
+		STAT_NIA = 0, // number of internal allocs
+		STAT_NCB = 1, // number of chunk bytes currently in use
+	};
+
+	std::array<void*, NUM_POOLS> poolPtrs;
+	std::array<void*(*)(void*, size_t), NUM_POOLS> allocFuncs;
+	std::array<void(*)(void*, void*), NUM_POOLS> freeFuncs;
+
+	std::array<size_t, 2> allocStats = {{0, 0}};
+	std::array<size_t, NUM_POOLS + 1> numAllocs = {};
+	std::array<size_t, NUM_POOLS + 1> allocSums = {};
+};
+
+
+template<typename AllocFunc, typename FreeFunc>
+static void ReplayTrace(const std::vector<TraceOp>& trace, uint32_t numSlots, AllocFunc allocFunc, FreeFunc freeFunc)
+{
+	std::vector<std::pair<void*, uint32_t>> slots(numSlots, {nullptr, 0});
+
+	for (const TraceOp& op: trace) {
+		auto& slot = slots[op.slot];
+
+		if (op.size == 0) {
+			freeFunc(slot.first, slot.second);
+			slot = {nullptr, 0};
+		} else {
+			freeFunc(slot.first, slot.second);
+			slot = {allocFunc(op.size), op.size};
+		}
+	}
+
+	for (auto& slot: slots) {
+		freeFunc(slot.first, slot.second);
+	}
+}
+
+
+TEST_CASE("LuaMemPool")
+{
+	uint32_t numSlots = 0;
+	const std::vector<TraceOp> trace = LoadTrace(numSlots);
+
+	LuaMemPool::InitStatic(true);
+	LuaMemPool* pool = LuaMemPool::AcquirePtr(false, false);
+
+	{
+		ScopedOnceTimer timer("LuaMemPool::ReplayTrace(operator new)");
+		ReplayTrace(trace, numSlots, [](uint32_t size) { return ::operator new(size); }, [](void* ptr, uint32_t) { ::operator delete(ptr); });
+	}
+	{
+		LegacyLuaMemPool legacyPool;
+
+		ScopedOnceTimer timer("LuaMemPool::ReplayTrace(LegacyLuaMemPool)");
+		ReplayTrace(trace, numSlots, [&](uint32_t size) { return legacyPool.Alloc(size); }, [&](void* ptr, uint32_t size) { legacyPool.Free(ptr, size); });
+	}
+	{
+		ScopedOnceTimer timer("LuaMemPool::ReplayTrace(LuaMemPool)");
+		ReplayTrace(trace, numSlots, [&](uint32_t size) { return pool->Alloc(size); }, [&](void* ptr, uint32_t size) { pool->Free(ptr, size); });
+	}
+
+	std::array<LuaMemPool::SizeClassStats, 32> stats;
+	const size_t numStats = pool->GetSizeClassStats(stats.data(), stats.size());
+
+	CHECK(numStats == stats.size());
+
+	size_t cacheHits = 0;
+
+	for (size_t i = 0; i < numStats; i++) {
+		const LuaMemPool::SizeClassStats& s = stats[i];
+
+		// every allocation was released again
+		CHECK(s.numAllocs == 0);
+		CHECK(s.allocSums == 0);
+		CHECK(s.peakSums <= s.peakAllocs * s.pageSize);
+		CHECK(s.freeBytes == s.poolBytes);
+
+		cacheHits += s.cacheHits;
+
+		if (s.peakAllocs == 0)
+			continue;
+
+		printf("[LuaMemPool] pageSize=%u peak{Allocs,Bytes}={%u,%u} poolBytes=%u cacheHits=%u\n",
+			unsigned(s.pageSize), unsigned(s.peakAllocs), unsigned(s.peakSums), unsigned(s.poolBytes), unsigned(s.cacheHits));
+	}
+
+	CHECK(cacheHits > 0);
+
+	LuaMemPool::ReleasePtr(pool, nullptr);
+	LuaMemPool::KillStatic();
+}
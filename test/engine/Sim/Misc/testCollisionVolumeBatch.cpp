@@ -0,0 +1,148 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/CollisionVolumeBatch.h"
+#include "System/Matrix44f.h"
+#include "System/float3.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+struct TestVolume {
+	CMatrix44f mat;
+	float3 hScales;
+};
+
+// the transform and early-out of CCollisionHandler::Intersect, one volume at a time
+static bool ScalarCanHit(const TestVolume& v, const float3& p0, const float3& p1, float3& pi0, float3& pi1)
+{
+	const CMatrix44f mInv = v.mat.InvertAffine();
+
+	pi0 = mInv.Mul(p0);
+	pi1 = mInv.Mul(p1);
+
+	const float3 rmin = float3::min(pi0, pi1);
+	const float3 rmax = float3::max(pi0, pi1);
+	const float3 vmin = -v.hScales;
+	const float3 vmax =  v.hScales;
+
+	if (rmax.x < vmin.x || rmin.x > vmax.x)
+		return false;
+	if (rmax.y < vmin.y || rmin.y > vmax.y)
+		return false;
+	if (rmax.z < vmin.z || rmin.z > vmax.z)
+		return false;
+
+	return true;
+}
+
+static bool BitEqual(const float3& a, const float3& b)
+{
+	return (std::memcmp(&a.x, &b.x, sizeof(float) * 3) == 0);
+}
+
+
+static std::mt19937 rng(1234);
+
+static float RandFloat(float a, float b) { return (std::uniform_real_distribution<float>(a, b)(rng)); }
+static float3 RandVector(float a, float b) { return {RandFloat(a, b), RandFloat(a, b), RandFloat(a, b)}; }
+
+static TestVolume RandVolume()
+{
+	TestVolume v;
+
+	v.mat.Translate(RandVector(-500.0f, 500.0f));
+	v.mat.RotateEulerXYZ(RandVector(-3.14f, 3.14f));
+	v.mat.Translate(RandVector(-20.0f, 20.0f));
+	v.hScales = RandVector(1.0f, 40.0f);
+
+	return v;
+}
+
+
+TEST_CASE("CollisionVolumeBatch")
+{
+	CCollisionVolumeBatch batch;
+	std::vector<TestVolume> volumes;
+
+	unsigned int numHits = 0;
+	unsigned int numTests = 0;
+
+	for (unsigned int run = 0; run < 2000; run++) {
+		// include empty and partially filled four-volume blocks
+		const unsigned int numVolumes = run % 23;
+
+		volumes.clear();
+		batch.Reset();
+
+		for (unsigned int i = 0; i < numVolumes; i++) {
+			volumes.push_back(RandVolume());
+			CHECK(batch.AddVolume(volumes[i].mat, volumes[i].hScales) == i);
+		}
+
+		CHECK(batch.GetNumVolumes() == numVolumes);
+
+		for (unsigned int seg = 0; seg < 16; seg++) {
+			const float3 p0 = RandVector(-600.0f, 600.0f);
+			float3 p1 = p0 + RandVector(-300.0f, 300.0f);
+
+			// degenerate and axis-aligned segments
+			if ((seg & 3) == 1)
+				p1 = p0;
+			if ((seg & 3) == 2)
+				p1.y = p0.y;
+
+			unsigned int numBatchHits = 0;
+			const unsigned int numBatchCanHit = batch.Transform(p0, p1);
+
+			for (unsigned int i = 0; i < numVolumes; i++) {
+				float3 pi0;
+				float3 pi1;
+
+				const bool canHit = ScalarCanHit(volumes[i], p0, p1, pi0, pi1);
+
+				CHECK(batch.CanHit(i) == canHit);
+				CHECK(BitEqual(batch.GetVolumeSpacePos0(i), pi0));
+				CHECK(BitEqual(batch.GetVolumeSpacePos1(i), pi1));
+				CHECK(std::memcmp(&batch.GetMatrix(i), &volumes[i].mat, sizeof(CMatrix44f)) == 0);
+
+				numBatchHits += canHit;
+				numTests += 1;
+			}
+
+			CHECK(numBatchCanHit == numBatchHits);
+			numHits += numBatchHits;
+		}
+	}
+
+	// make sure both outcomes were actually exercised
+	CHECK(numHits > 0);
+	CHECK(numHits < numTests);
+}
+
+TEST_CASE("CollisionVolumeBatchSegmentInside")
+{
+	CCollisionVolumeBatch batch;
+
+	const TestVolume v = RandVolume();
+
+	batch.AddVolume(v.mat, v.hScales);
+
+	// a segment starting at the volume center can never be rejected
+	const float3 center = v.mat.GetPos();
+
+	CHECK(batch.Transform(center, center + RandVector(-100.0f, 100.0f)) == 1);
+	CHECK(batch.CanHit(0));
+
+	// nor one passing straight through it
+	CHECK(batch.Transform(center - UpVector * 1000.0f, center + UpVector * 1000.0f) == 1);
+	CHECK(batch.CanHit(0));
+
+	// but one far away always is
+	CHECK(batch.Transform(center + UpVector * 1000.0f, center + UpVector * 1001.0f) == 0);
+	CHECK(!batch.CanHit(0));
+}
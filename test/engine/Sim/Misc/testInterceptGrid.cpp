@@ -0,0 +1,213 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/InterceptGrid.h"
+#include "System/SpringMath.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+
+static constexpr float MAP_SIZE_X = 8192.0f;
+static constexpr float MAP_SIZE_Z = 6144.0f;
+static constexpr float MIN_HEIGHT = -50.0f;
+static constexpr float CELL_SIZE = 512.0f;
+
+struct TestProjectile {
+	float3 pos;
+	float3 dir;
+	float3 targetPos;
+};
+
+static std::mt19937 rng(5678);
+
+static float RandFloat(float a, float b) { return (std::uniform_real_distribution<float>(a, b)(rng)); }
+
+static TestProjectile RandProjectile()
+{
+	TestProjectile p;
+
+	p.pos = {RandFloat(-500.0f, MAP_SIZE_X + 500.0f), RandFloat(MIN_HEIGHT, 1500.0f), RandFloat(-500.0f, MAP_SIZE_Z + 500.0f)};
+	p.targetPos = p.pos + float3(RandFloat(-2500.0f, 2500.0f), 0.0f, RandFloat(-2500.0f, 2500.0f));
+	p.targetPos.y = 0.0f;
+
+	switch (rng() % 4) {
+		case 0: { p.dir = (p.targetPos - p.pos).SafeNormalize(); } break; // homing
+		case 1: { p.dir = UpVector; } break; // starburst launch
+		case 2: { p.dir = float3(RandFloat(-1.0f, 1.0f), RandFloat(-1.0f, -0.1f), RandFloat(-1.0f, 1.0f)).SafeNormalize(); } break; // ballistic
+		case 3: { p.dir = float3(RandFloat(-1.0f, 1.0f), RandFloat(-0.1f, 1.0f), RandFloat(-1.0f, 1.0f)).SafeNormalize(); } break; // anything
+	}
+
+	return p;
+}
+
+static void AddProjectile(CInterceptGrid& grid, const TestProjectile& p)
+{
+	const float trajLength = CInterceptGrid::GetTrajectoryLength(p.pos, p.dir, MIN_HEIGHT, MAP_SIZE_X, MAP_SIZE_Z);
+
+	grid.AddObject(p.pos - p.dir, p.pos + p.dir * trajLength, p.targetPos);
+}
+
+static float SqDistanceToSegment2D(const float3& pos, const float3& a, const float3& b)
+{
+	const float3 ab = float3(b.x - a.x, 0.0f, b.z - a.z);
+	const float3 ap = float3(pos.x - a.x, 0.0f, pos.z - a.z);
+	const float t = (ab.SqLength() > 0.0f)? Clamp(ap.dot(ab) / ab.SqLength(), 0.0f, 1.0f): 0.0f;
+
+	return ((ap - ab * t).SqLength());
+}
+
+static float SqDistanceToTrajectory2D(const float3& pos, const TestProjectile& p, float trajLength)
+{
+	float sqDist = pos.SqDistance2D(p.targetPos);
+
+	// sample the footprint instead of solving for the closest point
+	for (int i = 0; i <= 4096; i++) {
+		sqDist = std::min(sqDist, pos.SqDistance2D(p.pos + p.dir * mix(-1.0f, trajLength, i / 4096.0f)));
+	}
+
+	return sqDist;
+}
+
+
+TEST_CASE("InterceptGridTrajectoryLength")
+{
+	for (int n = 0; n < 10000; n++) {
+		const TestProjectile p = RandProjectile();
+		const float trajLength = CInterceptGrid::GetTrajectoryLength(p.pos, p.dir, MIN_HEIGHT, MAP_SIZE_X, MAP_SIZE_Z);
+
+		CHECK(trajLength >= 0.0f);
+
+		// only the 2D footprint matters, which is a point for these
+		if (p.dir.x == 0.0f && p.dir.z == 0.0f)
+			continue;
+
+		// any point past the end is outside the map or
+		// below the ground, i.e. unreachable for a ray
+		// that has not hit the ground yet
+		for (int i = 1; i <= 200; i++) {
+			const float3 q = p.pos + p.dir * (trajLength + i * 97.0f);
+
+			const bool inMap = (q.x >= 0.0f && q.x <= MAP_SIZE_X && q.z >= 0.0f && q.z <= MAP_SIZE_Z);
+			const bool aboveGround = (q.y >= MIN_HEIGHT);
+
+			CHECK((!inMap || !aboveGround));
+		}
+	}
+}
+
+TEST_CASE("InterceptGridQuery")
+{
+	CInterceptGrid grid;
+	std::vector<TestProjectile> projectiles;
+	std::vector<int> objects;
+
+	grid.Init(MAP_SIZE_X, MAP_SIZE_Z, CELL_SIZE);
+
+	for (int i = 0; i < 500; i++) {
+		projectiles.push_back(RandProjectile());
+		AddProjectile(grid, projectiles.back());
+	}
+
+	CHECK(grid.GetNumObjects() == 500);
+
+	unsigned int numFound = 0;
+
+	for (int n = 0; n < 500; n++) {
+		const float3 pos = {RandFloat(0.0f, MAP_SIZE_X), 0.0f, RandFloat(0.0f, MAP_SIZE_Z)};
+		const float radius = RandFloat(0.0f, 1500.0f);
+
+		grid.GetObjects(pos, radius, objects);
+
+		CHECK(std::is_sorted(objects.begin(), objects.end()));
+		CHECK(std::adjacent_find(objects.begin(), objects.end()) == objects.end());
+
+		// every projectile within range has to be found, and nothing (much) further away
+		for (int i = 0; i < 500; i++) {
+			const TestProjectile& p = projectiles[i];
+			const float trajLength = CInterceptGrid::GetTrajectoryLength(p.pos, p.dir, MIN_HEIGHT, MAP_SIZE_X, MAP_SIZE_Z);
+			const float sqDist = SqDistanceToTrajectory2D(pos, p, trajLength);
+			const bool found = std::binary_search(objects.begin(), objects.end(), i);
+
+			if (sqDist < Square(radius))
+				CHECK(found);
+			if (found)
+				CHECK(sqDist < Square(radius + 8.0f));
+		}
+
+		numFound += objects.size();
+	}
+
+	CHECK(numFound > 0);
+
+	grid.Clear();
+	grid.GetObjects(float3(MAP_SIZE_X, 0.0f, MAP_SIZE_Z) * 0.5f, MAP_SIZE_X, objects);
+
+	CHECK(objects.empty());
+}
+
+
+TEST_CASE("InterceptGridScaling")
+{
+	// anti-nuke style coverage against many incoming projectiles
+	std::vector<float3> interceptors;
+	std::vector<int> objects;
+
+	for (int n = 0; n < 200; n++) {
+		interceptors.emplace_back(RandFloat(0.0f, MAP_SIZE_X), 0.0f, RandFloat(0.0f, MAP_SIZE_Z));
+	}
+
+	for (const int numProjectiles: {100, 1000, 5000}) {
+		std::vector<TestProjectile> projectiles;
+		std::vector<float> trajLengths;
+
+		for (int i = 0; i < numProjectiles; i++) {
+			projectiles.push_back(RandProjectile());
+			trajLengths.push_back(CInterceptGrid::GetTrajectoryLength(projectiles[i].pos, projectiles[i].dir, MIN_HEIGHT, MAP_SIZE_X, MAP_SIZE_Z));
+		}
+
+		unsigned int numPairs[2] = {0, 0};
+
+		{
+			ScopedOnceTimer timer("all-pairs (" + std::to_string(numProjectiles) + " projectiles)");
+
+			for (const float3& pos: interceptors) {
+				for (int i = 0; i < numProjectiles; i++) {
+					const TestProjectile& p = projectiles[i];
+
+					const float3 p0 = p.pos - p.dir;
+					const float3 p1 = p.pos + p.dir * trajLengths[i];
+
+					// the same filtering the grid does for its candidates
+					numPairs[0] += (pos.SqDistance2D(p.targetPos) < Square(1000.0f) || SqDistanceToSegment2D(pos, p0, p1) < Square(1000.0f));
+				}
+			}
+		}
+		{
+			ScopedOnceTimer timer("grid (" + std::to_string(numProjectiles) + " projectiles)");
+
+			CInterceptGrid grid;
+			grid.Init(MAP_SIZE_X, MAP_SIZE_Z, CELL_SIZE);
+
+			for (const TestProjectile& p: projectiles) {
+				AddProjectile(grid, p);
+			}
+
+			for (const float3& pos: interceptors) {
+				grid.GetObjects(pos, 1000.0f, objects);
+				numPairs[1] += objects.size();
+			}
+		}
+
+		// the rounding margin can only add a few candidates
+		CHECK(numPairs[1] >= numPairs[0]);
+		CHECK(numPairs[1] < (interceptors.size() * numProjectiles));
+	}
+}
@@ -0,0 +1,151 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/SmoothHeightMesh.h"
+#include "Sim/Misc/GlobalConstants.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int MAP_SQUARES = 128;
+static constexpr float MAP_SIZE = MAP_SQUARES * SQUARE_SIZE;
+static constexpr float MAX_HEIGHT = 400.0f;
+
+static std::vector<float> terrain((MAP_SQUARES + 1) * (MAP_SQUARES + 1), 0.0f);
+static std::mt19937 rng(4321);
+
+static float RandFloat(float a, float b) { return (std::uniform_real_distribution<float>(a, b)(rng)); }
+static int RandInt(int a, int b) { return (std::uniform_int_distribution<int>(a, b)(rng)); }
+
+
+// ground-access used by SmoothHeightMesh in place of CGround and readMap
+float GetGroundHeight(float x, float z)
+{
+	const int hx = std::min(std::max(int(x / SQUARE_SIZE), 0), MAP_SQUARES);
+	const int hz = std::min(std::max(int(z / SQUARE_SIZE), 0), MAP_SQUARES);
+
+	return std::max(0.0f, terrain[hx + hz * (MAP_SQUARES + 1)]);
+}
+
+float GetMaxGroundHeight() { return MAX_HEIGHT; }
+
+
+static void ChangeTerrain(int x1, int z1, int x2, int z2)
+{
+	const float h = RandFloat(-100.0f, MAX_HEIGHT);
+
+	for (int z = z1; z <= z2; z++) {
+		for (int x = x1; x <= x2; x++) {
+			terrain[x + z * (MAP_SQUARES + 1)] = h + RandFloat(-20.0f, 0.0f);
+		}
+	}
+}
+
+static bool MeshesEqual(const SmoothHeightMesh& a, const SmoothHeightMesh& b)
+{
+	const size_t size = sizeof(float) * (a.GetMaxX() + 1) * (a.GetMaxY() + 1);
+
+	if (std::memcmp(a.GetMeshData(), b.GetMeshData(), size) != 0)
+		return false;
+
+	return (std::memcmp(a.GetOriginalMeshData(), b.GetOriginalMeshData(), size) == 0);
+}
+
+
+TEST_CASE("SmoothHeightMeshIncremental")
+{
+	for (float& h: terrain) {
+		h = RandFloat(-50.0f, MAX_HEIGHT * 0.5f);
+	}
+
+	SmoothHeightMesh mesh;
+	mesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+	for (int n = 0; n < 50; n++) {
+		// craters of all sizes, including ones touching the map edges
+		const int size = RandInt(0, 24);
+		const int x1 = RandInt(-size, MAP_SQUARES);
+		const int z1 = RandInt(-size, MAP_SQUARES);
+		const int x2 = std::min(x1 + size, MAP_SQUARES);
+		const int z2 = std::min(z1 + size, MAP_SQUARES);
+
+		ChangeTerrain(std::max(x1, 0), std::max(z1, 0), x2, z2);
+		mesh.MapChanged(std::max(x1, 0), std::max(z1, 0), x2, z2);
+
+		SmoothHeightMesh fullMesh;
+		fullMesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+		CHECK(MeshesEqual(mesh, fullMesh));
+	}
+}
+
+TEST_CASE("SmoothHeightMeshBounds")
+{
+	for (float& h: terrain) {
+		h = RandFloat(-50.0f, MAX_HEIGHT);
+	}
+
+	SmoothHeightMesh mesh;
+	mesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+	const float res = mesh.GetResolution();
+	const float* heights = mesh.GetMeshData();
+
+	for (int y = 0; y <= mesh.GetMaxY(); y++) {
+		for (int x = 0; x <= mesh.GetMaxX(); x++) {
+			const float h = heights[x + y * mesh.GetLineSize()];
+
+			CHECK(h >= GetGroundHeight(x * res, y * res));
+			CHECK(h <= MAX_HEIGHT);
+
+			// vertices are sampled directly, except for the clamped last row and column
+			if (x < mesh.GetMaxX() && y < mesh.GetMaxY()) {
+				CHECK(mesh.GetHeight(x * res, y * res) == h);
+			}
+		}
+	}
+}
+
+TEST_CASE("SmoothHeightMeshLuaEdits")
+{
+	for (float& h: terrain) {
+		h = RandFloat(-50.0f, MAX_HEIGHT * 0.5f);
+	}
+
+	SmoothHeightMesh mesh;
+	mesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+	// vertex (10, 10) lies on map-square (20, 20)
+	const int index = 10 + 10 * mesh.GetLineSize();
+	const float origHeight = mesh.GetOriginalMeshData()[index];
+
+	mesh.SetHeight(index, -123.0f);
+
+	ChangeTerrain(16, 16, 24, 24);
+	mesh.MapChanged(16, 16, 24, 24);
+
+	SmoothHeightMesh fullMesh;
+	fullMesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+	// the edited vertex keeps its height, its original height follows the terrain
+	CHECK(mesh.GetMeshData()[index] == -123.0f);
+	CHECK(mesh.GetOriginalMeshData()[index] == fullMesh.GetOriginalMeshData()[index]);
+	CHECK(mesh.GetOriginalMeshData()[index] != origHeight);
+
+	// reverting the edit makes the vertex follow terrain changes again
+	mesh.RevertHeight(index);
+	CHECK(MeshesEqual(mesh, fullMesh));
+
+	ChangeTerrain(16, 16, 24, 24);
+	mesh.MapChanged(16, 16, 24, 24);
+
+	SmoothHeightMesh newMesh;
+	newMesh.Init(MAP_SIZE, MAP_SIZE, SQUARE_SIZE * 2, SQUARE_SIZE * 10);
+
+	CHECK(MeshesEqual(mesh, newMesh));
+}
@@ -0,0 +1,134 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "System/FileSystem/Archives/FileView.h"
+#include "System/FileSystem/Archives/ZipArchive.h"
+#include "System/GlobalConfig.h"
+#include "minizip/zip.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+static const std::string testArchive = "testFileView.sdz";
+
+static std::vector<std::uint8_t> MakeData(size_t size, unsigned int seed)
+{
+	std::vector<std::uint8_t> data(size);
+
+	for (size_t i = 0; i < size; i++) {
+		data[i] = (i * 31 + seed) ^ (i >> 8);
+	}
+
+	return data;
+}
+
+static bool AddZipEntry(zipFile zip, const char* name, const std::vector<std::uint8_t>& data, int method)
+{
+	zip_fileinfo zi = {};
+
+	bool ret = true;
+	ret = ret && (zipOpenNewFileInZip(zip, name, &zi, nullptr, 0, nullptr, 0, nullptr, method, Z_DEFAULT_COMPRESSION) == ZIP_OK);
+	ret = ret && (zipWriteInFileInZip(zip, data.data(), data.size()) == ZIP_OK);
+	ret = ret && (zipCloseFileInZip(zip) == ZIP_OK);
+	return ret;
+}
+
+namespace {
+	struct PrepareArchive {
+		PrepareArchive()
+			: stored(MakeData(CMappedFile::MIN_MAPPED_SIZE * 2, 1))
+			, deflated(MakeData(CMappedFile::MIN_MAPPED_SIZE * 2, 2))
+			, small(MakeData(128, 3))
+		{
+			zipFile zip = zipOpen(testArchive.c_str(), APPEND_STATUS_CREATE);
+
+			if (zip == nullptr)
+				return;
+
+			created = AddZipEntry(zip, "small.bin", small, 0);
+			created = created && AddZipEntry(zip, "maps/deflated.bin", deflated, Z_DEFLATED);
+			created = created && AddZipEntry(zip, "maps/stored.bin", stored, 0);
+			created = (zipClose(zip, nullptr) == ZIP_OK) && created;
+		}
+		~PrepareArchive() {
+			std::remove(testArchive.c_str());
+		}
+
+		std::vector<std::uint8_t> stored;
+		std::vector<std::uint8_t> deflated;
+		std::vector<std::uint8_t> small;
+
+		bool created = false;
+	};
+}
+
+static PrepareArchive pa;
+
+
+static bool ViewEquals(const CFileView& view, const std::vector<std::uint8_t>& data)
+{
+	return (view.IsValid() && std::vector<std::uint8_t>(view.begin(), view.end()) == data);
+}
+
+
+TEST_CASE("MappedFile")
+{
+	REQUIRE(pa.created);
+	CHECK(CMappedFile::Open("testFileView.missing") == nullptr);
+
+	std::shared_ptr<const CMappedFile> file = CMappedFile::Open(testArchive);
+
+	REQUIRE(file != nullptr);
+	CHECK(file->GetSize() > pa.stored.size());
+
+	CHECK_FALSE(CMappedFile::GetView(file, file->GetSize(), 1).IsValid());
+	CHECK_FALSE(CMappedFile::GetView(file, 0, 0).IsValid());
+
+	// views keep the mapping alive
+	const CFileView view = CMappedFile::GetView(file, 0, 4);
+	file.reset();
+
+	REQUIRE(view.IsValid());
+	CHECK(std::string(view.begin(), view.end()) == "PK\x03\x04");
+}
+
+TEST_CASE("ZipArchiveViews")
+{
+	REQUIRE(pa.created);
+	globalConfig.vfsCacheArchiveFiles = false;
+
+	// the by-name accessors are only visible through the base class
+	std::unique_ptr<IArchive> archive(new CZipArchive(testArchive));
+	REQUIRE(archive->IsOpen());
+
+	CFileView storedView;
+	CFileView otherView;
+
+	// stored entries are mapped even without caching, everything else needs the cache
+	CHECK(archive->GetFileView("maps/stored.bin", storedView));
+	CHECK_FALSE(archive->GetFileView("maps/deflated.bin", otherView));
+	CHECK_FALSE(archive->GetFileView("small.bin", otherView));
+	CHECK_FALSE(archive->GetFileView("missing.bin", otherView));
+	CHECK(ViewEquals(storedView, pa.stored));
+
+	globalConfig.vfsCacheArchiveFiles = true;
+
+	CHECK(archive->GetFileView("maps/deflated.bin", otherView));
+	CHECK(ViewEquals(otherView, pa.deflated));
+	CHECK(archive->GetFileView("small.bin", otherView));
+	CHECK(ViewEquals(otherView, pa.small));
+
+	std::vector<std::uint8_t> buffer;
+	CHECK(archive->GetFile("maps/stored.bin", buffer));
+	CHECK(buffer == pa.stored);
+
+	// views stay valid after the archive is gone
+	archive.reset();
+
+	CHECK(ViewEquals(storedView, pa.stored));
+	CHECK(ViewEquals(otherView, pa.small));
+}
@@ -0,0 +1,109 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <memory>
+#include <vector>
+
+#include "System/FileSystem/Archives/SolidBlockCache.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+// stand-ins for two archives, only their addresses are used as keys
+static const int archiveA = 0;
+static const int archiveB = 0;
+
+static CSolidBlockCache::BlockData MakeBlock(size_t size)
+{
+	return (std::make_shared< std::vector<std::uint8_t> >(size, std::uint8_t(size)));
+}
+
+
+TEST_CASE("SolidBlockCacheEviction")
+{
+	CSolidBlockCache cache;
+
+	// the budget is shared, blocks of either archive count against it
+	cache.Insert(&archiveA, 0, MakeBlock(100), 300);
+	cache.Insert(&archiveB, 0, MakeBlock(100), 300);
+	cache.Insert(&archiveA, 1, MakeBlock(100), 300);
+
+	CHECK(cache.GetSize() == 300);
+	CHECK(cache.GetNumBlocks() == 3);
+
+	// using A:0 makes B:0 the least recently used block
+	CHECK(cache.Find(&archiveA, 0) != nullptr);
+
+	cache.Insert(&archiveB, 1, MakeBlock(100), 300);
+
+	CHECK(cache.GetSize() == 300);
+	CHECK(cache.Contains(&archiveA, 0));
+	CHECK(cache.Contains(&archiveA, 1));
+	CHECK(cache.Contains(&archiveB, 1));
+	CHECK_FALSE(cache.Contains(&archiveB, 0));
+
+	// a large block evicts as many others as needed
+	cache.Insert(&archiveB, 2, MakeBlock(250), 300);
+
+	CHECK(cache.GetSize() == 250);
+	CHECK(cache.GetNumBlocks() == 1);
+	CHECK(cache.Contains(&archiveB, 2));
+}
+
+TEST_CASE("SolidBlockCacheOversizedBlock")
+{
+	CSolidBlockCache cache;
+
+	cache.Insert(&archiveA, 0, MakeBlock(100), 300);
+
+	// the new block is kept even if it alone exceeds the budget
+	const CSolidBlockCache::BlockData block = MakeBlock(500);
+
+	CHECK(cache.Insert(&archiveA, 1, block, 300) == block);
+	CHECK(cache.Find(&archiveA, 1) == block);
+	CHECK(cache.GetSize() == 500);
+	CHECK_FALSE(cache.Contains(&archiveA, 0));
+
+	// and is evicted by the next one
+	cache.Insert(&archiveA, 2, MakeBlock(100), 300);
+
+	CHECK(cache.GetSize() == 100);
+	CHECK_FALSE(cache.Contains(&archiveA, 1));
+
+	// evicted blocks stay valid for as long as they are referenced
+	CHECK(block->size() == 500);
+}
+
+TEST_CASE("SolidBlockCacheDuplicateInsert")
+{
+	CSolidBlockCache cache;
+
+	const CSolidBlockCache::BlockData first = MakeBlock(100);
+	const CSolidBlockCache::BlockData second = MakeBlock(100);
+
+	// a block decoded twice concurrently is only cached once
+	CHECK(cache.Insert(&archiveA, 0, first, 300) == first);
+	CHECK(cache.Insert(&archiveA, 0, second, 300) == first);
+	CHECK(cache.GetSize() == 100);
+	CHECK(cache.GetNumBlocks() == 1);
+}
+
+TEST_CASE("SolidBlockCacheClear")
+{
+	CSolidBlockCache cache;
+
+	cache.Insert(&archiveA, 0, MakeBlock(100), 1000);
+	cache.Insert(&archiveA, 7, MakeBlock(100), 1000);
+	cache.Insert(&archiveB, 0, MakeBlock(50), 1000);
+
+	cache.Clear(&archiveA);
+
+	CHECK(cache.GetSize() == 50);
+	CHECK(cache.GetNumBlocks() == 1);
+	CHECK(cache.Find(&archiveA, 0) == nullptr);
+	CHECK(cache.Find(&archiveB, 0) != nullptr);
+
+	cache.Clear();
+
+	CHECK(cache.GetSize() == 0);
+	CHECK(cache.GetNumBlocks() == 0);
+}
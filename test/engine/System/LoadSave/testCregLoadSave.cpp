@@ -2,6 +2,8 @@
 
 #include "System/creg/creg_cond.h"
 #include "System/creg/Serializer.h"
+#include "System/LoadSave/ChunkedStream.h"
+#include "System/Misc/SpringTime.h"
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -11,6 +13,7 @@
 #define CATCH_CONFIG_MAIN
 #include "lib/catch.hpp"
 
+InitSpringTime ist;
 
 
 struct EmbeddedObj {
@@ -173,3 +176,149 @@ TEST_CASE("CregLoadSave")
 
 	delete root;
 }
+
+
+
+// roughly the object graph of a large game: many objects with (mostly) small arrays
+static TestObj* CreateWorld(int numUnits)
+{
+	TestObj* root = new TestObj;
+	TestObj* prev = root;
+
+	for (int i = 0; i < numUnits; i++) {
+		TestObj* unit = new TestObj;
+
+		unit->intvar = i;
+		unit->str = "unit" + std::to_string(i);
+		unit->darray.resize(4096, i);
+		unit->children[1] = root;
+
+		prev->children[0] = unit;
+		prev = unit;
+	}
+
+	return root;
+}
+
+static bool CheckWorld(TestObj* root, int numUnits)
+{
+	const TestObj* unit = root->children[0];
+
+	for (int i = 0; i < numUnits; i++, unit = unit->children[0]) {
+		if (unit == nullptr || unit->intvar != i || unit->darray.size() != 4096 || unit->darray[4095] != i)
+			return false;
+		if (unit->children[1] != root)
+			return false;
+	}
+
+	return (unit == nullptr);
+}
+
+TEST_CASE("CregLoadSaveChunked")
+{
+	const int numUnits = 5000;
+	const std::string fileName = "testCregLoadSaveChunked.sgz";
+
+	TestObj* world = CreateWorld(numUnits);
+
+	size_t streamSize = 0;
+	size_t peakChunks = 0;
+
+	{
+		// baseline: stringstream and a single-threaded gzip stream
+		const spring_time t0 = spring_gettime();
+
+		std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, world, world->GetClass());
+
+		// the stream buffer plus the copy returned by str() are both alive here
+		const std::string data = ss.str();
+		const std::vector<char> chunk(data.begin(), data.end());
+
+		std::vector<char> member;
+
+		CHECK(CParallelGZWriter::DeflateChunk(chunk, member, 5));
+
+		printf("[%s] stringstream: %.1f MB serialized+deflated to %.1f MB in %ims (peak >= %.1f MB)\n", __func__,
+			data.size() / (1024.0f * 1024.0f), member.size() / (1024.0f * 1024.0f), int((spring_gettime() - t0).toMilliSecsi()), (data.size() * 2) / (1024.0f * 1024.0f));
+	}
+	{
+		const spring_time t0 = spring_gettime();
+
+		CParallelGZWriter writer(fileName, 5, 4, 8);
+		CChunkedStreamBuf osb([&](size_t chunkIndex, CChunkedStreamBuf::Chunk&& chunk) { writer.Push(chunkIndex, std::move(chunk)); });
+		std::ostream oss(&osb);
+
+		creg::COutputStreamSerializer os;
+
+		osb.Pin(oss.tellp(), creg::COutputStreamSerializer::GetPackageHeaderSize());
+		os.SavePackage(&oss, world, world->GetClass());
+		osb.Unpin();
+		osb.Flush();
+
+		streamSize = osb.GetSize();
+		peakChunks = osb.GetPeakChunks();
+
+		CHECK(writer.Finish());
+
+		printf("[%s] chunked: %.1f MB serialized+deflated to %.1f MB in %ims (peak %u chunks of %u KB held, up to 8 more queued)\n", __func__,
+			streamSize / (1024.0f * 1024.0f), writer.GetCompressedSize() / (1024.0f * 1024.0f), int((spring_gettime() - t0).toMilliSecsi()),
+			unsigned(peakChunks), unsigned(CChunkedStreamBuf::CHUNK_SIZE >> 10));
+	}
+
+	// more than one chunk, but never all of them at once
+	CHECK(streamSize > CChunkedStreamBuf::CHUNK_SIZE * 2);
+	CHECK(peakChunks < (streamSize / CChunkedStreamBuf::CHUNK_SIZE));
+
+	{
+		const spring_time t0 = spring_gettime();
+
+		std::ifstream ifs(fileName, std::ios::binary);
+		std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		std::vector<CChunkedStreamBuf::Chunk> chunks;
+
+		REQUIRE(CParallelGZWriter::InflateChunks(data, chunks));
+
+		CChunkedStreamBuf isb;
+		isb.SetChunks(std::move(chunks));
+		CHECK(isb.GetSize() == streamSize);
+
+		std::istream iss(&isb);
+		TestObj* root = (TestObj*)loadtest(&iss);
+
+		printf("[%s] chunked: loaded in %ims\n", __func__, int((spring_gettime() - t0).toMilliSecsi()));
+
+		CHECK(CheckWorld(root, numUnits));
+
+		delete root;
+	}
+	{
+		const spring_time t0 = spring_gettime();
+
+		std::ifstream ifs(fileName, std::ios::binary);
+		std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+		CGZChunkStreamBuf isb;
+		REQUIRE(isb.Open(std::move(data)));
+		CHECK(isb.GetSize() == streamSize);
+
+		std::istream iss(&isb);
+		TestObj* root = (TestObj*)loadtest(&iss);
+
+		printf("[%s] streamed: loaded in %ims (peak %u chunks of %u KB inflated)\n", __func__,
+			int((spring_gettime() - t0).toMilliSecsi()), unsigned(isb.GetPeakChunks()), unsigned(CChunkedStreamBuf::CHUNK_SIZE >> 10));
+
+		CHECK(!isb.HasFailed());
+		CHECK(CheckWorld(root, numUnits));
+		// the whole stream is never inflated at once
+		CHECK(isb.GetPeakChunks() <= CGZChunkStreamBuf::MAX_CACHED_CHUNKS);
+		CHECK(isb.GetPeakChunks() < (streamSize / CChunkedStreamBuf::CHUNK_SIZE));
+
+		delete root;
+	}
+
+	delete world;
+
+	remove(fileName.c_str());
+}
@@ -0,0 +1,144 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/GlobalConfig.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/UDPConnection.h"
+#include "System/Net/UDPListener.h"
+#include "System/Log/ILog.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+
+// simulates N clients connecting to a listener over loopback, then has the
+// server broadcast a stream of packets to all of them (like a dedicated host
+// with many spectators) and measures the time spent in UDPListener::Update
+// packets are tiny sync-responses if payloadSize is 0, Lua messages otherwise
+static void RunLoadTest(int port, unsigned int numClients, unsigned int numIOThreads, unsigned int payloadSize = 0)
+{
+	const unsigned int NUM_ROUNDS = 20;
+	const unsigned int NUM_PACKETS = (payloadSize == 0)? 100: 10;
+
+	netcode::UDPListener listener(port, "127.0.0.1", numIOThreads);
+
+	std::vector< std::shared_ptr<netcode::UDPConnection> > clients;
+	std::vector< std::shared_ptr<netcode::UDPConnection> > servers;
+	std::vector<unsigned int> numReceived(numClients, 0);
+
+	const spring_time maxTime = spring_gettime() + spring_secs(20);
+
+	for (unsigned int i = 0; i < numClients; i++) {
+		clients.emplace_back(new netcode::UDPConnection(0, "127.0.0.1", port));
+		clients.back()->Unmute();
+		clients.back()->SendData(CBaseNetProtocol::Get().SendSyncResponse(0, -1, 0));
+		clients.back()->Flush(true);
+	}
+
+	while (servers.size() < numClients && spring_gettime() < maxTime) {
+		listener.Update();
+
+		while (listener.HasIncomingConnections()) {
+			servers.push_back(listener.AcceptConnection());
+			servers.back()->Unmute();
+		}
+	}
+
+	REQUIRE(servers.size() == numClients);
+
+	const std::vector<uint8_t> payload(payloadSize, 0xAB);
+
+	spring_time updateTime;
+	size_t numBytes = 0;
+	unsigned int numDone = 0;
+
+	for (unsigned int r = 0; r < NUM_ROUNDS; r++) {
+		for (unsigned int n = 0; n < NUM_PACKETS; n++) {
+			// same packet for every link, as in CGameServer::Broadcast
+			std::shared_ptr<const netcode::RawPacket> packet;
+
+			if (payloadSize == 0) {
+				packet = CBaseNetProtocol::Get().SendSyncResponse(0, r * NUM_PACKETS + n, 0);
+			} else {
+				packet = CBaseNetProtocol::Get().SendLuaMsg(0, 0, 0, payload);
+			}
+
+			numBytes += (packet->length * numClients);
+
+			for (const auto& conn: servers) {
+				conn->SendData(packet);
+			}
+		}
+
+		const spring_time t0 = spring_gettime();
+		listener.Update();
+		updateTime += (spring_gettime() - t0);
+
+		spring_msecs(5).sleep(true);
+	}
+
+	while (numDone < numClients && spring_gettime() < maxTime) {
+		numDone = 0;
+
+		for (unsigned int i = 0; i < numClients; i++) {
+			clients[i]->Update();
+
+			while (clients[i]->GetData() != nullptr) {
+				numReceived[i] += 1;
+			}
+
+			numDone += (numReceived[i] >= NUM_ROUNDS * NUM_PACKETS);
+		}
+
+		const spring_time t0 = spring_gettime();
+		listener.Update();
+		updateTime += (spring_gettime() - t0);
+
+		if (!listener.WaitForData(1))
+			spring_msecs(1).sleep(true);
+	}
+
+	LOG(
+		"[%s] clients=%u ioThreads=%u payload=%uB listenerUpdateTime=%ldus (%.2f MB/s)",
+		__func__, numClients, numIOThreads, payloadSize, long(updateTime.toMicroSecsi()),
+		numBytes / std::max(1.0f, updateTime.toMicroSecsf())
+	);
+
+	CHECK(numDone == numClients);
+}
+
+
+TEST_CASE("UDPListenerLoad")
+{
+	// unlimited, otherwise throughput is bounded by rate-limiting
+	globalConfig.linkOutgoingBandwidth = 0;
+
+	int port = 18452;
+
+	for (unsigned int numIOThreads: {0u, 4u}) {
+		for (unsigned int numClients: {8u, 32u}) {
+			RunLoadTest(port++, numClients, numIOThreads);
+		}
+	}
+}
+
+TEST_CASE("UDPBroadcastThroughput")
+{
+	globalConfig.linkOutgoingBandwidth = 0;
+	globalConfig.linkIncomingSustainedBandwidth = 0;
+	globalConfig.linkIncomingPeakBandwidth = 0;
+	globalConfig.linkIncomingMaxPacketRate = 0;
+
+	int port = 18552;
+
+	// large packets are split into full chunks that share the packet's buffer
+	for (unsigned int numClients: {8u, 32u, 128u}) {
+		RunLoadTest(port++, numClients, 0, 4096);
+	}
+}
@@ -0,0 +1,143 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Threading/TaskGraph.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// Catch is not threadsafe
+#define SAFE_CHECK( P )                \
+	do {                                     \
+		std::lock_guard<spring::mutex> _(m); \
+		CHECK( (P) );                  \
+	} while (0);
+
+struct do_once {
+	do_once() {
+		Threading::DetectCores();
+		ThreadPool::SetThreadCount(std::max(4, ThreadPool::GetMaxThreads()));
+	}
+};
+
+InitSpringTime ist;
+do_once doonce;
+
+static spring::mutex m;
+
+
+TEST_CASE("TaskGraphOrder")
+{
+	CTaskGraph graph;
+
+	std::atomic<int> counter = {0};
+	std::vector<int> order(8, -1);
+
+	const auto Step = [&](unsigned int i) { return [&, i]() { order[i] = counter++; }; };
+
+	// worker tasks may run in any order relative to each other, but never before their deps
+	const unsigned int a = graph.AddTask("a", {}, Step(0));
+	const unsigned int b = graph.AddTask("b", {a}, Step(1), true);
+	const unsigned int c = graph.AddTask("c", {a}, Step(2), true);
+	const unsigned int d = graph.AddTask("d", {}, Step(3));
+	const unsigned int e = graph.AddTask("e", {b, c}, Step(4), true);
+	const unsigned int f = graph.AddTask("f", {e, d}, Step(5));
+	const unsigned int g = graph.AddTask("g", {}, Step(6));
+	graph.AddTask("h", {f, g}, Step(7), true);
+
+	graph.Run();
+
+	for (int i: order) {
+		CHECK(i >= 0);
+	}
+
+	CHECK(order[a] < order[b]);
+	CHECK(order[a] < order[c]);
+	CHECK(order[b] < order[e]);
+	CHECK(order[c] < order[e]);
+	CHECK(order[e] < order[f]);
+	CHECK(order[d] < order[f]);
+	// caller-thread tasks keep their insertion order
+	CHECK(order[a] < order[d]);
+	CHECK(order[f] < order[g]);
+	CHECK(order[7] == 7);
+}
+
+TEST_CASE("TaskGraphThreads")
+{
+	CTaskGraph graph;
+
+	std::atomic<int> numWorkerTasks = {0};
+	const int callerThread = ThreadPool::GetThreadNum();
+
+	// caller tasks never leave the calling thread
+	for (int i = 0; i < 16; i++) {
+		graph.AddTask("caller", {}, [&]() { SAFE_CHECK(ThreadPool::GetThreadNum() == callerThread); });
+		graph.AddTask("worker", {}, [&]() { spring_sleep(spring_msecs(1)); numWorkerTasks++; }, true);
+	}
+
+	graph.Run();
+
+	CHECK(numWorkerTasks == 16);
+	CHECK(graph.GetDuration() >= spring_msecs(1));
+	CHECK(graph.GetTaskDuration() >= spring_msecs(16));
+}
+
+TEST_CASE("TaskGraphException")
+{
+	CTaskGraph graph;
+
+	std::atomic<int> numRuns = {0};
+
+	const unsigned int a = graph.AddTask("a", {}, [&]() { numRuns++; }, true);
+	const unsigned int b = graph.AddTask("b", {a}, [&]() { numRuns++; throw std::runtime_error("b"); }, true);
+	graph.AddTask("c", {b}, [&]() { numRuns++; });
+	graph.AddTask("d", {b}, [&]() { numRuns++; }, true);
+
+	CHECK_THROWS_AS(graph.Run(), std::runtime_error);
+	CHECK(numRuns == 2);
+
+	// exceptions thrown by caller-thread tasks stop the graph as well
+	CTaskGraph callerGraph;
+	callerGraph.AddTask("a", {}, [&]() { throw std::runtime_error("a"); });
+	callerGraph.AddTask("b", {}, [&]() { numRuns++; });
+
+	CHECK_THROWS_AS(callerGraph.Run(), std::runtime_error);
+	CHECK(numRuns == 2);
+}
+
+TEST_CASE("TaskGraphTrace")
+{
+	CTaskGraph graph;
+
+	const unsigned int a = graph.AddTask("load \"map\"", {}, []() {});
+	graph.AddTask("mesh", {a}, []() { spring_sleep(spring_msecs(1)); }, true);
+	graph.Run();
+
+	const std::string fileName = "testTaskGraph.json";
+
+	REQUIRE(graph.WriteTrace(fileName));
+
+	std::ifstream in(fileName);
+	std::stringstream trace;
+	trace << in.rdbuf();
+	in.close();
+
+	std::remove(fileName.c_str());
+
+	CHECK(trace.str().find("\"traceEvents\"") != std::string::npos);
+	CHECK(trace.str().find("\"load \\\"map\\\"\"") != std::string::npos);
+	CHECK(trace.str().find("\"mesh\"") != std::string::npos);
+	CHECK(trace.str().find(",\n]") == std::string::npos);
+}
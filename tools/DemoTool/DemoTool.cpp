@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <string>
 #include <map>
 #include <iostream>
@@ -31,10 +32,11 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (playerstats,  false, "Print playerstats");
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
+	DEFINE_int32 (frame,        -1,    "Start the traffic dump at this frame (requires a demo with frame index)");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
 
 
-void TrafficDump(CDemoReader& reader, bool trafficStats);
+void TrafficDump(CDemoReader& reader, bool trafficStats, int startFrame = -1);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
 
 int main (int argc, char* argv[])
@@ -56,7 +58,14 @@ int main (int argc, char* argv[])
 	reader.LoadStats();
 	if (FLAGS_dump)
 	{
-		TrafficDump(reader, true);
+		int startFrame = -1;
+		if (FLAGS_frame >= 0)
+		{
+			reader.LoadFrameIndex();
+			if ((startFrame = reader.SeekToFrame(FLAGS_frame)) < 0)
+				std::cout << "no frame index entry for frame " << FLAGS_frame << ", dumping from the start" << std::endl;
+		}
+		TrafficDump(reader, true, startFrame);
 		return 0;
 	}
 	if (!FLAGS_teamsstatcsv.empty())
@@ -191,11 +200,12 @@ void PrintBinary(const unsigned char* const buf, int len)
 	std::cout << std::dec; //reset to decimal
 }
 
-void TrafficDump(CDemoReader& reader, bool trafficStats)
+void TrafficDump(CDemoReader& reader, bool trafficStats, int startFrame)
 {
 	InitCommandNames();
 	std::vector<unsigned> trafficCounter(NETMSG_LAST, 0);
-	int frame = -1;
+	// the first packet read after a seek is the {NEW,KEY}FRAME starting startFrame
+	int frame = std::max(startFrame, 0) - 1;
 	int cmdId = 0;
 	while (!reader.ReachedEnd())
 	{
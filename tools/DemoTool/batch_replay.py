@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# replays many demos with the headless engine, several at a time, and collects
+# the per-demo reports written by --replay-report into one JSON-lines file
+#
+# usage: ./batch_replay.py -e /path/to/spring-headless -j 4 -o results.jsonl demolist.txt [-- engine args]
+#        (demolist.txt holds one demo path per line, demos may also be passed directly)
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+
+
+def read_demo_list(args):
+	demos = []
+	for arg in args:
+		if arg.endswith(".sdfz") or arg.endswith(".sdf"):
+			demos.append(arg)
+			continue
+		with open(arg) as f:
+			demos.extend(line.strip() for line in f if line.strip() and not line.startswith("#"))
+	return demos
+
+
+def tail(path, numLines):
+	try:
+		with open(path, errors="replace") as f:
+			return f.readlines()[-numLines:]
+	except OSError:
+		return []
+
+
+def replay(demo, workDir, opts):
+	# every process gets its own write-dir so infologs, caches and
+	# demo copies do not collide; content is found via SPRING_DATADIR
+	os.makedirs(workDir, exist_ok=True)
+	reportFile = os.path.join(workDir, "report.json")
+	if os.path.exists(reportFile):
+		os.remove(reportFile)
+
+	env = dict(os.environ)
+	if opts.datadir:
+		env["SPRING_DATADIR"] = os.pathsep.join(opts.datadir + [env.get("SPRING_DATADIR", "")]).strip(os.pathsep)
+
+	cmd = [opts.engine, "--write-dir", workDir, "--replay-report", reportFile] + opts.extra + [os.path.abspath(demo)]
+	result = {"demo": demo}
+	startTime = time.time()
+
+	try:
+		proc = subprocess.run(cmd, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, timeout=opts.timeout)
+		result["exitCode"] = proc.returncode
+	except subprocess.TimeoutExpired:
+		result["exitCode"] = None
+		result["status"] = "timeout"
+
+	result["wallTime"] = round(time.time() - startTime, 3)
+
+	try:
+		with open(reportFile) as f:
+			report = json.load(f)
+		report.update(result)
+		result = report
+		result.setdefault("status", "desync" if result["numDesyncs"] > 0 else "ok")
+	except (OSError, ValueError):
+		result.setdefault("status", "crash")
+		result["infolog"] = tail(os.path.join(workDir, "infolog.txt"), 40)
+
+	return result
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Replay demos in parallel with the headless engine", epilog="arguments after -- are passed on to the engine")
+	parser.add_argument("demos", nargs="+", help="demo files, or text files listing one demo per line")
+	parser.add_argument("-e", "--engine", required=True, help="path to spring-headless")
+	parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="number of concurrent engine processes")
+	parser.add_argument("-o", "--output", default="replays.jsonl", help="JSON-lines output file, one object per demo")
+	parser.add_argument("-d", "--datadir", action="append", default=[], help="additional data-dir holding games and maps")
+	parser.add_argument("-t", "--timeout", type=float, default=3600, help="per-demo timeout in seconds")
+	parser.add_argument("-w", "--workdir", default=None, help="directory for per-worker write-dirs (default: temporary)")
+	parser.add_argument("-k", "--keep", action="store_true", help="keep the per-worker write-dirs")
+	# split off the engine arguments ourselves, argparse would hand
+	# them to the greedy positional demos argument instead
+	argv = sys.argv[1:]
+	extra = []
+	if "--" in argv:
+		extra = argv[argv.index("--") + 1:]
+		argv = argv[:argv.index("--")]
+
+	opts = parser.parse_args(argv)
+	opts.extra = extra
+
+	demos = read_demo_list(opts.demos)
+	baseDir = opts.workdir or tempfile.mkdtemp(prefix="batch_replay_")
+	numDone = 0
+	statusCounts = {}
+
+	with open(opts.output, "w") as out, ThreadPoolExecutor(max_workers=max(1, opts.jobs)) as pool:
+		futures = {pool.submit(replay, demo, os.path.join(baseDir, "demo-%d" % i), opts): demo for i, demo in enumerate(demos)}
+
+		for future in as_completed(futures):
+			result = future.result()
+			numDone += 1
+			statusCounts[result["status"]] = statusCounts.get(result["status"], 0) + 1
+
+			out.write(json.dumps(result) + "\n")
+			out.flush()
+
+			print("[%d/%d] %s: %s (%.1fs)" % (numDone, len(demos), result["status"], result["demo"], result["wallTime"]))
+
+	if not opts.keep and opts.workdir is None:
+		shutil.rmtree(baseDir, ignore_errors=True)
+
+	print("done: " + ", ".join("%s=%d" % kv for kv in sorted(statusCounts.items())))
+	return 0 if statusCounts.get("ok", 0) == len(demos) else 1
+
+
+if __name__ == "__main__":
+	sys.exit(main())